@@ -47,6 +47,7 @@
 #include "m_bbox.h"
 #include "m_misc.h"
 #include "p_local.h"
+#include "p_setup.h"
 #include "st_stuff.h"
 #include "v_video.h"
 #include "z_zone.h"
@@ -139,12 +140,19 @@ byte    *crosshaircolor;
 
 #define PLAYERRADIUS            (16 * (1 << MAPBITS))
 
+// translates from map coordinates to mapblocks
+#define MAPTOBLOCKSHIFT         (MAPBLOCKSHIFT - FRACTOMAPBITS)
+
+// the furthest a thing's triangle can reach from its position
+#define THINGMARGIN             (48 << MAPBITS)
+
 // translates between frame-buffer and map distances
 #define FTOM(x)                 (fixed_t)(((uint64_t)((x) << FRACBITS) * scale_ftom) >> FRACBITS)
 #define MTOF(x)                 (fixed_t)((((uint64_t)(x) * scale_mtof) >> FRACBITS) >> FRACBITS)
-// translates between frame-buffer and map coordinates
-#define CXMTOF(x)               MTOF(x - m_x)
-#define CYMTOF(y)               (mapheight - MTOF(y - m_y))
+// translates between frame-buffer and map coordinates, in the snapshot being drawn
+#define SMTOF(x)                (fixed_t)((((uint64_t)(x) * amsnapshot.scale_mtof) >> FRACBITS) >> FRACBITS)
+#define CXMTOF(x)               SMTOF(x - amsnapshot.m_x)
+#define CYMTOF(y)               (mapheight - SMTOF(y - amsnapshot.m_y))
 
 typedef struct
 {
@@ -269,14 +277,87 @@ int                     gridheight;
 static dboolean         stopped = true;
 
 dboolean                bigstate = false;
-byte                    *area;
 static dboolean         movement;
 int                     keydown;
 int                     direction;
 
-static am_frame_t       am_frame;
+typedef struct
+{
+    fixed_t             floorheight;
+    fixed_t             ceilingheight;
+    short               floorpic;
+} am_sector_t;
+
+typedef struct
+{
+    mpoint_t            point;
+    angle_t             angle;
+    int                 w;
+} am_thing_t;
+
+//
+// Everything the automap draws that can change during a tic is copied into a
+//  snapshot first, so that the external automap can be drawn on its own thread.
+//
+typedef struct
+{
+    fixed_t             m_x, m_y;
+    fixed_t             m_w, m_h;
+    fixed_t             scale_mtof;
+    dboolean            rotatemode;
+    dboolean            followmode;
+    dboolean            grid;
+    dboolean            path;
+    am_frame_t          frame;
+
+    mpoint_t            player;
+    angle_t             playerangle;
+    int                 cheats;
+    int                 allmap;
+    int                 invisibility;
+
+    int                 numlines;
+    short               *lineflags;
+    short               *linespecials;
+
+    int                 numsectors;
+    am_sector_t         *sectors;
+
+    am_thing_t          *things;
+    int                 numthings;
+    int                 numthings_max;
+
+    mpoint_t            *pathpoints;
+    int                 pathpointnum;
+    int                 pathpointnum_max;
+
+    mpoint_t            *markpoints;
+    int                 markpointnum;
+    int                 markpointnum_max;
+} am_snapshot_t;
+
+static am_snapshot_t    amsnapshot;
+
+static byte             *fb;                    // the buffer being drawn into
+
+// used to only draw lines that are in more than one mapblock once
+static int              *linecount;
+static int              linevalidcount;
+
+// the thread that draws the external automap
+static SDL_Thread       *amthread;
+static SDL_sem          *amstart;
+static SDL_sem          *amdone;
+static dboolean         amdrawing;
+static byte             *ambuffers[2];
+static int              amfront;
+
+// the tic the level was last copied into the snapshot
+static int              snapshottic = -1;
 
 static void AM_rotate(fixed_t *x, fixed_t *y, angle_t angle);
+static void AM_initExternalAutomapThread(void);
+static void AM_updateExternalAutomap(void);
 
 static void AM_activateNewScale(void)
 {
@@ -386,6 +467,8 @@ void AM_setColors(void)
     byte        *priority = Z_Calloc(1, 256, PU_STATIC, NULL);
     int         x, y;
 
+    AM_WaitForExternalAutomap();
+
     *(priority + nearestcolors[am_wallcolor]) = WALLPRIORITY;
     *(priority + nearestcolors[am_allmapwallcolor]) = ALLMAPWALLPRIORITY;
     *(priority + nearestcolors[am_cdwallcolor]) = CDWALLPRIORITY;
@@ -469,8 +552,6 @@ static void AM_initVariables(dboolean mainwindow)
 {
     automapactive = mainwindow;
 
-    area = mapscreen + maparea;
-
     m_paninc.x = m_paninc.y = 0;
     ftom_zoommul = FRACUNIT;
     mtof_zoommul = FRACUNIT;
@@ -527,6 +608,8 @@ int     lastepisode = -1;
 
 void AM_Start(dboolean mainwindow)
 {
+    AM_WaitForExternalAutomap();
+
     if (!stopped)
         AM_Stop();
     stopped = false;
@@ -543,6 +626,15 @@ void AM_Start(dboolean mainwindow)
         lastepisode = gameepisode;
     }
     AM_initVariables(mainwindow);
+
+    // the thread that draws the external automap isn't needed until there is one
+    if (mapwindow)
+        AM_initExternalAutomapThread();
+
+    if (amthread)
+        memset(ambuffers[amfront], backcolor, maparea);
+
+    snapshottic = -1;
 }
 
 //
@@ -633,8 +725,8 @@ static void AM_toggleGrid(void)
 static void AM_addMark(void)
 {
     int         i;
-    int         x = am_frame.centerx;
-    int         y = am_frame.centery;
+    int         x = m_x + m_w / 2;
+    int         y = m_y + m_h / 2;
     static char message[32];
 
     for (i = 0; i < markpointnum; i++)
@@ -1149,14 +1241,14 @@ static void AM_rotate(fixed_t *x, fixed_t *y, angle_t angle)
 
 static void AM_rotatePoint(mpoint_t *point)
 {
+    am_frame_t  *frame = &amsnapshot.frame;
     fixed_t     temp;
 
-    point->x -= am_frame.centerx;
-    point->y -= am_frame.centery;
+    point->x -= frame->centerx;
+    point->y -= frame->centery;
 
-    temp = FixedMul(point->x, am_frame.cos) - FixedMul(point->y, am_frame.sin) + am_frame.centerx;
-    point->y = FixedMul(point->x, am_frame.sin) + FixedMul(point->y, am_frame.cos)
-        + am_frame.centery;
+    temp = FixedMul(point->x, frame->cos) - FixedMul(point->y, frame->sin) + frame->centerx;
+    point->y = FixedMul(point->x, frame->sin) + FixedMul(point->y, frame->cos) + frame->centery;
     point->x = temp;
 }
 
@@ -1193,6 +1285,10 @@ void AM_Ticker(void)
     if (mapwindow)
     {
         AM_doFollowPlayer();
+
+        if (amthread)
+            AM_updateExternalAutomap();
+
         return;
     }
 
@@ -1280,20 +1376,20 @@ static __inline void _PUTDOT(byte *dot, byte *color)
 static __inline void PUTDOT(unsigned int x, unsigned int y, byte *color)
 {
     if (x < mapwidth && y < maparea)
-        _PUTDOT(mapscreen + y + x, color);
+        _PUTDOT(fb + y + x, color);
 }
 
 static __inline void PUTDOT2(unsigned int x, unsigned int y, byte color)
 {
     if (x < mapwidth && y < maparea)
-        *(mapscreen + y + x) = color;
+        *(fb + y + x) = color;
 }
 
 static __inline void PUTBIGDOT(unsigned int x, unsigned int y, byte *color)
 {
     if (x < mapwidth)
     {
-        byte            *dot = mapscreen + y + x;
+        byte            *dot = fb + y + x;
         dboolean        attop = (y < maparea);
         dboolean        atbottom = (y < mapbottom);
 
@@ -1311,7 +1407,7 @@ static __inline void PUTBIGDOT(unsigned int x, unsigned int y, byte *color)
     }
     else if (++x < mapwidth)
     {
-        byte    *dot = mapscreen + y + x;
+        byte    *dot = fb + y + x;
 
         if (y < maparea)
             _PUTDOT(dot, color);
@@ -1324,7 +1420,7 @@ static __inline void PUTTRANSDOT(unsigned int x, unsigned int y, byte *color)
 {
     if (x < mapwidth && y < maparea)
     {
-        byte    *dot = mapscreen + y + x;
+        byte    *dot = fb + y + x;
 
         if (*dot != *(tinttab60 + playercolor))
             *dot = *(tinttab60 + (*dot << 8) + playercolor);
@@ -1539,24 +1635,25 @@ static void AM_drawGrid(void)
     fixed_t     start, end;
     mline_t     ml;
 
-    fixed_t     minlen = (fixed_t)(sqrt((double)m_w * (double)m_w + (double)m_h * (double)m_h));
-    fixed_t     extx = (minlen - m_w) / 2;
-    fixed_t     exty = (minlen - m_h) / 2;
+    fixed_t     minlen = (fixed_t)(sqrt((double)amsnapshot.m_w * (double)amsnapshot.m_w
+                    + (double)amsnapshot.m_h * (double)amsnapshot.m_h));
+    fixed_t     extx = (minlen - amsnapshot.m_w) / 2;
+    fixed_t     exty = (minlen - amsnapshot.m_h) / 2;
 
     // Figure out start of vertical gridlines
-    start = m_x - extx;
+    start = amsnapshot.m_x - extx;
     if ((start - (bmaporgx >> FRACTOMAPBITS)) % gridwidth)
         start += gridwidth - ((start - (bmaporgx >> FRACTOMAPBITS)) % gridwidth);
-    end = m_x + minlen - extx;
+    end = amsnapshot.m_x + minlen - extx;
 
     // draw vertical gridlines
     for (x = start; x < end; x += gridwidth)
     {
         ml.a.x = x;
         ml.b.x = x;
-        ml.a.y = m_y - exty;
+        ml.a.y = amsnapshot.m_y - exty;
         ml.b.y = ml.a.y + minlen;
-        if (am_rotatemode)
+        if (amsnapshot.rotatemode)
         {
             AM_rotatePoint(&ml.a);
             AM_rotatePoint(&ml.b);
@@ -1565,19 +1662,19 @@ static void AM_drawGrid(void)
     }
 
     // Figure out start of horizontal gridlines
-    start = m_y - exty;
+    start = amsnapshot.m_y - exty;
     if ((start - (bmaporgy >> FRACTOMAPBITS)) % gridheight)
         start += gridheight - ((start - (bmaporgy >> FRACTOMAPBITS)) % gridheight);
-    end = m_y + minlen - exty;
+    end = amsnapshot.m_y + minlen - exty;
 
     // draw horizontal gridlines
     for (y = start; y < end; y += gridheight)
     {
-        ml.a.x = m_x - extx;
+        ml.a.x = amsnapshot.m_x - extx;
         ml.b.x = ml.a.x + minlen;
         ml.a.y = y;
         ml.b.y = y;
-        if (am_rotatemode)
+        if (amsnapshot.rotatemode)
         {
             AM_rotatePoint(&ml.a);
             AM_rotatePoint(&ml.b);
@@ -1586,100 +1683,144 @@ static void AM_drawGrid(void)
     }
 }
 
-//
-// Determines visible lines, draws them.
-// This is LineDef based, not LineSeg based.
-//
-static void AM_drawWalls(void)
+static void AM_drawWall(int i, dboolean allmap, dboolean cheating)
 {
-    dboolean    allmap = plr->powers[pw_allmap];
-    dboolean    cheating = plr->cheats & (CF_ALLMAP | CF_ALLMAP_THINGS);
-    int         i = 0;
+    line_t      *line = lines + i;
 
-    while (i < numlines)
+    if ((line->bbox[BOXLEFT] >> FRACTOMAPBITS) > amsnapshot.frame.bbox[BOXRIGHT]
+        || (line->bbox[BOXRIGHT] >> FRACTOMAPBITS) < amsnapshot.frame.bbox[BOXLEFT]
+        || (line->bbox[BOXBOTTOM] >> FRACTOMAPBITS) > amsnapshot.frame.bbox[BOXTOP]
+        || (line->bbox[BOXTOP] >> FRACTOMAPBITS) < amsnapshot.frame.bbox[BOXBOTTOM])
+        return;
+    else
     {
-        line_t  line = lines[i++];
+        short   flags = amsnapshot.lineflags[i];
 
-        if ((line.bbox[BOXLEFT] >> FRACTOMAPBITS) > am_frame.bbox[BOXRIGHT]
-            || (line.bbox[BOXRIGHT] >> FRACTOMAPBITS) < am_frame.bbox[BOXLEFT]
-            || (line.bbox[BOXBOTTOM] >> FRACTOMAPBITS) > am_frame.bbox[BOXTOP]
-            || (line.bbox[BOXTOP] >> FRACTOMAPBITS) < am_frame.bbox[BOXBOTTOM])
-            continue;
+        if ((flags & ML_DONTDRAW) && !cheating)
+            return;
         else
         {
-            short       flags = line.flags;
-
-            if ((flags & ML_DONTDRAW) && !cheating)
-                continue;
-            else
+            am_sector_t         *backsector = (line->backsector ?
+                                    amsnapshot.sectors + (line->backsector - sectors) : NULL);
+            am_sector_t         *frontsector = amsnapshot.sectors + (line->frontsector - sectors);
+            short               mapped = (flags & ML_MAPPED);
+            short               secret = (flags & ML_SECRET);
+            short               special = amsnapshot.linespecials[i];
+            static mline_t      l;
+
+            l.a.x = line->v1->x >> FRACTOMAPBITS;
+            l.a.y = line->v1->y >> FRACTOMAPBITS;
+            l.b.x = line->v2->x >> FRACTOMAPBITS;
+            l.b.y = line->v2->y >> FRACTOMAPBITS;
+
+            if (amsnapshot.rotatemode)
             {
-                sector_t            *backsector = line.backsector;
-                sector_t            *frontsector = line.frontsector;
-                short               mapped = (flags & ML_MAPPED);
-                short               secret = (flags & ML_SECRET);
-                short               special = line.special;
-                static mline_t      l;
-
-                l.a.x = line.v1->x >> FRACTOMAPBITS;
-                l.a.y = line.v1->y >> FRACTOMAPBITS;
-                l.b.x = line.v2->x >> FRACTOMAPBITS;
-                l.b.y = line.v2->y >> FRACTOMAPBITS;
-
-                if (am_rotatemode)
-                {
-                    AM_rotatePoint(&l.a);
-                    AM_rotatePoint(&l.b);
-                }
+                AM_rotatePoint(&l.a);
+                AM_rotatePoint(&l.b);
+            }
 
-                if ((special && (special == W1_Teleport || special == W1_ExitLevel
-                    || special == WR_Teleport || special == W1_ExitLevel_GoesToSecretLevel
-                    || special == W1_Teleport_AlsoMonsters_Silent_SameAngle
-                    || special == WR_Teleport_AlsoMonsters_Silent_SameAngle
-                    || special == W1_TeleportToLineWithSameTag_Silent_SameAngle
-                    || special == WR_TeleportToLineWithSameTag_Silent_SameAngle
-                    || special == W1_TeleportToLineWithSameTag_Silent_ReversedAngle
-                    || special == WR_TeleportToLineWithSameTag_Silent_ReversedAngle))
-                    && ((flags & ML_TELEPORTTRIGGERED) || cheating
-                    || (backsector && isteleport[backsector->floorpic])))
+            if ((special && (special == W1_Teleport || special == W1_ExitLevel
+                || special == WR_Teleport || special == W1_ExitLevel_GoesToSecretLevel
+                || special == W1_Teleport_AlsoMonsters_Silent_SameAngle
+                || special == WR_Teleport_AlsoMonsters_Silent_SameAngle
+                || special == W1_TeleportToLineWithSameTag_Silent_SameAngle
+                || special == WR_TeleportToLineWithSameTag_Silent_SameAngle
+                || special == W1_TeleportToLineWithSameTag_Silent_ReversedAngle
+                || special == WR_TeleportToLineWithSameTag_Silent_ReversedAngle))
+                && ((flags & ML_TELEPORTTRIGGERED) || cheating
+                || (backsector && isteleport[backsector->floorpic])))
+            {
+                if (cheating || (mapped && !secret && backsector
+                    && backsector->ceilingheight != backsector->floorheight))
                 {
-                    if (cheating || (mapped && !secret && backsector
-                        && backsector->ceilingheight != backsector->floorheight))
-                    {
-                        AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, teleportercolor);
-                        continue;
-                    }
-                    else if (allmap)
-                    {
-                        AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, allmapfdwallcolor);
-                        continue;
-                    }
+                    AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, teleportercolor);
+                    return;
                 }
-                if (!backsector || (secret && !cheating))
-                    AM_drawBigMline(l.a.x, l.a.y, l.b.x, l.b.y,
-                        (mapped || cheating ? wallcolor : (allmap ? allmapwallcolor : maskcolor)));
-                else if (backsector->floorheight != frontsector->floorheight)
+                else if (allmap)
                 {
-                    if (mapped || cheating)
-                        AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, fdwallcolor);
-                    else if (allmap)
-                        AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, allmapfdwallcolor);
+                    AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, allmapfdwallcolor);
+                    return;
                 }
-                else if (backsector->ceilingheight != frontsector->ceilingheight)
+            }
+            if (!backsector || (secret && !cheating))
+                AM_drawBigMline(l.a.x, l.a.y, l.b.x, l.b.y,
+                    (mapped || cheating ? wallcolor : (allmap ? allmapwallcolor : maskcolor)));
+            else if (backsector->floorheight != frontsector->floorheight)
+            {
+                if (mapped || cheating)
+                    AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, fdwallcolor);
+                else if (allmap)
+                    AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, allmapfdwallcolor);
+            }
+            else if (backsector->ceilingheight != frontsector->ceilingheight)
+            {
+                if (mapped || cheating)
+                    AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, cdwallcolor);
+                else if (allmap)
+                    AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, allmapcdwallcolor);
+            }
+            else if (cheating)
+                AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, tswallcolor);
+        }
+    }
+}
+
+//
+// Determines visible lines, draws them.
+// This is LineDef based, not LineSeg based.
+// Only the lines in the mapblocks covered by the frame are checked, unless
+//  the frame covers most of the blockmap anyway.
+//
+static void AM_drawWalls(void)
+{
+    dboolean    allmap = amsnapshot.allmap;
+    dboolean    cheating = amsnapshot.cheats & (CF_ALLMAP | CF_ALLMAP_THINGS);
+    int         left = MAX(0, (amsnapshot.frame.bbox[BOXLEFT]
+                    - (bmaporgx >> FRACTOMAPBITS)) >> MAPTOBLOCKSHIFT);
+    int         right = MIN(bmapwidth - 1, (amsnapshot.frame.bbox[BOXRIGHT]
+                    - (bmaporgx >> FRACTOMAPBITS)) >> MAPTOBLOCKSHIFT);
+    int         bottom = MAX(0, (amsnapshot.frame.bbox[BOXBOTTOM]
+                    - (bmaporgy >> FRACTOMAPBITS)) >> MAPTOBLOCKSHIFT);
+    int         top = MIN(bmapheight - 1, (amsnapshot.frame.bbox[BOXTOP]
+                    - (bmaporgy >> FRACTOMAPBITS)) >> MAPTOBLOCKSHIFT);
+
+    if (left <= right && bottom <= top)
+    {
+        if ((right - left + 1) * (top - bottom + 1) * 2 >= bmapwidth * bmapheight)
+        {
+            int i;
+
+            for (i = 0; i < numlines; i++)
+                AM_drawWall(i, allmap, cheating);
+        }
+        else
+        {
+            int x, y;
+
+            linevalidcount++;
+
+            for (y = bottom; y <= top; y++)
+                for (x = left; x <= right; x++)
                 {
-                    if (mapped || cheating)
-                        AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, cdwallcolor);
-                    else if (allmap)
-                        AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, allmapcdwallcolor);
+                    const int   *list = blockmaplump + blockmap[y * bmapwidth + x];
+
+                    if (skipblstart)
+                        list++;
+
+                    for (; *list != -1; list++)
+                        if (linecount[*list] != linevalidcount)
+                        {
+                            linecount[*list] = linevalidcount;
+                            AM_drawWall(*list, allmap, cheating);
+                        }
                 }
-                else if (cheating)
-                    AM_drawMline(l.a.x, l.a.y, l.b.x, l.b.y, tswallcolor);
-            }
         }
     }
 
     if (!cheating && !allmap)
     {
-        byte    *dot = mapscreen;
+        byte    *dot = fb;
+        byte    *area = fb + maparea;
 
         while (dot < area)
         {
@@ -1694,8 +1835,8 @@ static void AM_drawLineCharacter(mline_t *lineguy, int lineguylines, fixed_t sca
 {
     int i;
 
-    if (am_rotatemode)
-        angle -= plr->mo->angle - ANG90;
+    if (amsnapshot.rotatemode)
+        angle -= amsnapshot.playerangle - ANG90;
 
     for (i = 0; i < lineguylines; i++)
     {
@@ -1730,8 +1871,8 @@ static void AM_drawTransLineCharacter(mline_t *lineguy, int lineguylines, fixed_
 {
     int i;
 
-    if (am_rotatemode)
-        angle -= plr->mo->angle - ANG90;
+    if (amsnapshot.rotatemode)
+        angle -= amsnapshot.playerangle - ANG90;
 
     for (i = 0; i < lineguylines; i++)
     {
@@ -1763,29 +1904,26 @@ static void AM_drawTransLineCharacter(mline_t *lineguy, int lineguylines, fixed_
 
 static void AM_drawPlayer(void)
 {
-    int         invisibility = plr->powers[pw_invisibility];
-    mpoint_t    point;
+    int         invisibility = amsnapshot.invisibility;
+    mpoint_t    point = amsnapshot.player;
 
-    point.x = plr->mo->x >> FRACTOMAPBITS;
-    point.y = plr->mo->y >> FRACTOMAPBITS;
-
-    if (am_rotatemode)
+    if (amsnapshot.rotatemode)
         AM_rotatePoint(&point);
 
-    if (plr->cheats & (CF_ALLMAP | CF_ALLMAP_THINGS))
+    if (amsnapshot.cheats & (CF_ALLMAP | CF_ALLMAP_THINGS))
     {
         if (invisibility > 128 || (invisibility & 8))
-            AM_drawTransLineCharacter(cheatplayerarrow, CHEATPLAYERARROWLINES, 0, plr->mo->angle,
-                NULL, point.x, point.y);
+            AM_drawTransLineCharacter(cheatplayerarrow, CHEATPLAYERARROWLINES, 0,
+                amsnapshot.playerangle, NULL, point.x, point.y);
         else
-            AM_drawLineCharacter(cheatplayerarrow, CHEATPLAYERARROWLINES, 0, plr->mo->angle,
+            AM_drawLineCharacter(cheatplayerarrow, CHEATPLAYERARROWLINES, 0, amsnapshot.playerangle,
                 playercolor, point.x, point.y);
     }
     else if (invisibility > 128 || (invisibility & 8))
-        AM_drawTransLineCharacter(playerarrow, PLAYERARROWLINES, 0, plr->mo->angle, NULL,
+        AM_drawTransLineCharacter(playerarrow, PLAYERARROWLINES, 0, amsnapshot.playerangle, NULL,
             point.x, point.y);
     else
-        AM_drawLineCharacter(playerarrow, PLAYERARROWLINES, 0, plr->mo->angle, playercolor,
+        AM_drawLineCharacter(playerarrow, PLAYERARROWLINES, 0, amsnapshot.playerangle, playercolor,
             point.x, point.y);
 }
 
@@ -1793,57 +1931,23 @@ static void AM_drawThings(void)
 {
     int i;
 
-    for (i = 0; i < numsectors; i++)
+    for (i = 0; i < amsnapshot.numthings; i++)
     {
-        // e6y
-        // Two-pass method for better usability of automap:
-        // The first one will draw all things except enemies
-        // The second one is for enemies only
-        // Stop after first pass if the current sector has no enemies
-        int     pass;
-        int     enemies = 0;
-
-        for (pass = 0; pass < 2; pass += (enemies ? 1 : 2))
-        {
-            mobj_t      *thing = sectors[i].thinglist;
-
-            while (thing)
-            {
-                // e6y: stop if all enemies from current sector already have been drawn
-                if (pass && !enemies)
-                    break;
-                if (pass == ((thing->flags & (MF_SHOOTABLE | MF_CORPSE)) == MF_SHOOTABLE ?
-                    (!pass ? enemies++ : enemies--), 0 : 1))
-                {
-                    thing = thing->snext;
-                    continue;
-                }
+        am_thing_t  *thing = amsnapshot.things + i;
+        mpoint_t    point = thing->point;
+        int         fx;
+        int         fy;
+        int         w = thing->w;
 
-                if (!(thing->flags2 & MF2_DONTMAP))
-                {
-                    mpoint_t    point;
-                    int         fx;
-                    int         fy;
-                    int         lump = sprites[thing->sprite].spriteframes[0].lump[0];
-                    int         w = (BETWEEN(24 << FRACBITS, MIN(spritewidth[lump],
-                                    spriteheight[lump]), 96 << FRACBITS) >> FRACTOMAPBITS) / 2;
-
-                    point.x = thing->x >> FRACTOMAPBITS;
-                    point.y = thing->y >> FRACTOMAPBITS;
-
-                    if (am_rotatemode)
-                        AM_rotatePoint(&point);
+        if (amsnapshot.rotatemode)
+            AM_rotatePoint(&point);
 
-                    fx = CXMTOF(point.x);
-                    fy = CYMTOF(point.y);
+        fx = CXMTOF(point.x);
+        fy = CYMTOF(point.y);
 
-                    if (fx >= -w && fx <= (int)mapwidth + w && fy >= -w && fy <= (int)mapwidth + w)
-                        AM_drawLineCharacter(thingtriangle, THINGTRIANGLELINES, w, thing->angle,
-                            thingcolor, point.x, point.y);
-                }
-                thing = thing->snext;
-            }
-        }
+        if (fx >= -w && fx <= (int)mapwidth + w && fy >= -w && fy <= (int)mapwidth + w)
+            AM_drawLineCharacter(thingtriangle, THINGTRIANGLELINES, w, thing->angle, thingcolor,
+                point.x, point.y);
     }
 }
 
@@ -1878,7 +1982,7 @@ static void AM_drawMarks(void)
 {
     int i;
 
-    for (i = 0; i < markpointnum; i++)
+    for (i = 0; i < amsnapshot.markpointnum; i++)
     {
         int             number = i + 1;
         int             temp = number;
@@ -1886,10 +1990,10 @@ static void AM_drawMarks(void)
         int             x, y;
         mpoint_t        point;
 
-        point.x = markpoints[i].x;
-        point.y = markpoints[i].y;
+        point.x = amsnapshot.markpoints[i].x;
+        point.y = amsnapshot.markpoints[i].y;
 
-        if (am_rotatemode)
+        if (amsnapshot.rotatemode)
             AM_rotatePoint(&point);
 
         x = CXMTOF(point.x) - MARKWIDTH / 2 + 1;
@@ -1918,7 +2022,7 @@ static void AM_drawMarks(void)
                     if ((unsigned int)fy < mapheight)
                     {
                         char    src = marknums[digit][j];
-                        byte    *dest = mapscreen + fy * mapwidth + fx;
+                        byte    *dest = fb + fy * mapwidth + fx;
 
                         if (src == '2')
                             *dest = markcolor;
@@ -1936,11 +2040,14 @@ static void AM_drawMarks(void)
 
 void AM_drawPath(void)
 {
+    int         pathpointnum = amsnapshot.pathpointnum;
+    mpoint_t    *pathpoints = amsnapshot.pathpoints;
+
     if (pathpointnum >= 1)
     {
         int i;
 
-        if (am_rotatemode)
+        if (amsnapshot.rotatemode)
             for (i = 1; i < pathpointnum; i++)
             {
                 mpoint_t    start;
@@ -1970,7 +2077,7 @@ void AM_drawPath(void)
 
 static __inline void AM_drawScaledPixel(int x, int y, byte *color)
 {
-    byte        *dest = mapscreen + (y * 2 - 1) * mapwidth + x * 2 - 1;
+    byte        *dest = fb + (y * 2 - 1) * mapwidth + x * 2 - 1;
 
     *dest = *(*dest + color);
     dest++;
@@ -1999,11 +2106,12 @@ static void AM_drawCrosshair(void)
 
 static void AM_setFrameVariables(void)
 {
+    am_frame_t  *frame = &amsnapshot.frame;
     fixed_t     x = m_x + m_w / 2;
     fixed_t     y = m_y + m_h / 2;
 
-    am_frame.centerx = x;
-    am_frame.centery = y;
+    frame->centerx = x;
+    frame->centery = y;
 
     if (am_rotatemode)
     {
@@ -2012,37 +2120,298 @@ static void AM_setFrameVariables(void)
         float   dy = (float)(m_y2 - y);
         fixed_t r = (fixed_t)sqrt(dx * dx + dy * dy);
 
-        am_frame.sin = finesine[angle];
-        am_frame.cos = finecosine[angle];
+        frame->sin = finesine[angle];
+        frame->cos = finecosine[angle];
 
-        am_frame.bbox[BOXLEFT] = x - r;
-        am_frame.bbox[BOXRIGHT] = x + r;
-        am_frame.bbox[BOXBOTTOM] = y - r;
-        am_frame.bbox[BOXTOP] = y + r;
+        frame->bbox[BOXLEFT] = x - r;
+        frame->bbox[BOXRIGHT] = x + r;
+        frame->bbox[BOXBOTTOM] = y - r;
+        frame->bbox[BOXTOP] = y + r;
     }
     else
     {
-        am_frame.bbox[BOXLEFT] = m_x;
-        am_frame.bbox[BOXRIGHT] = m_x2;
-        am_frame.bbox[BOXBOTTOM] = m_y;
-        am_frame.bbox[BOXTOP] = m_y2;
+        frame->bbox[BOXLEFT] = m_x;
+        frame->bbox[BOXRIGHT] = m_x2;
+        frame->bbox[BOXBOTTOM] = m_y;
+        frame->bbox[BOXTOP] = m_y2;
     }
 }
 
-void AM_Drawer(void)
+static void AM_addThingToSnapshot(mobj_t *thing)
+{
+    am_thing_t  *snapshotthing;
+    int         lump = sprites[thing->sprite].spriteframes[0].lump[0];
+
+    if (amsnapshot.numthings >= amsnapshot.numthings_max)
+    {
+        amsnapshot.numthings_max = (amsnapshot.numthings_max ? amsnapshot.numthings_max << 1 : 256);
+        amsnapshot.things = Z_Realloc(amsnapshot.things,
+            amsnapshot.numthings_max * sizeof(*amsnapshot.things));
+    }
+
+    snapshotthing = amsnapshot.things + amsnapshot.numthings++;
+    snapshotthing->point.x = thing->x >> FRACTOMAPBITS;
+    snapshotthing->point.y = thing->y >> FRACTOMAPBITS;
+    snapshotthing->angle = thing->angle;
+    snapshotthing->w = (BETWEEN(24 << FRACBITS, MIN(spritewidth[lump], spriteheight[lump]),
+        96 << FRACBITS) >> FRACTOMAPBITS) / 2;
+}
+
+//
+// Copies the things that could be drawn in the frame into the snapshot. Only
+//  the sectors in the mapblocks covered by the frame are checked.
+//
+static void AM_snapshotThings(void)
+{
+    fixed_t     *bbox = amsnapshot.frame.bbox;
+    fixed_t     orgx = bmaporgx >> FRACTOMAPBITS;
+    fixed_t     orgy = bmaporgy >> FRACTOMAPBITS;
+    int         left = (bbox[BOXLEFT] - THINGMARGIN - orgx) >> MAPTOBLOCKSHIFT;
+    int         right = (bbox[BOXRIGHT] + THINGMARGIN - orgx) >> MAPTOBLOCKSHIFT;
+    int         bottom = (bbox[BOXBOTTOM] - THINGMARGIN - orgy) >> MAPTOBLOCKSHIFT;
+    int         top = (bbox[BOXTOP] + THINGMARGIN - orgy) >> MAPTOBLOCKSHIFT;
+    int         i;
+
+    for (i = 0; i < numsectors; i++)
+    {
+        sector_t    *sector = sectors + i;
+        int         pass;
+
+        if (sector->blockbox[BOXRIGHT] < left || sector->blockbox[BOXLEFT] > right
+            || sector->blockbox[BOXTOP] < bottom || sector->blockbox[BOXBOTTOM] > top)
+            continue;
+
+        // e6y
+        // Two-pass method for better usability of automap:
+        // The first one will add all things except enemies
+        // The second one is for enemies only, so they are drawn on top
+        for (pass = 0; pass < 2; pass++)
+        {
+            mobj_t  *thing = sector->thinglist;
+
+            while (thing)
+            {
+                if (!(thing->flags2 & MF2_DONTMAP)
+                    && pass == ((thing->flags & (MF_SHOOTABLE | MF_CORPSE)) == MF_SHOOTABLE))
+                    AM_addThingToSnapshot(thing);
+
+                thing = thing->snext;
+            }
+        }
+    }
+}
+
+//
+// Copies the position of the automap and the player into the snapshot.
+//
+static void AM_snapshotView(void)
 {
+    amsnapshot.m_x = m_x;
+    amsnapshot.m_y = m_y;
+    amsnapshot.m_w = m_w;
+    amsnapshot.m_h = m_h;
+    amsnapshot.scale_mtof = scale_mtof;
+    amsnapshot.rotatemode = am_rotatemode;
+    amsnapshot.followmode = am_followmode;
+    amsnapshot.grid = am_grid;
+    amsnapshot.path = am_path;
     AM_setFrameVariables();
-    AM_clearFB();
+
+    amsnapshot.player.x = plr->mo->x >> FRACTOMAPBITS;
+    amsnapshot.player.y = plr->mo->y >> FRACTOMAPBITS;
+    amsnapshot.playerangle = plr->mo->angle;
+    amsnapshot.cheats = plr->cheats;
+    amsnapshot.allmap = plr->powers[pw_allmap];
+    amsnapshot.invisibility = plr->powers[pw_invisibility];
+}
+
+//
+// Copies everything the automap draws that can change during a tic into the
+//  snapshot.
+//
+static void AM_takeSnapshot(void)
+{
+    int i;
+
+    AM_snapshotView();
+    snapshottic = gametic;
+
+    if (amsnapshot.numlines != numlines)
+    {
+        amsnapshot.numlines = numlines;
+        amsnapshot.lineflags = Z_Realloc(amsnapshot.lineflags,
+            numlines * sizeof(*amsnapshot.lineflags));
+        amsnapshot.linespecials = Z_Realloc(amsnapshot.linespecials,
+            numlines * sizeof(*amsnapshot.linespecials));
+        linecount = Z_Realloc(linecount, numlines * sizeof(*linecount));
+        memset(linecount, 0, numlines * sizeof(*linecount));
+        linevalidcount = 0;
+    }
+
+    for (i = 0; i < numlines; i++)
+    {
+        amsnapshot.lineflags[i] = lines[i].flags;
+        amsnapshot.linespecials[i] = lines[i].special;
+    }
+
+    if (amsnapshot.numsectors != numsectors)
+    {
+        amsnapshot.numsectors = numsectors;
+        amsnapshot.sectors = Z_Realloc(amsnapshot.sectors,
+            numsectors * sizeof(*amsnapshot.sectors));
+    }
+
+    for (i = 0; i < numsectors; i++)
+    {
+        amsnapshot.sectors[i].floorheight = sectors[i].floorheight;
+        amsnapshot.sectors[i].ceilingheight = sectors[i].ceilingheight;
+        amsnapshot.sectors[i].floorpic = sectors[i].floorpic;
+    }
+
+    amsnapshot.numthings = 0;
+
+    if (plr->cheats & CF_ALLMAP_THINGS)
+        AM_snapshotThings();
+
+    if (amsnapshot.pathpointnum_max < pathpointnum_max)
+    {
+        amsnapshot.pathpointnum_max = pathpointnum_max;
+        amsnapshot.pathpoints = Z_Realloc(amsnapshot.pathpoints,
+            pathpointnum_max * sizeof(*amsnapshot.pathpoints));
+    }
+
+    amsnapshot.pathpointnum = (am_path ? pathpointnum : 0);
+    memcpy(amsnapshot.pathpoints, pathpoints, amsnapshot.pathpointnum * sizeof(*pathpoints));
+
+    if (amsnapshot.markpointnum_max < markpointnum_max)
+    {
+        amsnapshot.markpointnum_max = markpointnum_max;
+        amsnapshot.markpoints = Z_Realloc(amsnapshot.markpoints,
+            markpointnum_max * sizeof(*amsnapshot.markpoints));
+    }
+
+    amsnapshot.markpointnum = markpointnum;
+    memcpy(amsnapshot.markpoints, markpoints, markpointnum * sizeof(*markpoints));
+}
+
+//
+// Draws the snapshot into buffer.
+//
+static void AM_drawSnapshot(byte *buffer)
+{
+    fb = buffer;
+    memset(fb, backcolor, maparea);
     AM_drawWalls();
-    if (am_grid)
+    if (amsnapshot.grid)
         AM_drawGrid();
-    if (am_path)
+    if (amsnapshot.path)
         AM_drawPath();
-    if (plr->cheats & CF_ALLMAP_THINGS)
+    if (amsnapshot.numthings)
         AM_drawThings();
-    if (markpointnum)
+    if (amsnapshot.markpointnum)
         AM_drawMarks();
     AM_drawPlayer();
-    if (!am_followmode)
+    if (!amsnapshot.followmode)
         AM_drawCrosshair();
 }
+
+//
+// AM_ExternalAutomapThread
+// Draws the external automap from the snapshot taken each tic, into the back
+//  buffer, so it doesn't hold up drawing the 3D view.
+//
+static int SDLCALL AM_ExternalAutomapThread(void *data)
+{
+    while (true)
+    {
+        SDL_SemWait(amstart);
+        AM_drawSnapshot(ambuffers[!amfront]);
+        SDL_SemPost(amdone);
+    }
+
+    return 0;
+}
+
+static void AM_initExternalAutomapThread(void)
+{
+    static dboolean initialized;
+    int             i;
+
+    if (initialized)
+        return;
+
+    initialized = true;
+
+    // big enough for the screen at any vid_renderscale, as for mapscreen
+    for (i = 0; i < 2; i++)
+        ambuffers[i] = Z_Malloc(MAXSCREENWIDTH * MAXSCREENHEIGHT, PU_STATIC, NULL);
+
+    if (!(amstart = SDL_CreateSemaphore(0)) || !(amdone = SDL_CreateSemaphore(0))
+        || !(amthread = SDL_CreateThread(AM_ExternalAutomapThread, "AM_ExternalAutomapThread",
+        NULL)))
+    {
+        C_Warning("A thread to draw the external automap couldn't be created.");
+
+        for (i = 0; i < 2; i++)
+        {
+            Z_Free(ambuffers[i]);
+            ambuffers[i] = NULL;
+        }
+    }
+}
+
+//
+// Swaps in the last frame of the external automap once it has been drawn,
+//  optionally waiting for it.
+//
+static void AM_finishExternalAutomap(dboolean wait)
+{
+    if (amdrawing && (wait ? SDL_SemWait(amdone) : SDL_SemTryWait(amdone)) == 0)
+    {
+        amdrawing = false;
+        amfront = !amfront;
+    }
+}
+
+//
+// AM_WaitForExternalAutomap
+// Must be called before anything the external automap thread reads while
+//  drawing, such as the level itself, is changed.
+//
+void AM_WaitForExternalAutomap(void)
+{
+    AM_finishExternalAutomap(true);
+}
+
+static void AM_updateExternalAutomap(void)
+{
+    AM_finishExternalAutomap(false);
+
+    if (!amdrawing)
+    {
+        AM_takeSnapshot();
+        amdrawing = true;
+        SDL_SemPost(amstart);
+    }
+}
+
+void AM_Drawer(void)
+{
+    if (mapwindow && amthread)
+    {
+        AM_finishExternalAutomap(false);
+        memcpy(mapscreen, ambuffers[amfront], maparea);
+    }
+    else
+    {
+        AM_finishExternalAutomap(true);
+
+        // the lines, sectors and things only change once a tic
+        if (snapshottic != gametic)
+            AM_takeSnapshot();
+        else
+            AM_snapshotView();
+
+        AM_drawSnapshot(mapscreen);
+    }
+}
@@ -75,6 +75,7 @@ void AM_Init(void);
 void AM_setColors(void);
 void AM_getGridSize(void);
 void AM_addToPath(void);
+void AM_WaitForExternalAutomap(void);
 
 extern dboolean         message_dontfuckwithme;
 extern dboolean         message_external;
@@ -53,6 +53,7 @@
 #include "hu_stuff.h"
 #include "i_gamepad.h"
 #include "i_system.h"
+#include "i_timer.h"
 #include "m_menu.h"
 #include "m_misc.h"
 #include "m_random.h"
@@ -158,6 +159,7 @@ extern int              r_blood;
 extern int              r_bloodsplats_max;
 extern int              r_bloodsplats_total;
 extern dboolean         r_brightmaps;
+extern dboolean         r_columnmajor;
 extern dboolean         r_corpses_color;
 extern dboolean         r_corpses_mirrored;
 extern dboolean         r_corpses_moreblood;
@@ -167,6 +169,9 @@ extern dboolean         r_corpses_smearblood;
 extern int              r_detail;
 extern int              r_diskicon;
 extern dboolean         r_dither;
+extern dboolean         r_drawcommands;
+extern dboolean         r_dynamicresolution;
+extern float            r_dynamicresolution_budget;
 extern dboolean         r_fixmaperrors;
 extern dboolean         r_fixspriteoffsets;
 extern dboolean         r_floatbob;
@@ -180,14 +185,23 @@ extern dboolean         r_liquid_lowerview;
 extern dboolean         r_liquid_swirl;
 extern char             *r_lowpixelsize;
 extern dboolean         r_mirroredweapons;
+extern dboolean         r_parallelplanes;
+extern dboolean         r_parallelsprites;
+extern dboolean         r_planestats;
 extern dboolean         r_playersprites;
+extern dboolean         r_pvs;
+extern dboolean         r_quadcolumns;
 extern dboolean         r_rockettrails;
 extern int              r_screensize;
 extern dboolean         r_shadows;
 extern dboolean         r_shake_barrels;
 extern int              r_shake_damage;
+extern int              r_simd;
 extern int              r_skycolor;
+extern int              r_texturecache;
+extern dboolean         r_texturecache_prebuild;
 extern dboolean         r_textures;
+extern int              r_threads;
 extern dboolean         r_translucency;
 extern int              s_musicvolume;
 extern dboolean         s_randommusic;
@@ -245,6 +259,8 @@ extern char             *vid_driver;
 extern dboolean         vid_fullscreen;
 extern int              vid_motionblur;
 extern dboolean         vid_pillarboxes;
+extern dboolean         vid_presentthread;
+extern int              vid_renderscale;
 extern char             *vid_scaleapi;
 extern char             *vid_scalefilter;
 extern char             *vid_screenresolution;
@@ -359,6 +375,7 @@ static dboolean game_func1(char *, char *);
 static dboolean null_func1(char *, char *);
 
 void alias_cmd_func2(char *, char *);
+static void benchmark_cmd_func2(char *, char *);
 void bind_cmd_func2(char *, char *);
 static void bindlist_cmd_func2(char *, char *);
 static void clear_cmd_func2(char *, char *);
@@ -370,6 +387,7 @@ static void exec_cmd_func2(char *, char *);
 static void exitmap_cmd_func2(char *, char *);
 static dboolean fastmonsters_cmd_func1(char *, char *);
 static void fastmonsters_cmd_func2(char *, char *);
+static void frametimes_cmd_func2(char *, char *);
 static void freeze_cmd_func2(char *, char *);
 static dboolean give_cmd_func1(char *, char *);
 static void give_cmd_func2(char *, char *);
@@ -392,6 +410,7 @@ static void play_cmd_func2(char *, char *);
 static void playerstats_cmd_func2(char *, char *);
 static void quit_cmd_func2(char *, char *);
 static void regenhealth_cmd_func2(char *, char *);
+static void renderstats_cmd_func2(char *, char *);
 static void reset_cmd_func2(char *, char *);
 static void resetall_cmd_func2(char *, char *);
 static void respawnitems_cmd_func2(char *, char *);
@@ -404,6 +423,7 @@ static void save_cmd_func2(char *, char *);
 static dboolean spawn_cmd_func1(char *, char *);
 static void spawn_cmd_func2(char *, char *);
 static void teleport_cmd_func2(char *, char *);
+static void texturecache_cmd_func2(char *, char *);
 static void thinglist_cmd_func2(char *, char *);
 static void unbind_cmd_func2(char *, char *);
 static void vanilla_cmd_func2(char *, char *);
@@ -430,17 +450,24 @@ static void player_cvars_func2(char *, char *);
 static void playername_cvar_func2(char *, char *);
 static dboolean r_blood_cvar_func1(char *, char *);
 static void r_blood_cvar_func2(char *, char *);
+static void r_bloodsplats_max_cvar_func2(char *, char *);
 static dboolean r_detail_cvar_func1(char *, char *);
 static void r_detail_cvar_func2(char *, char *);
 static void r_dither_cvar_func2(char *, char *);
+static void r_dynamicresolution_cvar_func2(char *, char *);
 static dboolean r_gamma_cvar_func1(char *, char *);
 static void r_gamma_cvar_func2(char *, char *);
 static void r_hud_cvar_func2(char *, char *);
 static void r_lowpixelsize_cvar_func2(char *, char *);
+static void r_pvs_cvar_func2(char *, char *);
+static void r_quadcolumns_cvar_func2(char *, char *);
 static void r_screensize_cvar_func2(char *, char *);
+static void r_simd_cvar_func2(char *, char *);
 static dboolean r_skycolor_cvar_func1(char *, char *);
 static void r_skycolor_cvar_func2(char *, char *);
+static void r_texturecache_cvar_func2(char *, char *);
 static void r_textures_cvar_func2(char *, char *);
+static void r_threads_cvar_func2(char *, char *);
 static void r_translucency_cvar_func2(char *, char *);
 static dboolean s_volume_cvars_func1(char *, char *);
 static void s_volume_cvars_func2(char *, char *);
@@ -452,6 +479,8 @@ static dboolean vid_capfps_cvar_func1(char *, char *);
 static void vid_capfps_cvar_func2(char *, char *);
 static void vid_display_cvar_func2(char *, char *);
 static void vid_fullscreen_cvar_func2(char *, char *);
+static void vid_presentthread_cvar_func2(char *, char *);
+static void vid_renderscale_cvar_func2(char *, char *);
 static dboolean vid_scaleapi_cvar_func1(char *, char *);
 static void vid_scaleapi_cvar_func2(char *, char *);
 static dboolean vid_scalefilter_cvar_func1(char *, char *);
@@ -570,6 +599,8 @@ consolecmd_t consolecmds[] =
         "The player's armor."),
     CVAR_BOOL(autoload, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
         "Toggles automatically loading the last savegame after\nthe player dies."),
+    CMD(benchmark, "", game_func1, benchmark_cmd_func2, 1, "[<i>frames</i>]",
+        "Benchmarks drawing the 3D view into a row-major\nand a column-major framebuffer, and walking the\nBSP tree before and after its nodes are packed."),
     CMD(bind, "", null_func1, bind_cmd_func2, 2, BINDCMDFORMAT,
         "Binds an <i>action</i> to a <i>control</i>."),
     CMD(bindlist, "", null_func1, bindlist_cmd_func2, 0, "",
@@ -602,6 +633,8 @@ consolecmd_t consolecmds[] =
         "The color behind the player's face in the status bar (<b>0</b>\nto <b>255</b>)."),
     CMD(fastmonsters, "", game_func1, fastmonsters_cmd_func2, 1, "[<b>on</b>|<b>off</b>]",
         "Toggles fast monsters."),
+    CMD(frametimes, "", null_func1, frametimes_cmd_func2, 1, "[<b>reset</b>]",
+        "Shows a histogram of the time between frames, or\nresets it."),
     CMD(freeze, "", null_func1, freeze_cmd_func2, 1, "[<b>on</b>|<b>off</b>]",
         "Toggles freeze mode."),
     CVAR_TIME(gametime, "", null_func1, time_cvars_func2,
@@ -696,12 +729,14 @@ consolecmd_t consolecmds[] =
         "The intensity of the red palette effect when the player\nhas the berserk power-up and their fist selected (<b>0</b>\nto <b>8</b>)."),
     CVAR_INT(r_blood, "", r_blood_cvar_func1, r_blood_cvar_func2, CF_NONE, BLOODVALUEALIAS,
         "The colors of the blood of the player and monsters (<b>all</b>,\n<b>none</b> or <b>red</b>)."),
-    CVAR_INT(r_bloodsplats_max, "", int_cvars_func1, int_cvars_func2, CF_NONE, NOVALUEALIAS,
+    CVAR_INT(r_bloodsplats_max, "", int_cvars_func1, r_bloodsplats_max_cvar_func2, CF_NONE, NOVALUEALIAS,
         "The maximum number of blood splats allowed in a map (<b>0</b>\nto <b>1,048,576</b>)."),
     CVAR_INT(r_bloodsplats_total, "", int_cvars_func1, int_cvars_func2, CF_READONLY, NOVALUEALIAS,
         "The total number of blood splats in the current map."),
     CVAR_BOOL(r_brightmaps, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
         "Toggles brightmaps on certain wall textures."),
+    CVAR_BOOL(r_columnmajor, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
+        "Toggles drawing the 3D view into a column-major framebuffer."),
     CVAR_BOOL(r_corpses_color, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
         "Toggles corpses of marines being randomly colored."),
     CVAR_BOOL(r_corpses_mirrored, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
@@ -720,6 +755,12 @@ consolecmd_t consolecmds[] =
         "Toggles showing a disk icon when loading and saving."),
     CVAR_BOOL(r_dither, "", bool_cvars_func1, r_dither_cvar_func2, BOOLVALUEALIAS,
         "Toggles dithering of <i><b>BOOM</b></i>-compatible translucent wall\ntextures."),
+    CVAR_BOOL(r_drawcommands, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
+        "Toggles recording the columns and spans of the 3D view\nin a command buffer before drawing them."),
+    CVAR_BOOL(r_dynamicresolution, "", bool_cvars_func1, r_dynamicresolution_cvar_func2,
+        BOOLVALUEALIAS, "Toggles lowering the resolution of the 3D view to keep\nthe time it takes to render within its budget."),
+    CVAR_FLOAT(r_dynamicresolution_budget, "", float_cvars_func1, float_cvars_func2, CF_NONE,
+        "The time in milliseconds that rendering the 3D view\nshould take when <b>r_dynamicresolution</b> is <b>on</b>."),
     CVAR_BOOL(r_fixmaperrors, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
         "Toggles the fixing of mapping errors in the <i><b>DOOM</b></i> and\n<i><b>DOOM II</b></i> IWADs."),
     CVAR_BOOL(r_fixspriteoffsets, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
@@ -746,8 +787,18 @@ consolecmd_t consolecmds[] =
         "The size of the pixels when the graphic detail is low\n(<i>width</i><b>\xD7</b><i>height</i>)."),
     CVAR_BOOL(r_mirroredweapons, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
         "Toggles randomly mirroring the weapons dropped by\nmonsters."),
+    CVAR_BOOL(r_parallelplanes, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
+        "Toggles drawing the floors and ceilings of the 3D view\nin parallel when <b>r_threads</b> is greater than <b>1</b>."),
+    CVAR_BOOL(r_parallelsprites, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
+        "Toggles drawing the sprites and masked textures in the\n3D view in parallel when <b>r_threads</b> is greater\nthan <b>1</b>."),
+    CVAR_BOOL(r_planestats, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
+        "Toggles showing statistics about the visplanes in the\n3D view."),
     CVAR_BOOL(r_playersprites, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
         "Toggles showing the player's weapon."),
+    CVAR_BOOL(r_pvs, "", bool_cvars_func1, r_pvs_cvar_func2, BOOLVALUEALIAS,
+        "Toggles building a potentially visible set for each\nmap, so that the parts of it that can never be seen\nfrom the player's sector aren't drawn."),
+    CVAR_BOOL(r_quadcolumns, "", bool_cvars_func1, r_quadcolumns_cvar_func2, BOOLVALUEALIAS,
+        "Toggles drawing the walls in the 3D view four columns\nat a time."),
     CVAR_BOOL(r_rockettrails, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
         "Toggles the trails behind rockets fired by the player\nand cyberdemons."),
     CVAR_INT(r_screensize, "", int_cvars_func1, r_screensize_cvar_func2, CF_NONE, NOVALUEALIAS,
@@ -758,14 +809,24 @@ consolecmd_t consolecmds[] =
         "Toggles shaking the screen when the player is near an\nexploding barrel."),
     CVAR_INT(r_shake_damage, "", int_cvars_func1, int_cvars_func2, CF_PERCENT, NOVALUEALIAS,
         "The amount the screen shakes when the player is\nattacked."),
+    CVAR_INT(r_simd, "", int_cvars_func1, r_simd_cvar_func2, CF_NONE, SIMDVALUEALIAS,
+        "The instructions used to draw walls, floors and ceilings\n(<b>auto</b>, <b>none</b>, <b>sse2</b> or <b>avx2</b>)."),
     CVAR_INT(r_skycolor, r_skycolour, r_skycolor_cvar_func1, r_skycolor_cvar_func2, CF_NONE, SKYVALUEALIAS,
         "The color of the sky (<b>none</b>, or <b>0</b> to <b>255</b>)."),
+    CVAR_INT(r_texturecache, "", int_cvars_func1, r_texturecache_cvar_func2, CF_NONE, NOVALUEALIAS,
+        "The amount of memory in megabytes used to cache\ntextures (<b>8</b> to <b>1,024</b>)."),
+    CVAR_BOOL(r_texturecache_prebuild, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
+        "Toggles building the textures in the current map before\nthey are needed."),
     CVAR_BOOL(r_textures, "", bool_cvars_func1, r_textures_cvar_func2, BOOLVALUEALIAS,
         "Toggles displaying all textures."),
+    CVAR_INT(r_threads, "", int_cvars_func1, r_threads_cvar_func2, CF_NONE, NOVALUEALIAS,
+        "The number of threads used to render the 3D view (<b>1</b>\nto <b>16</b>)."),
     CVAR_BOOL(r_translucency, "", bool_cvars_func1, r_translucency_cvar_func2, BOOLVALUEALIAS,
         "Toggles the translucency of sprites and textures."),
     CMD(regenhealth, "", null_func1, regenhealth_cmd_func2, 1, "[<b>on</b>|<b>off</b>]",
         "Toggles regenerating health."),
+    CMD(renderstats, "", null_func1, renderstats_cmd_func2, 0, "",
+        "Shows statistics about the rendering of the 3D view."),
     CMD(reset, "", null_func1, reset_cmd_func2, 1, RESETCMDFORMAT,
         "Resets a <i>CVAR</i> to its default value."),
     CMD(resetall, "", null_func1, resetall_cmd_func2, 0, "",
@@ -798,6 +859,8 @@ consolecmd_t consolecmds[] =
         "The amount the player's view and weapon bob up and\ndown when they stand still."),
     CMD(teleport, "", game_func1, teleport_cmd_func2, 2, TELEPORTCMDFORMAT,
         "Teleports the player to (<i>x</i>,<i>y</i>) in the current map."),
+    CMD(texturecache, "", null_func1, texturecache_cmd_func2, 0, "",
+        "Shows statistics about the cache of textures."),
     CMD(thinglist, "", game_func1, thinglist_cmd_func2, 0, "",
         "Shows a list of things in the current map."),
     CVAR_INT(turbo, "", turbo_cvar_func1, turbo_cvar_func2, CF_PERCENT, NOVALUEALIAS,
@@ -824,6 +887,10 @@ consolecmd_t consolecmds[] =
         "The amount of motion blur when the player turns quickly."),
     CVAR_BOOL(vid_pillarboxes, "", bool_cvars_func1, vid_fullscreen_cvar_func2, BOOLVALUEALIAS,
         "Toggles using the pillarboxes either side of the screen\nfor palette effects."),
+    CVAR_BOOL(vid_presentthread, "", bool_cvars_func1, vid_presentthread_cvar_func2, BOOLVALUEALIAS,
+        "Toggles converting and presenting each frame on a separate\nthread while the next one is rendered, when fullscreen."),
+    CVAR_INT(vid_renderscale, "", int_cvars_func1, vid_renderscale_cvar_func2, CF_NONE, NOVALUEALIAS,
+        "The scale of the internal render resolution, as a multiple\nof 320x200 (<b>1</b> to <b>4</b>)."),
     CVAR_STR(vid_scaleapi, "", vid_scaleapi_cvar_func1, vid_scaleapi_cvar_func2, CF_NONE,
         "The API used to scale the display (<b>\"direct3d\"</b>, <b>\"opengl\"</b>\nor <b>\"software\"</b>)."),
     CVAR_STR(vid_scalefilter, "", vid_scalefilter_cvar_func1, vid_scalefilter_cvar_func2, CF_NONE,
@@ -1008,6 +1075,41 @@ void alias_cmd_func2(char *cmd, char *parms)
         }
 }
 
+//
+// benchmark CCMD
+//
+static void benchmark_cmd_func2(char *cmd, char *parms)
+{
+    int         tabs[8] = { 120, 240, 0, 0, 0, 0, 0, 0 };
+    int         frames = 100;
+    uint64_t    rowmajortime;
+    uint64_t    columnmajortime;
+    uint64_t    nodetime;
+    uint64_t    packednodetime;
+
+    if (*parms)
+        sscanf(parms, "%10i", &frames);
+
+    frames = BETWEEN(1, frames, 10000);
+
+    R_BenchmarkColumnMajor(frames, &rowmajortime, &columnmajortime);
+
+    C_TabbedOutput(tabs, "Frames\t<b>%s</b>", commify(frames));
+    C_TabbedOutput(tabs, "Row-major\t<b>%.2f</b>ms per frame", rowmajortime / 1000.0);
+    C_TabbedOutput(tabs, "Column-major\t<b>%.2f</b>ms per frame", columnmajortime / 1000.0);
+
+    if (rowmajortime && columnmajortime)
+        C_TabbedOutput(tabs, "Speedup\t<b>%.2f</b>x", (double)rowmajortime / columnmajortime);
+
+    R_BenchmarkNodes(frames * 10, &nodetime, &packednodetime);
+
+    C_TabbedOutput(tabs, "BSP nodes\t<b>%s</b>ns per walk", commify(nodetime));
+    C_TabbedOutput(tabs, "Packed nodes\t<b>%s</b>ns per walk", commify(packednodetime));
+
+    if (nodetime && packednodetime)
+        C_TabbedOutput(tabs, "Speedup\t<b>%.2f</b>x", (double)nodetime / packednodetime);
+}
+
 //
 // bind CCMD
 //
@@ -1652,6 +1754,54 @@ static void fastmonsters_cmd_func2(char *cmd, char *parms)
     }
 }
 
+//
+// frametimes CCMD
+//
+static void frametimes_cmd_func2(char *cmd, char *parms)
+{
+    int         tabs[8] = { 120, 240, 0, 0, 0, 0, 0, 0 };
+    int         frames = frametimestats.frames;
+    uint64_t    total = frametimestats.total;
+    int         i;
+
+    if (M_StringCompare(parms, "reset"))
+    {
+        I_ResetFrameTimes();
+        C_Output("The frame time histogram has been reset.");
+        return;
+    }
+
+    if (!frames || !total)
+    {
+        C_Output("No frames have been timed yet.");
+        return;
+    }
+
+    C_TabbedOutput(tabs, "Frames\t<b>%s</b>", commify(frames));
+    C_TabbedOutput(tabs, "Average\t<b>%.2f</b>ms (<b>%.1f</b> FPS)", total / 1000.0 / frames,
+        frames * 1000000.0 / total);
+    C_TabbedOutput(tabs, "Shortest\t<b>%.2f</b>ms", frametimestats.shortest / 1000.0);
+    C_TabbedOutput(tabs, "Longest\t<b>%.2f</b>ms", frametimestats.longest / 1000.0);
+
+    for (i = 0; i < NUMFRAMETIMEBUCKETS; i++)
+    {
+        int     count = frametimestats.buckets[i];
+        char    range[32];
+
+        if (!count)
+            continue;
+
+        if (!i)
+            M_snprintf(range, sizeof(range), "Under %ims", frametimebuckets[0]);
+        else if (i == NUMFRAMETIMEBUCKETS - 1)
+            M_snprintf(range, sizeof(range), "%ims or more", frametimebuckets[i - 1]);
+        else
+            M_snprintf(range, sizeof(range), "%i-%ims", frametimebuckets[i - 1], frametimebuckets[i]);
+
+        C_TabbedOutput(tabs, "%s\t<b>%s</b>\t%.1f%%", range, commify(count), count * 100.0 / frames);
+    }
+}
+
 //
 // freeze CCMD
 //
@@ -3462,6 +3612,93 @@ static void regenhealth_cmd_func2(char *cmd, char *parms)
         HU_PlayerMessage(s_STSTR_RHOFF, false, false);
 }
 
+//
+// renderstats CCMD
+//
+static void renderstats_cmd_func2(char *cmd, char *parms)
+{
+    int tabs[8] = { 120, 240, 0, 0, 0, 0, 0, 0 };
+    int i;
+
+    C_TabbedOutput(tabs, "Threads\t<b>%i</b>", numrenderthreads);
+
+    if (!renderstats.frames)
+    {
+        C_Output("No frames have been rendered since these statistics were last shown.");
+        return;
+    }
+
+    C_TabbedOutput(tabs, "Frames\t<b>%s</b>", commify(renderstats.frames));
+    C_TabbedOutput(tabs, "Average time\t<b>%.2f</b>ms",
+        renderstats.frametime / 1000.0 / renderstats.frames);
+
+    if (numrenderthreads > 1 && (r_parallelplanes || r_parallelsprites))
+    {
+        C_TabbedOutput(tabs, "3D view\t<b>%.2f</b>ms",
+            renderstats.striptime[0] / 1000.0 / renderstats.frames);
+
+        for (i = 0; i < numrenderthreads; i++)
+        {
+            C_TabbedOutput(tabs, "Thread %i", i + 1);
+
+            if (r_parallelplanes)
+                C_TabbedOutput(tabs, "\tFloors and ceilings <b>%.2f</b>ms",
+                    renderstats.planetime[i] / 1000.0 / renderstats.frames);
+
+            if (r_parallelsprites)
+                C_TabbedOutput(tabs, "\tSprites in columns <b>%i</b> to <b>%i</b>, <b>%.2f</b>ms",
+                    viewwidth * i / numrenderthreads, viewwidth * (i + 1) / numrenderthreads - 1,
+                    renderstats.maskedtime[i] / 1000.0 / renderstats.frames);
+        }
+    }
+    else
+        for (i = 0; i < numrenderthreads; i++)
+        {
+            C_TabbedOutput(tabs, "Strip %i\tColumns <b>%i</b> to <b>%i</b>, <b>%.2f</b>ms", i + 1,
+                viewwidth * i / numrenderthreads, viewwidth * (i + 1) / numrenderthreads - 1,
+                renderstats.striptime[i] / 1000.0 / renderstats.frames);
+
+            if (renderstats.drawcommands[i])
+                C_TabbedOutput(tabs, "\t<b>%s</b> draw commands per frame",
+                    commify(renderstats.drawcommands[i] / renderstats.frames));
+        }
+
+    if (renderstats.vertexcachehits + renderstats.vertexcachemisses)
+        C_TabbedOutput(tabs, "Vertex angles\t<b>%s</b> calculated, <b>%s</b> cached (<b>%.1f%%</b>)",
+            commify(renderstats.vertexcachemisses), commify(renderstats.vertexcachehits),
+            renderstats.vertexcachehits * 100.0
+            / (renderstats.vertexcachehits + renderstats.vertexcachemisses));
+
+    if (renderstats.spritesclipped)
+        C_TabbedOutput(tabs, "Drawsegs per sprite\t<b>%.1f</b> examined of <b>%.1f</b>",
+            (double)renderstats.drawsegsexamined / renderstats.spritesclipped,
+            (double)renderstats.drawsegsscanned / renderstats.spritesclipped);
+
+    C_TabbedOutput(tabs, "Dynamic resolution\t<b>%s</b>", (r_dynamicresolution ? "on" : "off"));
+
+    if (r_dynamicresolution)
+    {
+        C_TabbedOutput(tabs, "Resolution\t<b>%i%%</b> (<b>%ix%i</b>), budget <b>%.2f</b>ms", viewscale,
+            viewwidth, viewheight, r_dynamicresolution_budget);
+
+        if (numviewscalechanges)
+        {
+            C_TabbedOutput(tabs, "Changes\t<b>%s</b>", commify(numviewscalechanges));
+
+            for (i = MAX(0, numviewscalechanges - MAXVIEWSCALECHANGES); i < numviewscalechanges; i++)
+            {
+                const viewscalechange_t *change = &viewscalechanges[i % MAXVIEWSCALECHANGES];
+
+                C_TabbedOutput(tabs, "\t%s from <b>%i%%</b> to <b>%i%%</b> at tic <b>%s</b> (<b>%.2f</b>ms)",
+                    (change->to < change->from ? "Lowered" : "Raised"), change->from, change->to,
+                    commify(change->gametic), change->frametime / 1000.0);
+            }
+        }
+    }
+
+    R_ResetRenderStats();
+}
+
 //
 // respawnitems CCMD
 //
@@ -3750,6 +3987,24 @@ static void teleport_cmd_func2(char *cmd, char *parms)
     }
 }
 
+//
+// texturecache CCMD
+//
+static void texturecache_cmd_func2(char *cmd, char *parms)
+{
+    int             tabs[8] = { 120, 0, 0, 0, 0, 0, 0, 0 };
+    const uint64_t  lookups = texturecachestats.hits + texturecachestats.misses;
+
+    C_TabbedOutput(tabs, "Memory\t<b>%.2f</b> of <b>%i</b>MB", texturecachestats.size / 1048576.0,
+        r_texturecache);
+    C_TabbedOutput(tabs, "Textures\t<b>%s</b>", commify(texturecachestats.textures));
+    C_TabbedOutput(tabs, "Hits\t<b>%s</b> (<b>%.1f%%</b>)", commify(texturecachestats.hits),
+        (lookups ? texturecachestats.hits * 100.0 / lookups : 0.0));
+    C_TabbedOutput(tabs, "Misses\t<b>%s</b>", commify(texturecachestats.misses));
+    C_TabbedOutput(tabs, "Evictions\t<b>%s</b>", commify(texturecachestats.evictions));
+    C_TabbedOutput(tabs, "Prebuilt\t<b>%s</b>", commify(texturecachestats.prebuilt));
+}
+
 //
 // thinglist CCMD
 //
@@ -4401,6 +4656,19 @@ static void r_blood_cvar_func2(char *cmd, char *parms)
     }
 }
 
+//
+// r_bloodsplats_max CVAR
+//
+static void r_bloodsplats_max_cvar_func2(char *cmd, char *parms)
+{
+    const int   r_bloodsplats_max_old = r_bloodsplats_max;
+
+    int_cvars_func2(cmd, parms);
+
+    if (r_bloodsplats_max != r_bloodsplats_max_old && gamestate == GS_LEVEL)
+        P_ResizeBloodSplats();
+}
+
 //
 // r_detail CVAR
 //
@@ -4467,6 +4735,19 @@ static void r_dither_cvar_func2(char *cmd, char *parms)
     }
 }
 
+//
+// r_dynamicresolution CVAR
+//
+static void r_dynamicresolution_cvar_func2(char *cmd, char *parms)
+{
+    const dboolean  r_dynamicresolution_old = r_dynamicresolution;
+
+    bool_cvars_func2(cmd, parms);
+
+    if (r_dynamicresolution != r_dynamicresolution_old)
+        R_ResetViewScale();
+}
+
 //
 // r_gamma CVAR
 //
@@ -4541,6 +4822,32 @@ static void r_lowpixelsize_cvar_func2(char *cmd, char *parms)
     }
 }
 
+//
+// r_pvs CVAR
+//
+static void r_pvs_cvar_func2(char *cmd, char *parms)
+{
+    const dboolean  pvs = r_pvs;
+
+    bool_cvars_func2(cmd, parms);
+
+    if (r_pvs != pvs && gamestate == GS_LEVEL)
+        P_LoadPVS();
+}
+
+//
+// r_quadcolumns CVAR
+//
+static void r_quadcolumns_cvar_func2(char *cmd, char *parms)
+{
+    const dboolean  quadcolumns = r_quadcolumns;
+
+    bool_cvars_func2(cmd, parms);
+
+    if (r_quadcolumns != quadcolumns)
+        R_InitColumnFunctions();
+}
+
 //
 // r_screensize CVAR
 //
@@ -4596,6 +4903,21 @@ static void r_screensize_cvar_func2(char *cmd, char *parms)
     }
 }
 
+//
+// r_simd CVAR
+//
+static void r_simd_cvar_func2(char *cmd, char *parms)
+{
+    int r_simd_old = r_simd;
+
+    int_cvars_func2(cmd, parms);
+    if (r_simd != r_simd_old)
+    {
+        R_InitSIMDDrawers();
+        R_InitColumnFunctions();
+    }
+}
+
 //
 // r_skycolor CVAR
 //
@@ -4628,6 +4950,19 @@ static void r_skycolor_cvar_func2(char *cmd, char *parms)
     }
 }
 
+//
+// r_texturecache CVAR
+//
+static void r_texturecache_cvar_func2(char *cmd, char *parms)
+{
+    const int   r_texturecache_old = r_texturecache;
+
+    int_cvars_func2(cmd, parms);
+
+    if (r_texturecache < r_texturecache_old)
+        R_TrimTextureCache();
+}
+
 //
 // r_textures CVAR
 //
@@ -4647,8 +4982,7 @@ static void r_textures_cvar_func2(char *cmd, char *parms)
 
             for (i = 0; i < numsectors; i++)
             {
-                mobj_t          *mo = sectors[i].thinglist;
-                bloodsplat_t    *splat = sectors[i].splatlist;
+                mobj_t  *mo = sectors[i].thinglist;
 
                 while (mo)
                 {
@@ -4660,12 +4994,13 @@ static void r_textures_cvar_func2(char *cmd, char *parms)
                         mo->shadowcolfunc = R_DrawColorColumn;
                     mo = mo->snext;
                 }
+            }
 
-                while (splat)
-                {
-                    splat->colfunc = (splat->blood == FUZZYBLOOD ? fuzzcolfunc : bloodsplatcolfunc);
-                    splat = splat->snext;
-                }
+            for (i = 0; i < bloodsplatpoolsize; i++)
+            {
+                bloodsplat_t    *splat = bloodsplatpool + i;
+
+                splat->colfunc = (splat->blood == FUZZYBLOOD ? fuzzcolfunc : bloodsplatcolfunc);
             }
         }
     }
@@ -4682,6 +5017,18 @@ static void r_textures_cvar_func2(char *cmd, char *parms)
     }
 }
 
+//
+// r_threads CVAR
+//
+static void r_threads_cvar_func2(char *cmd, char *parms)
+{
+    int r_threads_old = r_threads;
+
+    int_cvars_func2(cmd, parms);
+    if (r_threads != r_threads_old)
+        R_InitRenderThreads();
+}
+
 //
 // r_translucency CVAR
 //
@@ -4702,8 +5049,7 @@ static void r_translucency_cvar_func2(char *cmd, char *parms)
 
             for (i = 0; i < numsectors; i++)
             {
-                mobj_t          *mo = sectors[i].thinglist;
-                bloodsplat_t    *splat = sectors[i].splatlist;
+                mobj_t  *mo = sectors[i].thinglist;
 
                 while (mo)
                 {
@@ -4715,12 +5061,13 @@ static void r_translucency_cvar_func2(char *cmd, char *parms)
                         mo->shadowcolfunc = R_DrawColorColumn;
                     mo = mo->snext;
                 }
+            }
 
-                while (splat)
-                {
-                    splat->colfunc = (splat->blood == FUZZYBLOOD ? fuzzcolfunc : bloodsplatcolfunc);
-                    splat = splat->snext;
-                }
+            for (i = 0; i < bloodsplatpoolsize; i++)
+            {
+                bloodsplat_t    *splat = bloodsplatpool + i;
+
+                splat->colfunc = (splat->blood == FUZZYBLOOD ? fuzzcolfunc : bloodsplatcolfunc);
             }
         }
     }
@@ -4944,6 +5291,30 @@ static void vid_fullscreen_cvar_func2(char *cmd, char *parms)
         I_ToggleFullscreen();
 }
 
+//
+// vid_presentthread CVAR
+//
+static void vid_presentthread_cvar_func2(char *cmd, char *parms)
+{
+    dboolean    vid_presentthread_old = vid_presentthread;
+
+    bool_cvars_func2(cmd, parms);
+    if (vid_presentthread != vid_presentthread_old)
+        I_RestartPresentThread();
+}
+
+//
+// vid_renderscale CVAR
+//
+static void vid_renderscale_cvar_func2(char *cmd, char *parms)
+{
+    int vid_renderscale_old = vid_renderscale;
+
+    int_cvars_func2(cmd, parms);
+    if (vid_renderscale != vid_renderscale_old)
+        I_SetRenderScale();
+}
+
 //
 // vid_scaleapi CVAR
 //
@@ -68,8 +68,8 @@
 #define CONSOLETEXTY            8
 #define CONSOLETEXTMAXLENGTH    1024
 #define CONSOLETEXTPIXELWIDTH   (CONSOLEWIDTH - CONSOLETEXTX * 3 - CONSOLESCROLLBARWIDTH + 3)
-#define CONSOLELINES            (gamestate != GS_TITLESCREEN ? 11 : 27)
 #define CONSOLELINEHEIGHT       14
+#define CONSOLELINES            (CONSOLEHEIGHT / CONSOLELINEHEIGHT - 1)
 
 #define CONSOLEINPUTPIXELWIDTH  (CONSOLEWIDTH - CONSOLETEXTX - brandwidth - 2)
 
@@ -146,8 +146,8 @@ static const char *shiftxform =
     ")!@#$%^&*(::<+>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ{|}\"_'ABCDEFGHIJKLMNOPQRSTUVWXYZ{|}~\0"
 };
 
-static byte     c_tempscreen[SCREENWIDTH * SCREENHEIGHT];
-static byte     c_blurscreen[SCREENWIDTH * SCREENHEIGHT];
+static byte     c_tempscreen[MAXSCREENWIDTH * MAXSCREENHEIGHT];
+static byte     c_blurscreen[MAXSCREENWIDTH * MAXSCREENHEIGHT];
 
 static int      consolecaretcolor = 4;
 static int      consolelowfpscolor = 180;
@@ -174,7 +174,12 @@ static int      consolescrollbarfacecolor = 94;
 static int      consolecolors[STRINGTYPES];
 
 extern int      fps;
+extern int      presentqueuedepth;
+extern int      presentdroppedframes;
+extern int      converttime;
+extern SDL_Thread *presentthread;
 extern int      refreshrate;
+extern dboolean r_dynamicresolution;
 extern dboolean r_translucency;
 extern dboolean windowfocused;
 extern dboolean vanilla;
@@ -623,6 +628,9 @@ static void C_DrawBackground(int height)
     static dboolean     blurred;
     int                 i;
 
+    // include the bottom edge and the shadow below it
+    V_MarkDirtyRows(0, height + 10);
+
     height = (height + 5) * CONSOLEWIDTH;
 
     if (r_translucency)
@@ -860,9 +868,23 @@ void C_UpdateFPS(void)
 {
     if (fps && !wipe && !paused && !menuactive)
     {
-        static char     buffer[16];
+        static char     buffer[128];
+        char            details[64] = "";
+
+        if (r_dynamicresolution && viewscale < 100)
+            M_snprintf(details, sizeof(details), "%i%%, ", viewscale);
 
-        M_snprintf(buffer, 16, "%i FPS", fps);
+        if (presentthread)
+        {
+            const int   length = (int)strlen(details);
+
+            M_snprintf(details + length, sizeof(details) - length, "%i queued, %i dropped, ",
+                presentqueuedepth, presentdroppedframes);
+        }
+
+        // show how long it took to convert each frame, in milliseconds
+        M_snprintf(buffer, sizeof(buffer), "%i FPS (%s%i.%02ims)", fps, details, converttime / 1000,
+            converttime / 10 % 100);
 
         C_DrawOverlayText(CONSOLEWIDTH - C_TextWidth(buffer, false) - CONSOLETEXTX + 1, CONSOLETEXTY,
             buffer, (fps < (refreshrate && vid_capfps != TICRATE ? refreshrate : TICRATE) ?
@@ -870,6 +892,28 @@ void C_UpdateFPS(void)
     }
 }
 
+void C_UpdatePlaneStats(void)
+{
+    if (!wipe && !menuactive && !consoleheight)
+    {
+        char    buffer[64];
+        int     y = CONSOLETEXTY;
+
+        M_snprintf(buffer, sizeof(buffer), "%i visplanes (peak %i)", visplanestats.visplanes,
+            visplanestats.peakvisplanes);
+        C_DrawOverlayText(CONSOLETEXTX, y, buffer, consolehighfpscolor);
+        y += CONSOLELINEHEIGHT;
+
+        M_snprintf(buffer, sizeof(buffer), "%i hash chains (longest %i)", visplanestats.buckets,
+            visplanestats.longestchain);
+        C_DrawOverlayText(CONSOLETEXTX, y, buffer, consolehighfpscolor);
+        y += CONSOLELINEHEIGHT;
+
+        M_snprintf(buffer, sizeof(buffer), "%i splits", visplanestats.splits);
+        C_DrawOverlayText(CONSOLETEXTX, y, buffer, consolehighfpscolor);
+    }
+}
+
 void C_Drawer(void)
 {
     if (consoleheight)
@@ -123,5 +123,6 @@ void C_PrintCompileDate(void);
 void C_PrintSDLVersions(void);
 void C_StripQuotes(char *string);
 void C_UpdateFPS(void);
+void C_UpdatePlaneStats(void);
 
 #endif
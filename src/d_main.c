@@ -198,6 +198,7 @@ gamestate_t             wipegamestate = GS_TITLESCREEN;
 extern dboolean         setsizeneeded;
 extern dboolean         message_on;
 extern int              r_detail;
+extern int              r_threads;
 extern gameaction_t     loadaction;
 
 void R_ExecuteSetViewSize(void);
@@ -263,9 +264,12 @@ void D_Display(void)
     }
     else
     {
+        // the view, status bar and automap are drawn straight to screens[0]
+        V_MarkScreenDirty();
+
         HU_Erase();
 
-        ST_Drawer((viewheight == SCREENHEIGHT), true);
+        ST_Drawer((scaledviewheight == SCREENHEIGHT), true);
 
         // draw the view directly
         R_RenderPlayerView(&players[0]);
@@ -289,8 +293,8 @@ void D_Display(void)
         {
             if (scaledviewwidth != SCREENWIDTH)
             {
-                if (menuactive || menuactivestate || !viewactivestate || vid_showfps || paused
-                    || pausedstate || message_on || consoleheight > CONSOLETOP)
+                if (menuactive || menuactivestate || !viewactivestate || vid_showfps || r_planestats
+                    || paused || pausedstate || message_on || consoleheight > CONSOLETOP)
                     borderdrawcount = 3;
                 if (borderdrawcount)
                 {
@@ -303,6 +307,9 @@ void D_Display(void)
         }
 
         HU_Drawer();
+
+        if (r_planestats)
+            C_UpdatePlaneStats();
     }
 
     menuactivestate = menuactive;
@@ -319,7 +326,7 @@ void D_Display(void)
 
             if (vid_widescreen)
                 V_DrawPatchWithShadow((ORIGINALWIDTH - SHORT(patch->width)) / 2,
-                    viewwindowy / 2 + (viewheight / 2 - SHORT(patch->height)) / 2, patch, false);
+                    viewwindowy / 2 + (scaledviewheight / 2 - SHORT(patch->height)) / 2, patch, false);
             else
                 V_DrawPatchWithShadow((ORIGINALWIDTH - SHORT(patch->width)) / 2,
                     (ORIGINALHEIGHT - SHORT(patch->height)) / 2, patch, false);
@@ -327,7 +334,7 @@ void D_Display(void)
         else
         {
             if (vid_widescreen)
-                M_DrawCenteredString(viewwindowy / 2 + (viewheight / 2 - 16) / 2, s_M_PAUSED);
+                M_DrawCenteredString(viewwindowy / 2 + (scaledviewheight / 2 - 16) / 2, s_M_PAUSED);
             else
                 M_DrawCenteredString((ORIGINALHEIGHT - 16) / 2, s_M_PAUSED);
         }
@@ -394,6 +401,8 @@ void D_DoomLoop(void)
 
     while (1)
     {
+        I_PaceFrame();
+
         TryRunTics(); // will run at least one tic
 
         if (players[0].mo)
@@ -1719,6 +1728,13 @@ static void D_DoomMainSetup(void)
     else
         G_SetMovementSpeed(turbo);
 
+    if ((p = M_CheckParmWithArgs("-threads", 1, 1)))
+    {
+        r_threads = BETWEEN(r_threads_min, atoi(myargv[p + 1]), r_threads_max);
+        C_Output("A <b>-threads</b> parameter was found on the command-line. The 3D view will be "
+            "rendered using %i thread%s.", r_threads, (r_threads == 1 ? "" : "s"));
+    }
+
     // init subsystems
     V_Init();
     I_InitTimer();
@@ -118,11 +118,19 @@ typedef enum
 
 #define ORIGINALSBARHEIGHT      32
 
-#define SCREENSCALE             2
+// The screen scale can be changed at runtime using the vid_renderscale CVAR. Arrays
+//  that are sized at compile-time use MAXSCREENWIDTH and MAXSCREENHEIGHT instead.
+extern int                      screenscale;
+
+#define SCREENSCALE             screenscale
+#define MAXSCREENSCALE          4
 
 #define SCREENWIDTH             (ORIGINALWIDTH * SCREENSCALE)
 #define SCREENHEIGHT            (ORIGINALHEIGHT * SCREENSCALE)
 
+#define MAXSCREENWIDTH          (ORIGINALWIDTH * MAXSCREENSCALE)
+#define MAXSCREENHEIGHT         (ORIGINALHEIGHT * MAXSCREENSCALE)
+
 #define SBARHEIGHT              (ORIGINALSBARHEIGHT * SCREENSCALE)
 
 #define MAXPLAYERS              1
@@ -62,4 +62,19 @@ typedef uint8_t byte;
 
 #define arrlen(array) (sizeof(array) / sizeof(*array))
 
+// Hint that the memory at p will soon be read
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#define PREFETCH(p)     _mm_prefetch((const char *)(p), _MM_HINT_T0)
+#else
+#define PREFETCH(p)     __builtin_prefetch(p)
+#endif
+
+// Storage class for variables that need a separate copy in each rendering thread
+#if defined(_MSC_VER)
+#define THREADLOCAL     __declspec(thread)
+#else
+#define THREADLOCAL     __thread
+#endif
+
 #endif
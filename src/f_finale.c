@@ -315,6 +315,7 @@ static void F_TextWrite(void)
     // erase the entire screen to a tiled background
     src = (byte *)W_CacheLumpName((char *)finaleflat, PU_CACHE);
     dest = screens[0];
+    V_MarkScreenDirty();
 
     for (y = 0; y < SCREENHEIGHT; y += 2)
         for (x = 0; x < SCREENWIDTH / 32; x += 2)
@@ -841,6 +842,8 @@ static void F_BunnyScroll(void)
 
     scrolled = BETWEEN(0, ORIGINALWIDTH - ((signed int)finalecount - 230) / 2, ORIGINALWIDTH);
 
+    V_MarkScreenDirty();
+
     for (x = 0; x < ORIGINALWIDTH; x++)
     {
         do
@@ -175,6 +175,8 @@ dboolean wipe_ScreenWipe(int tics)
     }
 
     // do a piece of wipe-in
+    V_MarkScreenDirty();
+
     if (wipe_doMelt(tics))
     {
         // final stuff
@@ -208,7 +208,7 @@ void HU_Init(void)
         hu_font[i] = W_CacheLumpName(buffer, PU_STATIC);
     }
 
-    tempscreen = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
+    tempscreen = Z_Malloc(MAXSCREENWIDTH * MAXSCREENHEIGHT, PU_STATIC, NULL);
 
     if ((lump = W_CheckNumForName("MEDIA0")) >= 0)
         healthpatch = W_CacheLumpNum(lump, PU_CACHE);
@@ -36,16 +36,57 @@
 ========================================================================
 */
 
+#include <string.h>
+
 #include "doomdef.h"
+#include "i_timer.h"
 #include "SDL.h"
 
+// Once the next frame is this close (in us), stop sleeping and spin instead,
+//  since SDL_Delay() can oversleep by a millisecond or more.
+#define SPINTIME    2000
+
+const int           frametimebuckets[NUMFRAMETIMEBUCKETS - 1] =
+{
+    2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 25, 29, 35, 50, 100
+};
+
+frametimestats_t    frametimestats;
+
+static Uint64       basecounter;
+static Uint64       counterfrequency;
+
+static uint64_t     frameperiod;
+static uint64_t     nextframe;
+static uint64_t     lastframe;
+
+//
+// I_GetTimeUS
+// returns time in microseconds since it was first called
+//
+uint64_t I_GetTimeUS(void)
+{
+    Uint64  counter;
+
+    if (!counterfrequency)
+    {
+        basecounter = SDL_GetPerformanceCounter();
+        counterfrequency = SDL_GetPerformanceFrequency();
+    }
+
+    counter = SDL_GetPerformanceCounter() - basecounter;
+
+    // split the division so the multiplication can't overflow
+    return (counter / counterfrequency * 1000000 + counter % counterfrequency * 1000000 / counterfrequency);
+}
+
 //
 // I_GetTime
 // returns time in 1/35th second tics
 //
 int I_GetTime(void)
 {
-    return SDL_GetTicks() * TICRATE / 1000;
+    return (int)(I_GetTimeUS() * TICRATE / 1000000);
 }
 
 //
@@ -53,7 +94,72 @@ int I_GetTime(void)
 //
 int I_GetTimeMS(void)
 {
-    return SDL_GetTicks();
+    return (int)(I_GetTimeUS() / 1000);
+}
+
+void I_SetFrameRate(int rate)
+{
+    frameperiod = (rate > 0 ? 1000000 / rate : 0);
+    nextframe = 0;
+}
+
+//
+// I_PaceFrame
+// Called at the start of every frame. If the framerate is capped, sleep until the
+//  next frame is almost due, then spin until it is.
+//
+void I_PaceFrame(void)
+{
+    uint64_t    now = I_GetTimeUS();
+
+    if (frameperiod)
+    {
+        if (now < nextframe)
+        {
+            while (nextframe - now > SPINTIME)
+            {
+                I_Sleep(1);
+
+                if ((now = I_GetTimeUS()) >= nextframe)
+                    break;
+            }
+
+            while (now < nextframe)
+                now = I_GetTimeUS();
+
+            nextframe += frameperiod;
+        }
+        else
+            // if more than a frame behind, don't try to catch up
+            nextframe = (now - nextframe > frameperiod ? now + frameperiod : nextframe + frameperiod);
+    }
+
+    if (lastframe)
+    {
+        uint64_t    elapsed = now - lastframe;
+        int         ms = (int)(elapsed / 1000);
+        int         i = 0;
+
+        while (i < NUMFRAMETIMEBUCKETS - 1 && ms >= frametimebuckets[i])
+            i++;
+
+        frametimestats.buckets[i]++;
+
+        if (!frametimestats.frames++ || elapsed < frametimestats.shortest)
+            frametimestats.shortest = elapsed;
+
+        if (elapsed > frametimestats.longest)
+            frametimestats.longest = elapsed;
+
+        frametimestats.total += elapsed;
+    }
+
+    lastframe = now;
+}
+
+void I_ResetFrameTimes(void)
+{
+    memset(&frametimestats, 0, sizeof(frametimestats));
 }
 
 //
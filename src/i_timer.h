@@ -39,6 +39,24 @@
 #if !defined(__I_TIMER_H__)
 #define __I_TIMER_H__
 
+#include <stdint.h>
+
+#define NUMFRAMETIMEBUCKETS 16
+
+typedef struct
+{
+    int         frames;                         // frames timed since the last reset
+    uint64_t    total;                          // total time between those frames, in us
+    uint64_t    shortest;
+    uint64_t    longest;
+    int         buckets[NUMFRAMETIMEBUCKETS];   // frames in each range of frametimebuckets
+} frametimestats_t;
+
+// Upper bound (in ms) of every bucket of the frame time histogram but the last
+extern const int        frametimebuckets[NUMFRAMETIMEBUCKETS - 1];
+
+extern frametimestats_t frametimestats;
+
 // Called by D_DoomLoop,
 // returns current time in tics.
 int I_GetTime(void);
@@ -46,6 +64,17 @@ int I_GetTime(void);
 // returns current time in ms
 int I_GetTimeMS(void);
 
+// returns current time in us, from the high-resolution performance counter
+uint64_t I_GetTimeUS(void);
+
+// Set the framerate I_PaceFrame paces to, or 0 for no limit
+void I_SetFrameRate(int rate);
+
+// Wait until the next frame is due, and time it
+void I_PaceFrame(void);
+
+void I_ResetFrameTimes(void);
+
 // Pause for a specified number of ms
 void I_Sleep(int ms);
 
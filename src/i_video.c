@@ -37,8 +37,9 @@
 */
 
 #if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
 #include <Windows.h>
-#include <mmsystem.h>
 
 #include "SDL_syswm.h"
 #elif defined(X11)
@@ -46,6 +47,23 @@
 #include <X11/XKBlib.h>
 #endif
 
+// SSE2 and AVX2 versions of the screen conversion are available on x86 and x64.
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SIMDCONVERT
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2     __attribute__((target("sse2")))
+#define TARGET_AVX2     __attribute__((target("avx2")))
+#endif
+#endif
+
+#include "am_map.h"
+#include "c_cmds.h"
 #include "c_console.h"
 #include "d_main.h"
 #include "doomstat.h"
@@ -53,7 +71,9 @@
 #include "i_colors.h"
 #include "i_gamepad.h"
 #include "i_system.h"
+#include "i_timer.h"
 #include "m_config.h"
+#include "m_argv.h"
 #include "m_menu.h"
 #include "m_misc.h"
 #include "m_random.h"
@@ -68,6 +88,10 @@
 #define MAXUPSCALEWIDTH         (1600 / ORIGINALWIDTH)
 #define MAXUPSCALEHEIGHT        (1200 / ORIGINALHEIGHT)
 
+#define BLIT_SHOWFPS            1
+#define BLIT_SHAKE              2
+#define BLIT_NEARESTLINEAR      4
+
 #define I_SDLError(func)        I_Error("The call to "func"() failed in %s on line %i of %s " \
                                     "with the error:\n\"%s\".", __FUNCTION__, (__LINE__ - 1), \
                                     leafname(__FILE__), SDL_GetError())
@@ -86,6 +110,8 @@ char                    *vid_driver = vid_driver_default;
 dboolean                vid_fullscreen = vid_fullscreen_default;
 int                     vid_motionblur = vid_motionblur_default;
 dboolean                vid_pillarboxes = vid_pillarboxes_default;
+dboolean                vid_presentthread = vid_presentthread_default;
+int                     vid_renderscale = vid_renderscale_default;
 char                    *vid_scaleapi = vid_scaleapi_default;
 char                    *vid_scalefilter = vid_scalefilter_default;
 char                    *vid_screenresolution = vid_screenresolution_default;
@@ -106,6 +132,12 @@ static SDL_Surface      *surface;
 static SDL_Surface      *buffer;
 static SDL_Palette      *palette;
 static SDL_Color        colors[256];
+static uint32_t         palettelookup[256];
+
+// a copy of the rows of screens[0] as they were last converted into texture
+static byte             *lastscreen;
+static dboolean         refreshtexture = true;
+static dboolean         motionblur;
 static byte             *playpal;
 
 byte                    *mapscreen;
@@ -113,8 +145,8 @@ SDL_Window              *mapwindow = NULL;
 static SDL_Renderer     *maprenderer;
 static SDL_Texture      *maptexture;
 static SDL_Surface      *mapsurface;
-static SDL_Surface      *mapbuffer;
 static SDL_Palette      *mappalette;
+static uint32_t         mappalettelookup[256];
 
 dboolean                nearestlinear = false;
 int                     upscaledwidth;
@@ -122,6 +154,12 @@ int                     upscaledheight;
 
 dboolean                software;
 
+// when headless, there's no window or renderer, and each frame can be dumped to a file
+dboolean                headless = false;
+static FILE             *dumpfile;
+static int              headlessframes;
+static Uint64           headlessstart;
+
 static int              displayindex;
 static int              am_displayindex;
 static int              numdisplays;
@@ -183,17 +221,49 @@ static SDL_Rect         map_rect = { 0, 0, 0, 0 };
 
 void                    (*blitfunc)(void);
 void                    (*mapblitfunc)(void);
+static int              blitflags;
+
+// the frames handed over to the present thread
+#define NUMPRESENTFRAMES        3
+
+typedef struct
+{
+    byte                *screen;
+    SDL_Rect            rect;
+    int                 pitch;
+    uint32_t            palettelookup[256];
+    SDL_Color           clearcolor;
+    int                 flags;
+    double              angle;
+} presentframe_t;
+
+SDL_Thread              *presentthread;
+static presentframe_t   presentframes[NUMPRESENTFRAMES];
+static SDL_mutex        *presentlock;
+static SDL_cond         *presentcond;
+static int              presenthead;
+static int              presentqueued;
+static dboolean         quitpresentthread;
+static dboolean         releasecontext;
+static int              peakpresentqueued;
+static int              droppedframes;
+
+// the most frames queued and the number of frames dropped in the last second
+int                     presentqueuedepth;
+int                     presentdroppedframes;
+
+// the time spent converting the screen, in microseconds per frame
+static Uint64           convertcounter;
+static int              convertedframes;
+int                     converttime;
+
+static void I_StopPresentThread(void);
 
 int                     fps = 0;
 int                     minfps = INT_MAX;
 int                     maxfps = 0;
 int                     refreshrate;
 
-#if defined(_WIN32)
-static UINT             CapFPSTimer;
-static HANDLE           CapFPSEvent;
-#endif
-
 // Mouse acceleration
 //
 // This emulates some of the behavior of DOS mouse drivers by increasing
@@ -217,6 +287,9 @@ extern int              windowborderwidth;
 extern int              windowborderheight;
 
 void ST_doRefresh(void);
+void R_ExecuteSetViewSize(void);
+
+extern dboolean         setsizeneeded;
 
 dboolean MouseShouldBeGrabbed(void)
 {
@@ -328,43 +401,14 @@ dboolean keystate(int key)
 
 void I_CapFPS(int fps)
 {
-#if defined(_WIN32)
-    if (CapFPSTimer)
-    {
-        timeKillEvent(CapFPSTimer);
-        CapFPSTimer = 0;
-    }
-
-    if (!fps || fps == TICRATE)
-    {
-        if (CapFPSEvent)
-        {
-            CloseHandle(CapFPSEvent);
-            CapFPSEvent = NULL;
-        }
-    }
-    else
-    {
-        if (!CapFPSEvent)
-            CapFPSEvent = CreateEvent(NULL, FALSE, TRUE, NULL);
-
-        if (CapFPSEvent)
-        {
-            CapFPSTimer = timeSetEvent(1000 / fps, 0, (LPTIMECALLBACK)CapFPSEvent, 0,
-                (TIME_PERIODIC | TIME_CALLBACK_EVENT_SET));
-
-            if (!CapFPSTimer)
-            {
-                CloseHandle(CapFPSEvent);
-                CapFPSEvent = NULL;
-            }
-        }
-    }
-#endif
+    // at TICRATE, TryRunTics() already waits for each tic
+    I_SetFrameRate(fps == TICRATE ? 0 : fps);
 }
 
 static void FreeSurfaces(void)
 {
+    I_StopPresentThread();
+
     SDL_FreePalette(palette);
     SDL_FreeSurface(surface);
     SDL_FreeSurface(buffer);
@@ -380,6 +424,20 @@ static void FreeSurfaces(void)
 
 void I_ShutdownGraphics(void)
 {
+    if (headless)
+    {
+        const double    seconds = (double)(SDL_GetPerformanceCounter() - headlessstart)
+                            / SDL_GetPerformanceFrequency();
+
+        fprintf(stderr, "%i frames in %.2f seconds (%.1f FPS)\n", headlessframes, seconds,
+            (seconds > 0.0 ? headlessframes / seconds : 0.0));
+
+        if (dumpfile && dumpfile != stdout)
+            fclose(dumpfile);
+
+        dumpfile = NULL;
+    }
+
     SetShowCursor(true);
     I_CapFPS(0);
     FreeSurfaces();
@@ -695,6 +753,125 @@ static void I_ReadMouse(void)
         CenterMouse();
 }
 
+//
+// Scripted input
+// The file given with -script has a line for each command, in the form
+//  "<tic> <command>". Once gametic reaches <tic>, the command is either entered
+//  in the console, or if it's an action such as +forward, the key bound to it is
+//  pressed, and then released again by -forward. Lines starting with ; are ignored.
+//
+typedef struct
+{
+    int         tic;
+    char        command[128];
+} scriptline_t;
+
+static scriptline_t     *scriptlines;
+static int              numscriptlines;
+static int              currentscriptline;
+
+static void I_InitScript(void)
+{
+    int     p = M_CheckParmWithArgs("-script", 1, 1);
+    FILE    *file;
+    int     maxscriptlines = 0;
+    char    strparm[256];
+
+    if (!p)
+        return;
+
+    if (!(file = fopen(myargv[p + 1], "r")))
+    {
+        C_Warning("<b>%s</b> couldn't be opened.", myargv[p + 1]);
+        return;
+    }
+
+    while (fgets(strparm, sizeof(strparm), file))
+    {
+        int     tic;
+        char    command[128] = "";
+        size_t  length = strcspn(strparm, "\r\n");
+
+        // skip the whole of a line that's too long, rather than running the rest of it
+        //  as another command
+        if (!strparm[length])
+        {
+            int c = fgetc(file);
+
+            if (c != '\n' && c != '\r' && c != EOF)
+            {
+                do
+                    c = fgetc(file);
+                while (c != '\n' && c != EOF);
+
+                C_Warning("A line in <b>%s</b> was too long and has been skipped.", myargv[p + 1]);
+                continue;
+            }
+        }
+
+        strparm[length] = '\0';
+
+        if (!*strparm || strparm[0] == ';' || sscanf(strparm, "%10i %127[^\n]", &tic, command) != 2)
+            continue;
+
+        if (numscriptlines == maxscriptlines)
+        {
+            maxscriptlines = (maxscriptlines ? maxscriptlines * 2 : 64);
+            scriptlines = Z_Realloc(scriptlines, maxscriptlines * sizeof(*scriptlines));
+        }
+
+        scriptlines[numscriptlines].tic = tic;
+        M_StringCopy(scriptlines[numscriptlines++].command, command, 128);
+    }
+
+    fclose(file);
+    C_Output("%i commands were read from <b>%s</b>.", numscriptlines, myargv[p + 1]);
+}
+
+static dboolean I_ScriptAction(char *command)
+{
+    int i = 0;
+
+    if (*command != '+' && *command != '-')
+        return false;
+
+    while (*actions[i].action)
+    {
+        if (M_StringCompare(command + 1, actions[i].action + 1))
+        {
+            event_t ev;
+
+            if (!actions[i].keyboard1 || !*(int *)actions[i].keyboard1)
+            {
+                C_Warning("No key is bound to the <b>%s</b> action.", actions[i].action);
+                return true;
+            }
+
+            ev.type = (*command == '+' ? ev_keydown : ev_keyup);
+            ev.data1 = *(int *)actions[i].keyboard1;
+            ev.data2 = 0;
+            ev.data3 = 0;
+            D_PostEvent(&ev);
+            return true;
+        }
+
+        i++;
+    }
+
+    return false;
+}
+
+static void I_ReadScript(void)
+{
+    while (currentscriptline < numscriptlines && scriptlines[currentscriptline].tic <= gametic)
+    {
+        char    *command = scriptlines[currentscriptline++].command;
+
+        if (!I_ScriptAction(command) && !C_ValidateInput(command))
+            C_Warning("<b>%s</b> isn't a valid command in the script.", command);
+    }
+}
+
 //
 // I_StartTic
 //
@@ -702,6 +879,9 @@ void I_StartTic(void)
 {
     I_GetEvent();
 
+    if (numscriptlines)
+        I_ReadScript();
+
     if (m_sensitivity)
         I_ReadMouse();
 
@@ -760,6 +940,23 @@ static void CalculateFPS(void)
             maxfps = MAX(maxfps, fps);
         }
 
+        presentqueuedepth = peakpresentqueued;
+        presentdroppedframes = droppedframes;
+        peakpresentqueued = 0;
+        droppedframes = 0;
+
+        // the present thread converts the frames it presents
+        if (presentthread)
+            SDL_LockMutex(presentlock);
+
+        converttime = (convertedframes ? (int)(convertcounter * 1000000
+            / (SDL_GetPerformanceFrequency() * convertedframes)) : 0);
+        convertcounter = 0;
+        convertedframes = 0;
+
+        if (presentthread)
+            SDL_UnlockMutex(presentlock);
+
         frames = 0;
         starttime = currenttime;
     }
@@ -767,180 +964,518 @@ static void CalculateFPS(void)
     C_UpdateFPS();
 }
 
-static void I_Blit(void)
+//
+// I_ConvertRow
+// Convert a row of an 8-bit screen into ARGB8888 using lookup. SSE2 and AVX2
+//  versions are used instead on x86 and x64 if they produce exactly the same
+//  output, which is verified by I_TestConvertRow() before they are used.
+//
+static void I_ConvertRow(uint32_t *dest, const byte *src, int width, const uint32_t *lookup)
 {
-    UpdateGrab();
+    int x;
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
-    SDL_RenderClear(renderer);
-    SDL_RenderCopy(renderer, texture, &src_rect, NULL);
+    for (x = 0; x < width; x++)
+        dest[x] = lookup[src[x]];
+}
 
-#if defined(_WIN32)
-    if (CapFPSEvent)
-        WaitForSingleObject(CapFPSEvent, 1000);
-#endif
+static void (*convertrowfunc)(uint32_t *, const byte *, int, const uint32_t *) = I_ConvertRow;
 
-    SDL_RenderPresent(renderer);
+#if defined(SIMDCONVERT)
+// SSE2 has no gather, so look up 4 pixels at a time and write them with one store
+TARGET_SSE2 static void I_ConvertRowSSE2(uint32_t *dest, const byte *src, int width,
+    const uint32_t *lookup)
+{
+    int x;
+
+    for (x = 0; x + 4 <= width; x += 4)
+        _mm_storeu_si128((__m128i *)(dest + x), _mm_setr_epi32(lookup[src[x]], lookup[src[x + 1]],
+            lookup[src[x + 2]], lookup[src[x + 3]]));
+
+    for (; x < width; x++)
+        dest[x] = lookup[src[x]];
 }
 
-static void I_Blit_NearestLinear(void)
+// AVX2 widens 8 pixels to dwords and gathers their colors from lookup at once
+TARGET_AVX2 static void I_ConvertRowAVX2(uint32_t *dest, const byte *src, int width,
+    const uint32_t *lookup)
 {
-    UpdateGrab();
+    int x;
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
-    SDL_RenderClear(renderer);
-    SDL_SetRenderTarget(renderer, texture_upscaled);
-    SDL_RenderCopy(renderer, texture, &src_rect, NULL);
-    SDL_SetRenderTarget(renderer, NULL);
-    SDL_RenderCopy(renderer, texture_upscaled, NULL, NULL);
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        const __m256i   index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src + x)));
 
-#if defined(_WIN32)
-    if (CapFPSEvent)
-        WaitForSingleObject(CapFPSEvent, 1000);
-#endif
+        _mm256_storeu_si256((__m256i *)(dest + x), _mm256_i32gather_epi32((const int *)lookup, index, 4));
+    }
 
-    SDL_RenderPresent(renderer);
+    for (; x < width; x++)
+        dest[x] = lookup[src[x]];
 }
 
-static void I_Blit_ShowFPS(void)
+static dboolean I_TestConvertRow(void (*convertrow)(uint32_t *, const byte *, int, const uint32_t *))
 {
-    UpdateGrab();
+    static uint32_t lookup[256];
+    static byte     src[MAXSCREENWIDTH];
+    static uint32_t dest[2][MAXSCREENWIDTH];
+    int             i;
 
-    CalculateFPS();
+    for (i = 0; i < 256; i++)
+        lookup[i] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
-    SDL_RenderClear(renderer);
-    SDL_RenderCopy(renderer, texture, &src_rect, NULL);
+    for (i = 0; i < MAXSCREENWIDTH; i++)
+        src[i] = rand() & 255;
 
-#if defined(_WIN32)
-    if (CapFPSEvent)
-        WaitForSingleObject(CapFPSEvent, 1000);
-#endif
+    for (i = 1; i <= MAXSCREENWIDTH; i++)
+    {
+        memset(dest, 0, sizeof(dest));
+        I_ConvertRow(dest[0], src + MAXSCREENWIDTH - i, i, lookup);
+        convertrow(dest[1], src + MAXSCREENWIDTH - i, i, lookup);
 
-    SDL_RenderPresent(renderer);
+        if (memcmp(dest[0], dest[1], sizeof(dest[0])))
+            return false;
+    }
+
+    return true;
 }
+#endif
 
-static void I_Blit_NearestLinear_ShowFPS(void)
+//
+// I_InitConvertScreen
+// Choose the fastest way to convert the screen that this CPU supports.
+//
+static void I_InitConvertScreen(void)
 {
-    UpdateGrab();
+#if defined(SIMDCONVERT)
+    static dboolean tested;
 
-    CalculateFPS();
+    if (tested)
+        return;
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
-    SDL_RenderClear(renderer);
-    SDL_SetRenderTarget(renderer, texture_upscaled);
-    SDL_RenderCopy(renderer, texture, &src_rect, NULL);
-    SDL_SetRenderTarget(renderer, NULL);
-    SDL_RenderCopy(renderer, texture_upscaled, NULL, NULL);
+    tested = true;
 
-#if defined(_WIN32)
-    if (CapFPSEvent)
-        WaitForSingleObject(CapFPSEvent, 1000);
+    if (SDL_HasAVX2())
+    {
+        if (I_TestConvertRow(I_ConvertRowAVX2))
+        {
+            convertrowfunc = I_ConvertRowAVX2;
+            return;
+        }
+
+        C_Warning("The <b>AVX2</b> screen conversion failed its self-test and won't be used.");
+    }
+
+    if (SDL_HasSSE2())
+    {
+        if (I_TestConvertRow(I_ConvertRowSSE2))
+            convertrowfunc = I_ConvertRowSSE2;
+        else
+            C_Warning("The <b>SSE2</b> screen conversion failed its self-test and won't be used.");
+    }
 #endif
+}
 
-    SDL_RenderPresent(renderer);
+//
+// I_ConvertScreen
+// Convert an 8-bit screen straight into the locked memory of an ARGB8888 texture,
+//  using a lookup table that I_SetPalette() rebuilds whenever the palette changes.
+//  This replaces converting the screen into a 32-bit surface with SDL_LowerBlit()
+//  and then copying that surface into the texture with SDL_UpdateTexture().
+//  Returns how long the conversion took, in performance counter ticks.
+//
+static Uint64 I_ConvertScreen(SDL_Texture *dest, const SDL_Rect *rect, const byte *src,
+    int srcpitch, const uint32_t *lookup)
+{
+    const Uint64    start = SDL_GetPerformanceCounter();
+    void            *pixels;
+    int             pitch;
+    int             y;
+
+    if (SDL_LockTexture(dest, rect, &pixels, &pitch) < 0)
+        return 0;
+
+    for (y = 0; y < rect->h; y++, src += srcpitch)
+        convertrowfunc((uint32_t *)((byte *)pixels + y * pitch), src, rect->w, lookup);
+
+    SDL_UnlockTexture(dest);
+
+    return (SDL_GetPerformanceCounter() - start);
 }
 
-static void I_Blit_Shake(void)
+//
+// I_UpdateTexture
+// Only the rows of screens[0] that have been drawn to since the last blit, and that
+//  have then actually changed, are converted into texture. The whole screen is if
+//  the palette has changed, or if something else has updated texture in between.
+//
+static void I_UpdateTexture(void)
 {
-    UpdateGrab();
+    // motion blur blends each frame with the last one, so still needs SDL to do it
+    if (motionblur)
+    {
+        const Uint64    start = SDL_GetPerformanceCounter();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
-    SDL_RenderClear(renderer);
-    SDL_RenderCopyEx(renderer, texture, &src_rect, NULL,
-        M_RandomInt(-1000, 1000) / 1000.0 * r_shake_damage / 100.0, NULL, SDL_FLIP_NONE);
+        SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
+        SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
+        convertcounter += SDL_GetPerformanceCounter() - start;
+        refreshtexture = true;
+    }
+    else
+    {
+        int top = 0;
+        int bottom = src_rect.h;
 
-#if defined(_WIN32)
-    if (CapFPSEvent)
-        WaitForSingleObject(CapFPSEvent, 1000);
-#endif
+        if (!refreshtexture)
+        {
+            top = MAX(dirtytop, 0);
+            bottom = MIN(dirtybottom, src_rect.h);
 
-    SDL_RenderPresent(renderer);
+            while (top < bottom && !memcmp(screens[0] + top * SCREENWIDTH,
+                lastscreen + top * SCREENWIDTH, SCREENWIDTH))
+                top++;
+
+            while (bottom > top && !memcmp(screens[0] + (bottom - 1) * SCREENWIDTH,
+                lastscreen + (bottom - 1) * SCREENWIDTH, SCREENWIDTH))
+                bottom--;
+        }
+
+        if (top < bottom)
+        {
+            const SDL_Rect  rect = { 0, top, SCREENWIDTH, bottom - top };
+
+            convertcounter += I_ConvertScreen(texture, &rect, screens[0] + top * SCREENWIDTH,
+                SCREENWIDTH, palettelookup);
+            memcpy(lastscreen + top * SCREENWIDTH, screens[0] + top * SCREENWIDTH,
+                (bottom - top) * SCREENWIDTH);
+        }
+
+        refreshtexture = false;
+    }
+
+    V_ClearDirtyRows();
+    convertedframes++;
 }
 
-static void I_Blit_NearestLinear_Shake(void)
+static double I_ShakeAngle(void)
 {
-    UpdateGrab();
+    return (M_RandomInt(-1000, 1000) / 1000.0 * r_shake_damage / 100.0);
+}
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
+//
+// I_RenderScreen
+// Copy rect of the converted screen to the renderer and present it. The screen is
+//  rotated by angle if flags include BLIT_SHAKE, and is first scaled up to
+//  texture_upscaled if they include BLIT_NEARESTLINEAR.
+//
+static void I_RenderScreen(const SDL_Rect *rect, int flags, double angle)
+{
     SDL_RenderClear(renderer);
-    SDL_SetRenderTarget(renderer, texture_upscaled);
-    SDL_RenderCopyEx(renderer, texture, &src_rect, NULL,
-        M_RandomInt(-1000, 1000) / 1000.0 * r_shake_damage / 100.0, NULL, SDL_FLIP_NONE);
-    SDL_SetRenderTarget(renderer, NULL);
-    SDL_RenderCopy(renderer, texture_upscaled, NULL, NULL);
 
-#if defined(_WIN32)
-    if (CapFPSEvent)
-        WaitForSingleObject(CapFPSEvent, 1000);
-#endif
+    if (flags & BLIT_NEARESTLINEAR)
+        SDL_SetRenderTarget(renderer, texture_upscaled);
+
+    if (flags & BLIT_SHAKE)
+        SDL_RenderCopyEx(renderer, texture, rect, NULL, angle, NULL, SDL_FLIP_NONE);
+    else
+        SDL_RenderCopy(renderer, texture, rect, NULL);
+
+    if (flags & BLIT_NEARESTLINEAR)
+    {
+        SDL_SetRenderTarget(renderer, NULL);
+        SDL_RenderCopy(renderer, texture_upscaled, NULL, NULL);
+    }
 
     SDL_RenderPresent(renderer);
 }
 
-static void I_Blit_ShowFPS_Shake(void)
+//
+// I_Blit
+// Blit screens[0] to the window, running only the stages that I_UpdateBlitFunc()
+//  set in blitflags.
+//
+static void I_Blit(void)
 {
     UpdateGrab();
 
-    CalculateFPS();
+    if (blitflags & BLIT_SHOWFPS)
+        CalculateFPS();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
-    SDL_RenderClear(renderer);
-    SDL_RenderCopyEx(renderer, texture, &src_rect, NULL,
-        M_RandomInt(-1000, 1000) / 1000.0 * r_shake_damage / 100.0, NULL, SDL_FLIP_NONE);
+    I_UpdateTexture();
+    I_RenderScreen(&src_rect, blitflags, ((blitflags & BLIT_SHAKE) ? I_ShakeAngle() : 0.0));
+}
 
-#if defined(_WIN32)
-    if (CapFPSEvent)
-        WaitForSingleObject(CapFPSEvent, 1000);
-#endif
+//
+// I_PresentFrame
+// Convert and present a frame that was handed over to the present thread.
+//  Returns how long the conversion took, in performance counter ticks.
+//
+static Uint64 I_PresentFrame(presentframe_t *frame)
+{
+    const Uint64    counter = I_ConvertScreen(texture, &frame->rect, frame->screen, frame->pitch,
+        frame->palettelookup);
 
-    SDL_RenderPresent(renderer);
+    if (vid_pillarboxes)
+        SDL_SetRenderDrawColor(renderer, frame->clearcolor.r, frame->clearcolor.g,
+            frame->clearcolor.b, SDL_ALPHA_OPAQUE);
+
+    I_RenderScreen(&frame->rect, frame->flags, frame->angle);
+
+    return counter;
+}
+
+//
+// I_PresentThread
+// Owns the renderer while it runs, presenting each frame that is queued in
+//  turn, so the main thread can get on with the next one.
+//
+static int SDLCALL I_PresentThread(void *data)
+{
+    while (true)
+    {
+        presentframe_t  *frame;
+        Uint64          counter;
+
+        SDL_LockMutex(presentlock);
+
+        while (!presentqueued && !quitpresentthread && !releasecontext)
+            SDL_CondWait(presentcond, presentlock);
+
+        if (!presentqueued)
+        {
+            const dboolean  quit = quitpresentthread;
+
+            // hand the OpenGL context to the main thread, which is waiting to use the
+            //  renderer, and take it back when the next frame is presented
+            if (SDL_GL_GetCurrentContext())
+                SDL_GL_MakeCurrent(window, NULL);
+
+            releasecontext = false;
+            SDL_CondBroadcast(presentcond);
+            SDL_UnlockMutex(presentlock);
+
+            if (quit)
+                break;
+
+            continue;
+        }
+
+        frame = presentframes + presenthead;
+        SDL_UnlockMutex(presentlock);
+
+        counter = I_PresentFrame(frame);
+
+        SDL_LockMutex(presentlock);
+        convertcounter += counter;
+        convertedframes++;
+        presenthead = (presenthead + 1) % NUMPRESENTFRAMES;
+        presentqueued--;
+        SDL_CondBroadcast(presentcond);
+        SDL_UnlockMutex(presentlock);
+    }
+
+    return 0;
 }
 
-static void I_Blit_NearestLinear_ShowFPS_Shake(void)
+static void I_CopyPresentFrame(presentframe_t *frame)
 {
+    memcpy(frame->screen, screens[0], SCREENWIDTH * src_rect.h);
+    frame->rect = src_rect;
+    frame->pitch = SCREENWIDTH;
+    memcpy(frame->palettelookup, palettelookup, sizeof(palettelookup));
+    frame->clearcolor = colors[0];
+    frame->flags = blitflags;
+    frame->angle = ((blitflags & BLIT_SHAKE) ? I_ShakeAngle() : 0.0);
+}
+
+//
+// I_Blit_Async
+// Queue the frame for the present thread. If the queue is already full, the
+//  newest frame in it is replaced, and counted as dropped.
+//
+static void I_Blit_Async(void)
+{
+    presentframe_t  *frame;
+
+    // motion blur blends each frame with the last one, so is still done here
+    if (motionblur)
+    {
+        I_WaitForPresentThread();
+        I_Blit();
+        return;
+    }
+
+    // an OpenGL context can only be current on one thread at a time, so give it
+    //  back to the present thread if the renderer was used since the last frame
+    if (SDL_GL_GetCurrentContext())
+        SDL_GL_MakeCurrent(window, NULL);
+
     UpdateGrab();
 
-    CalculateFPS();
+    if (blitflags & BLIT_SHOWFPS)
+        CalculateFPS();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
-    SDL_RenderClear(renderer);
-    SDL_SetRenderTarget(renderer, texture_upscaled);
-    SDL_RenderCopyEx(renderer, texture, &src_rect, NULL,
-        M_RandomInt(-1000, 1000) / 1000.0 * r_shake_damage / 100.0, NULL, SDL_FLIP_NONE);
-    SDL_SetRenderTarget(renderer, NULL);
-    SDL_RenderCopy(renderer, texture_upscaled, NULL, NULL);
+    // the present thread converts the whole of each frame into texture
+    V_ClearDirtyRows();
+    refreshtexture = true;
 
-#if defined(_WIN32)
-    if (CapFPSEvent)
-        WaitForSingleObject(CapFPSEvent, 1000);
-#endif
+    SDL_LockMutex(presentlock);
 
-    SDL_RenderPresent(renderer);
+    if (presentqueued == NUMPRESENTFRAMES)
+    {
+        frame = presentframes + (presenthead + presentqueued - 1) % NUMPRESENTFRAMES;
+        I_CopyPresentFrame(frame);
+        droppedframes++;
+    }
+    else
+    {
+        frame = presentframes + (presenthead + presentqueued) % NUMPRESENTFRAMES;
+        SDL_UnlockMutex(presentlock);
+        I_CopyPresentFrame(frame);
+        SDL_LockMutex(presentlock);
+        presentqueued++;
+        SDL_CondBroadcast(presentcond);
+    }
+
+    peakpresentqueued = MAX(peakpresentqueued, presentqueued);
+    SDL_UnlockMutex(presentlock);
+}
+
+//
+// I_WaitForPresentThread
+// Wait for every frame that has been queued to be presented, and for the present
+//  thread to release the OpenGL context, before the main thread uses the renderer
+//  itself.
+//
+void I_WaitForPresentThread(void)
+{
+    if (presentthread)
+    {
+        SDL_LockMutex(presentlock);
+        releasecontext = true;
+        SDL_CondBroadcast(presentcond);
+
+        while (presentqueued || releasecontext)
+            SDL_CondWait(presentcond, presentlock);
+
+        SDL_UnlockMutex(presentlock);
+    }
+}
+
+//
+// I_StartPresentThread
+// The present thread is only used when fullscreen, as resizing the window makes
+//  SDL use the renderer from the main thread while events are handled.
+//
+static void I_StartPresentThread(void)
+{
+    int i;
+
+    if (!vid_presentthread || !vid_fullscreen || headless || presentthread)
+        return;
+
+    if (!presentlock)
+    {
+        presentlock = SDL_CreateMutex();
+        presentcond = SDL_CreateCond();
+    }
+
+    for (i = 0; i < NUMPRESENTFRAMES; i++)
+        presentframes[i].screen = Z_Malloc(MAXSCREENWIDTH * MAXSCREENHEIGHT, PU_STATIC, NULL);
+
+    presenthead = 0;
+    presentqueued = 0;
+    quitpresentthread = false;
+    releasecontext = false;
+
+    // an OpenGL context can only be current on one thread at a time
+    if (SDL_GL_GetCurrentContext())
+        SDL_GL_MakeCurrent(window, NULL);
+
+    if (!presentlock || !presentcond
+        || !(presentthread = SDL_CreateThread(I_PresentThread, "I_PresentThread", NULL)))
+    {
+        for (i = 0; i < NUMPRESENTFRAMES; i++)
+            Z_Free(presentframes[i].screen);
+
+        C_Warning("A thread to present each frame couldn't be created.");
+    }
+}
+
+static void I_StopPresentThread(void)
+{
+    int i;
+
+    if (!presentthread)
+        return;
+
+    SDL_LockMutex(presentlock);
+    quitpresentthread = true;
+    SDL_CondBroadcast(presentcond);
+    SDL_UnlockMutex(presentlock);
+
+    SDL_WaitThread(presentthread, NULL);
+    presentthread = NULL;
+
+    for (i = 0; i < NUMPRESENTFRAMES; i++)
+        Z_Free(presentframes[i].screen);
+
+    presentqueuedepth = 0;
+    presentdroppedframes = 0;
+    peakpresentqueued = 0;
+    droppedframes = 0;
+}
+
+void I_RestartPresentThread(void)
+{
+    I_StopPresentThread();
+    I_StartPresentThread();
+    I_UpdateBlitFunc(!!(blitflags & BLIT_SHAKE));
+}
+
+//
+// I_Blit_Headless
+// There's nothing to blit to when headless, so just count the frame, and write it
+//  to the file given with -dumpframes as raw 32-bit BGRA pixels.
+//
+static void I_Blit_Headless(void)
+{
+    static uint32_t row[MAXSCREENWIDTH];
+    int             y;
+
+    if (blitflags & BLIT_SHOWFPS)
+        CalculateFPS();
+
+    headlessframes++;
+
+    if (!dumpfile)
+        return;
+
+    for (y = 0; y < src_rect.h; y++)
+    {
+        convertrowfunc(row, screens[0] + y * SCREENWIDTH, SCREENWIDTH, palettelookup);
+
+        if (fwrite(row, sizeof(uint32_t), SCREENWIDTH, dumpfile) != (size_t)SCREENWIDTH)
+        {
+            C_Warning("Frames can no longer be dumped.");
+
+            if (dumpfile != stdout)
+                fclose(dumpfile);
+
+            dumpfile = NULL;
+            return;
+        }
+    }
 }
 
 void I_UpdateBlitFunc(dboolean shake)
 {
-    if (shake)
-        blitfunc = (vid_showfps ? (nearestlinear ? I_Blit_NearestLinear_ShowFPS_Shake :
-            I_Blit_ShowFPS_Shake) : (nearestlinear ? I_Blit_NearestLinear_Shake : I_Blit_Shake));
-    else
-        blitfunc = (vid_showfps ? (nearestlinear ? I_Blit_NearestLinear_ShowFPS : I_Blit_ShowFPS) :
-            (nearestlinear ? I_Blit_NearestLinear : I_Blit));
+    blitflags = (vid_showfps ? BLIT_SHOWFPS : 0) | (shake ? BLIT_SHAKE : 0)
+        | (nearestlinear ? BLIT_NEARESTLINEAR : 0);
+    blitfunc = (headless ? I_Blit_Headless : (presentthread ? I_Blit_Async : I_Blit));
 }
 
 void I_Blit_Automap(void)
 {
-    SDL_LowerBlit(mapsurface, &map_rect, mapbuffer, &map_rect);
-    SDL_UpdateTexture(maptexture, &map_rect, mapbuffer->pixels, SCREENWIDTH * 4);
+    I_ConvertScreen(maptexture, &map_rect, mapscreen, SCREENWIDTH, mappalettelookup);
     SDL_RenderClear(maprenderer);
     SDL_RenderCopy(maprenderer, maptexture, &map_rect, NULL);
     SDL_RenderPresent(maprenderer);
@@ -968,11 +1503,14 @@ void I_SetPalette(byte *playpal)
         colors[i].r = gammatable[gammaindex][*playpal++];
         colors[i].g = gammatable[gammaindex][*playpal++];
         colors[i].b = gammatable[gammaindex][*playpal++];
+        palettelookup[i] = (0xFF000000 | (colors[i].r << 16) | (colors[i].g << 8) | colors[i].b);
     }
 
     SDL_SetPaletteColors(palette, colors, 0, 256);
+    refreshtexture = true;
 
-    if (vid_pillarboxes)
+    // the present thread sets the color itself, with each frame
+    if (vid_pillarboxes && !presentthread)
         SDL_SetRenderDrawColor(renderer, palette[0].colors->r, palette[0].colors->g,
             palette[0].colors->b, SDL_ALPHA_OPAQUE);
 }
@@ -1004,13 +1542,10 @@ static void GetDisplays(void)
 
 void I_CreateExternalAutomap(dboolean output)
 {
-    Uint32      rmask, gmask, bmask, amask;
-    int         bpp;
-
     mapscreen = *screens;
     mapblitfunc = nullfunc;
 
-    if (!am_external)
+    if (!am_external || headless)
         return;
 
     GetDisplays();
@@ -1039,17 +1574,6 @@ void I_CreateExternalAutomap(dboolean output)
     if (!(mapsurface = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 8, 0, 0, 0, 0)))
         I_SDLError("SDL_CreateRGBSurface");
 
-    if (SDL_PixelFormatEnumToMasks(SDL_GetWindowPixelFormat(mapwindow), &bpp, &rmask, &gmask, &bmask, &amask))
-    {
-        if (!(mapbuffer = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 32, rmask, gmask, bmask, amask)))
-            I_SDLError("SDL_CreateRGBSurface");
-    }
-    else if (!(mapbuffer = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 32, 0, 0, 0, 0)))
-        I_SDLError("SDL_CreateRGBSurface");
-
-    if (SDL_FillRect(mapbuffer, NULL, 0) < 0)
-        I_SDLError("SDL_FillRect");
-
     if (!(maptexture = SDL_CreateTexture(maprenderer, SDL_PIXELFORMAT_ARGB8888,
         SDL_TEXTUREACCESS_STREAMING, SCREENWIDTH, SCREENHEIGHT)))
         I_SDLError("SDL_CreateTexture");
@@ -1063,6 +1587,8 @@ void I_CreateExternalAutomap(dboolean output)
     if (SDL_SetPaletteColors(mappalette, colors, 0, 256) < 0)
         I_SDLError("SDL_SetPaletteColors");
 
+    memcpy(mappalettelookup, palettelookup, sizeof(mappalettelookup));
+
     mapscreen = mapsurface->pixels;
     mapblitfunc = I_Blit_Automap;
 
@@ -1087,7 +1613,6 @@ void I_DestroyExternalAutomap(void)
 {
     SDL_FreePalette(mappalette);
     SDL_FreeSurface(mapsurface);
-    SDL_FreeSurface(mapbuffer);
     SDL_DestroyTexture(maptexture);
     SDL_DestroyRenderer(maprenderer);
     SDL_DestroyWindow(mapwindow);
@@ -1296,6 +1821,14 @@ void I_SetMotionBlur(int percent)
 {
     if (percent)
     {
+        // I_ConvertScreen() doesn't keep the last frame in buffer, so put it back before
+        //  blending the next one with it
+        if (!motionblur)
+        {
+            SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+            SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
+        }
+
         SDL_SetSurfaceAlphaMod(surface, SDL_ALPHA_OPAQUE - 128 * percent / 100);
         SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_BLEND);
     }
@@ -1304,18 +1837,66 @@ void I_SetMotionBlur(int percent)
         SDL_SetSurfaceAlphaMod(surface, SDL_ALPHA_OPAQUE);
         SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
     }
+
+    motionblur = !!percent;
+}
+
+//
+// CreateSurfaces
+// Create the 8-bit surface that screens[0] points to, and the 32-bit surface that
+//  each frame is blended with when motion blur is on.
+//
+static void CreateSurfaces(Uint32 pixelformat)
+{
+    Uint32  rmask, gmask, bmask, amask;
+    int     bpp;
+
+    if (!(surface = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 8, 0, 0, 0, 0)))
+        I_SDLError("SDL_CreateRGBSurface");
+
+    screens[0] = surface->pixels;
+
+    if (SDL_PixelFormatEnumToMasks(pixelformat, &bpp, &rmask, &gmask, &bmask, &amask))
+    {
+        if (!(buffer = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 32, rmask, gmask, bmask, amask)))
+            I_SDLError("SDL_CreateRGBSurface");
+    }
+    else if (!(buffer = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 32, 0, 0, 0, 0)))
+        I_SDLError("SDL_CreateRGBSurface");
+
+    if (SDL_FillRect(buffer, NULL, 0) < 0)
+        I_SDLError("SDL_FillRect");
+
+    if (!(palette = SDL_AllocPalette(256)))
+        I_SDLError("SDL_AllocPalette");
+
+    if (SDL_SetSurfacePalette(surface, palette) < 0)
+        I_SDLError("SDL_SetSurfacePalette");
+
+    src_rect.w = SCREENWIDTH;
+    src_rect.h = SCREENHEIGHT - SBARHEIGHT * vid_widescreen;
 }
 
 static void SetVideoMode(dboolean output)
 {
     int                 flags = SDL_RENDERER_TARGETTEXTURE;
     int                 width, height;
-    Uint32              rmask, gmask, bmask, amask;
-    int                 bpp;
     SDL_RendererInfo    rendererinfo;
     wad_file_t          *playpalwad = lumpinfo[W_CheckNumForName("PLAYPAL")]->wad_file;
     dboolean            iwad = (playpalwad->type == IWAD);
 
+    // there's only the screen itself when headless
+    if (headless)
+    {
+        CreateSurfaces(SDL_PIXELFORMAT_ARGB8888);
+        I_SetPalette(playpal + st_palette * 768);
+
+        if (output)
+            C_Output("Running headless, without a window.");
+
+        return;
+    }
+
     displayindex = vid_display - 1;
     if (displayindex < 0 || displayindex >= numdisplays)
     {
@@ -1632,21 +2213,7 @@ static void SetVideoMode(dboolean output)
         }
     }
 
-    if (!(surface = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 8, 0, 0, 0, 0)))
-        I_SDLError("SDL_CreateRGBSurface");
-
-    screens[0] = surface->pixels;
-
-    if (SDL_PixelFormatEnumToMasks(SDL_GetWindowPixelFormat(window), &bpp, &rmask, &gmask, &bmask, &amask))
-    {
-        if (!(buffer = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 32, rmask, gmask, bmask, amask)))
-            I_SDLError("SDL_CreateRGBSurface");
-    }
-    else if (!(buffer = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 32, 0, 0, 0, 0)))
-        I_SDLError("SDL_CreateRGBSurface");
-
-    if (SDL_FillRect(buffer, NULL, 0) < 0)
-        I_SDLError("SDL_FillRect");
+    CreateSurfaces(SDL_GetWindowPixelFormat(window));
 
     if (nearestlinear)
         SDL_SetHintWithPriority(SDL_HINT_RENDER_SCALE_QUALITY, vid_scalefilter_nearest,
@@ -1656,6 +2223,8 @@ static void SetVideoMode(dboolean output)
         SDL_TEXTUREACCESS_STREAMING, SCREENWIDTH, SCREENHEIGHT)))
         I_SDLError("SDL_CreateTexture");
 
+    refreshtexture = true;
+
     if (nearestlinear)
     {
         SDL_SetHintWithPriority(SDL_HINT_RENDER_SCALE_QUALITY, vid_scalefilter_linear, SDL_HINT_OVERRIDE);
@@ -1665,20 +2234,13 @@ static void SetVideoMode(dboolean output)
             I_SDLError("SDL_CreateTexture");
     }
 
-    if (!(palette = SDL_AllocPalette(256)))
-        I_SDLError("SDL_AllocPalette");
-
-    if (SDL_SetSurfacePalette(surface, palette) < 0)
-        I_SDLError("SDL_SetSurfacePalette");
-
     I_SetPalette(playpal + st_palette * 768);
-
-    src_rect.w = SCREENWIDTH;
-    src_rect.h = SCREENHEIGHT - SBARHEIGHT * vid_widescreen;
 }
 
 void I_ToggleWidescreen(dboolean toggle)
 {
+    I_WaitForPresentThread();
+
     if (toggle)
     {
         vid_widescreen = true;
@@ -1689,7 +2251,7 @@ void I_ToggleWidescreen(dboolean toggle)
             R_SetViewSize(r_screensize);
         }
 
-        if (SDL_RenderSetLogicalSize(renderer, SCREENWIDTH, SCREENHEIGHT) < 0)
+        if (!headless && SDL_RenderSetLogicalSize(renderer, SCREENWIDTH, SCREENHEIGHT) < 0)
             I_SDLError("SDL_RenderSetLogicalSize");
 
         src_rect.h = SCREENHEIGHT - SBARHEIGHT;
@@ -1701,13 +2263,14 @@ void I_ToggleWidescreen(dboolean toggle)
         if (gamestate == GS_LEVEL)
             ST_doRefresh();
 
-        if (SDL_RenderSetLogicalSize(renderer, SCREENWIDTH, SCREENWIDTH * 3 / 4) < 0)
+        if (!headless && SDL_RenderSetLogicalSize(renderer, SCREENWIDTH, SCREENWIDTH * 3 / 4) < 0)
             I_SDLError("SDL_RenderSetLogicalSize");
 
         src_rect.h = SCREENHEIGHT;
     }
 
     returntowidescreen = false;
+    refreshtexture = true;
 
     if (SDL_SetPaletteColors(palette, colors, 0, 256) < 0)
         I_SDLError("SDL_SetPaletteColors");
@@ -1728,21 +2291,57 @@ void I_RestartGraphics(void)
     I_CreateExternalAutomap(false);
 
 #if defined(_WIN32)
-    I_InitWindows32();
+    if (!headless)
+        I_InitWindows32();
 #endif
 
+    I_RestartPresentThread();
+
     M_SetWindowCaption();
 
     forceconsoleblurredraw = true;
 }
 
+//
+// I_SetRenderScale
+// Change the internal render resolution to vid_renderscale times 320x200, and
+//  recalculate everything that depends on it.
+//
+void I_SetRenderScale(void)
+{
+    // any frames still queued were drawn at the old size
+    I_StopPresentThread();
+
+    V_SetScreenScale(vid_renderscale);
+    I_RestartGraphics();
+
+    // the automap needs the new size of the view straight away
+    R_SetViewSize(r_screensize);
+    R_ExecuteSetViewSize();
+
+    // but set it again so the border around the view is redrawn
+    setsizeneeded = true;
+
+    if (gamestate == GS_LEVEL)
+    {
+        AM_Start(automapactive);
+        ST_doRefresh();
+    }
+}
+
 void I_ToggleFullscreen(void)
 {
     dboolean    fullscreen = !vid_fullscreen;
 
+    if (headless)
+        return;
+
+    I_StopPresentThread();
+
     if (!M_StringCompare(vid_screenresolution, vid_screenresolution_desktop)
         || SDL_SetWindowFullscreen(window, (fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0)) < 0)
     {
+        I_RestartPresentThread();
         menuactive = false;
         C_ShowConsole();
         C_Warning("Unable to switch to %s mode.", (fullscreen ? "fullscreen" : "windowed"));
@@ -1770,6 +2369,8 @@ void I_ToggleFullscreen(void)
         if (menuactive || consoleactive || paused || gamestate != GS_LEVEL)
             SDL_WarpMouseInWindow(window, windowwidth - 10 * windowwidth / SCREENWIDTH, windowheight - 16);
     }
+
+    I_RestartPresentThread();
 }
 
 static void I_InitGammaTables(void)
@@ -1863,8 +2464,30 @@ void I_InitGraphics(void)
 
     I_InitGammaTables();
 
+    if ((headless = !!M_CheckParm("-headless")))
+    {
+        int p = M_CheckParmWithArgs("-dumpframes", 1, 1);
+
+        // SDL still needs a video driver to handle events
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+
+        if (p)
+        {
+            if (M_StringCompare(myargv[p + 1], "-"))
+            {
+                dumpfile = stdout;
+
+#if defined(_WIN32)
+                // stop each LF in the frames from being written as CR LF
+                _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            }
+            else if (!(dumpfile = fopen(myargv[p + 1], "wb")))
+                C_Warning("<b>%s</b> couldn't be opened to dump frames to.", myargv[p + 1]);
+        }
+    }
 #if !defined(_WIN32)
-    if (*vid_driver)
+    else if (*vid_driver)
     {
         char    envstring[255];
 
@@ -1883,23 +2506,34 @@ void I_InitGraphics(void)
     vid_fullscreen = false;
 #endif
 
+    lastscreen = Z_Malloc(MAXSCREENWIDTH * MAXSCREENHEIGHT, PU_STATIC, NULL);
+
     SetVideoMode(true);
 
-    mapscreen = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
+    mapscreen = Z_Malloc(MAXSCREENWIDTH * MAXSCREENHEIGHT, PU_STATIC, NULL);
     I_CreateExternalAutomap(true);
 
 #if defined(_WIN32)
-    I_InitWindows32();
+    if (!headless)
+        I_InitWindows32();
 #endif
 
     SDL_EventState(SDL_SYSWMEVENT, SDL_ENABLE);
 
     SDL_SetWindowTitle(window, PACKAGE_NAME);
 
-    blitfunc = (nearestlinear ? I_Blit_NearestLinear : I_Blit);
-    blitfunc();
+    I_InitConvertScreen();
+    I_UpdateBlitFunc(false);
+    I_InitScript();
+
+    if (headless)
+        headlessstart = SDL_GetPerformanceCounter();
+    else
+        blitfunc();
 
     while (SDL_PollEvent(&dummy));
 
     UpdateGrab();
+
+    I_RestartPresentThread();
 }
@@ -61,6 +61,7 @@ void I_InitKeyboard(void);
 // and sets up the video mode
 void I_InitGraphics(void);
 void I_RestartGraphics(void);
+void I_SetRenderScale(void);
 void I_ShutdownGraphics(void);
 
 void GetWindowPosition(void);
@@ -73,6 +74,8 @@ void I_ShutdownKeyboard(void);
 void I_SetPalette(byte *palette);
 
 void I_UpdateBlitFunc(dboolean shake);
+void I_WaitForPresentThread(void);
+void I_RestartPresentThread(void);
 void I_Blit_Automap(void);
 void I_CreateExternalAutomap(dboolean output);
 void I_DestroyExternalAutomap(void);
@@ -126,6 +129,7 @@ extern int              windowwidth;
 
 extern SDL_Window       *window;
 extern SDL_Renderer     *renderer;
+extern dboolean         headless;
 
 extern SDL_Window       *mapwindow;
 extern byte             *mapscreen;
@@ -97,6 +97,7 @@ extern int              r_berserkintensity;
 extern int              r_blood;
 extern int              r_bloodsplats_max;
 extern dboolean         r_brightmaps;
+extern dboolean         r_columnmajor;
 extern dboolean         r_corpses_color;
 extern dboolean         r_corpses_mirrored;
 extern dboolean         r_corpses_moreblood;
@@ -106,6 +107,9 @@ extern dboolean         r_corpses_smearblood;
 extern int              r_detail;
 extern dboolean         r_diskicon;
 extern dboolean         r_dither;
+extern dboolean         r_drawcommands;
+extern dboolean         r_dynamicresolution;
+extern float            r_dynamicresolution_budget;
 extern dboolean         r_fixmaperrors;
 extern dboolean         r_fixspriteoffsets;
 extern dboolean         r_floatbob;
@@ -119,13 +123,22 @@ extern dboolean         r_liquid_lowerview;
 extern dboolean         r_liquid_swirl;
 extern char             *r_lowpixelsize;
 extern dboolean         r_mirroredweapons;
+extern dboolean         r_parallelplanes;
+extern dboolean         r_parallelsprites;
+extern dboolean         r_planestats;
 extern dboolean         r_playersprites;
+extern dboolean         r_pvs;
+extern dboolean         r_quadcolumns;
 extern dboolean         r_rockettrails;
 extern dboolean         r_shadows;
 extern dboolean         r_shake_barrels;
 extern int              r_shake_damage;
+extern int              r_simd;
 extern int              r_skycolor;
+extern int              r_texturecache;
+extern dboolean         r_texturecache_prebuild;
 extern dboolean         r_textures;
+extern int              r_threads;
 extern dboolean         r_translucency;
 extern int              s_musicvolume;
 extern dboolean         s_randommusic;
@@ -183,6 +196,8 @@ extern char             *vid_driver;
 extern dboolean         vid_fullscreen;
 extern int              vid_motionblur;
 extern dboolean         vid_pillarboxes;
+extern dboolean         vid_presentthread;
+extern int              vid_renderscale;
 extern char             *vid_scaleapi;
 extern char             *vid_scalefilter;
 extern char             *vid_screenresolution;
@@ -270,6 +285,7 @@ static default_t cvars[] =
     CONFIG_VARIABLE_INT          (r_blood,                                           BLOODVALUEALIAS ),
     CONFIG_VARIABLE_INT          (r_bloodsplats_max,                                 NOVALUEALIAS    ),
     CONFIG_VARIABLE_INT          (r_brightmaps,                                      BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_INT          (r_columnmajor,                                     BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_corpses_color,                                   BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_corpses_mirrored,                                BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_corpses_moreblood,                               BOOLVALUEALIAS  ),
@@ -279,6 +295,9 @@ static default_t cvars[] =
     CONFIG_VARIABLE_INT          (r_detail,                                          DETAILVALUEALIAS),
     CONFIG_VARIABLE_INT          (r_diskicon,                                        BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_dither,                                          BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_INT          (r_drawcommands,                                    BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_INT          (r_dynamicresolution,                               BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_FLOAT        (r_dynamicresolution_budget,                        NOVALUEALIAS    ),
     CONFIG_VARIABLE_INT          (r_fixmaperrors,                                    BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_fixspriteoffsets,                                BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_floatbob,                                        BOOLVALUEALIAS  ),
@@ -292,14 +311,23 @@ static default_t cvars[] =
     CONFIG_VARIABLE_INT          (r_liquid_swirl,                                    BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_OTHER        (r_lowpixelsize,                                    NOVALUEALIAS    ),
     CONFIG_VARIABLE_INT          (r_mirroredweapons,                                 BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_INT          (r_parallelplanes,                                  BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_INT          (r_parallelsprites,                                 BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_INT          (r_planestats,                                      BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_playersprites,                                   BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_INT          (r_pvs,                                             BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_INT          (r_quadcolumns,                                     BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_rockettrails,                                    BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_screensize,                                      NOVALUEALIAS    ),
     CONFIG_VARIABLE_INT          (r_shadows,                                         BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_shake_barrels,                                   BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT_PERCENT  (r_shake_damage,                                    NOVALUEALIAS    ),
+    CONFIG_VARIABLE_INT          (r_simd,                                            SIMDVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_skycolor,                                        SKYVALUEALIAS   ),
+    CONFIG_VARIABLE_INT          (r_texturecache,                                    NOVALUEALIAS    ),
+    CONFIG_VARIABLE_INT          (r_texturecache_prebuild,                           BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT          (r_textures,                                        BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_INT          (r_threads,                                         NOVALUEALIAS    ),
     CONFIG_VARIABLE_INT          (r_translucency,                                    BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT_PERCENT  (s_musicvolume,                                     NOVALUEALIAS    ),
     CONFIG_VARIABLE_INT          (s_randommusic,                                     BOOLVALUEALIAS  ),
@@ -320,6 +348,8 @@ static default_t cvars[] =
     CONFIG_VARIABLE_INT          (vid_fullscreen,                                    BOOLVALUEALIAS  ),
     CONFIG_VARIABLE_INT_PERCENT  (vid_motionblur,                                    NOVALUEALIAS    ),
     CONFIG_VARIABLE_INT          (vid_pillarboxes,                                   BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_INT          (vid_presentthread,                                 BOOLVALUEALIAS  ),
+    CONFIG_VARIABLE_INT          (vid_renderscale,                                   NOVALUEALIAS    ),
     CONFIG_VARIABLE_STRING       (vid_scaleapi,                                      NOVALUEALIAS    ),
     CONFIG_VARIABLE_STRING       (vid_scalefilter,                                   NOVALUEALIAS    ),
     CONFIG_VARIABLE_OTHER        (vid_screenresolution,                              NOVALUEALIAS    ),
@@ -383,6 +413,8 @@ valuealias_t valuealiases[] =
     { "red",      1, BLOODVALUEALIAS  }, { "all",     2, BLOODVALUEALIAS  },
     { "imperial", 0, UNITSVALUEALIAS  }, { "metric",  1, UNITSVALUEALIAS  },
     { "off",      0, CAPVALUEALIAS    }, { "none",   -1, SKYVALUEALIAS    },
+    { "auto",     0, SIMDVALUEALIAS   }, { "none",    1, SIMDVALUEALIAS   },
+    { "sse2",     2, SIMDVALUEALIAS   }, { "avx2",    3, SIMDVALUEALIAS   },
     { "",         0, NOVALUEALIAS     }
 };
 
@@ -749,6 +781,9 @@ static void M_CheckCVARs(void)
     if (r_brightmaps != false && r_brightmaps != true)
         r_brightmaps = r_brightmaps_default;
 
+    if (r_columnmajor != false && r_columnmajor != true)
+        r_columnmajor = r_columnmajor_default;
+
     if (r_corpses_color != false && r_corpses_color != true)
         r_corpses_color = r_corpses_color_default;
 
@@ -776,6 +811,15 @@ static void M_CheckCVARs(void)
     if (r_dither != false && r_dither != true)
         r_dither = r_dither_default;
 
+    if (r_drawcommands != false && r_drawcommands != true)
+        r_drawcommands = r_drawcommands_default;
+
+    if (r_dynamicresolution != false && r_dynamicresolution != true)
+        r_dynamicresolution = r_dynamicresolution_default;
+
+    r_dynamicresolution_budget = BETWEENF(r_dynamicresolution_budget_min, r_dynamicresolution_budget,
+        r_dynamicresolution_budget_max);
+
     if (r_fixmaperrors != false && r_fixmaperrors != true)
         r_fixmaperrors = r_fixmaperrors_default;
 
@@ -812,9 +856,24 @@ static void M_CheckCVARs(void)
     if (r_mirroredweapons != false && r_mirroredweapons != true)
         r_mirroredweapons = r_mirroredweapons_default;
 
+    if (r_parallelplanes != false && r_parallelplanes != true)
+        r_parallelplanes = r_parallelplanes_default;
+
+    if (r_parallelsprites != false && r_parallelsprites != true)
+        r_parallelsprites = r_parallelsprites_default;
+
+    if (r_planestats != false && r_planestats != true)
+        r_planestats = r_planestats_default;
+
     if (r_playersprites != false && r_playersprites != true)
         r_playersprites = r_playersprites_default;
 
+    if (r_pvs != false && r_pvs != true)
+        r_pvs = r_pvs_default;
+
+    if (r_quadcolumns != false && r_quadcolumns != true)
+        r_quadcolumns = r_quadcolumns_default;
+
     if (r_rockettrails != false && r_rockettrails != true)
         r_rockettrails = r_rockettrails_default;
 
@@ -828,12 +887,21 @@ static void M_CheckCVARs(void)
 
     r_shake_damage = BETWEEN(r_shake_damage_min, r_shake_damage, r_shake_damage_max);
 
+    r_simd = BETWEEN(r_simd_min, r_simd, r_simd_max);
+
     if (r_skycolor != r_skycolor_none && (r_skycolor < r_skycolor_min || r_skycolor > r_skycolor_max))
         r_skycolor = r_skycolor_default;
 
+    r_texturecache = BETWEEN(r_texturecache_min, r_texturecache, r_texturecache_max);
+
+    if (r_texturecache_prebuild != false && r_texturecache_prebuild != true)
+        r_texturecache_prebuild = r_texturecache_prebuild_default;
+
     if (r_textures != false && r_textures != true)
         r_textures = r_textures_default;
 
+    r_threads = BETWEEN(r_threads_min, r_threads, r_threads_max);
+
     if (r_translucency != false && r_translucency != true)
         r_translucency = r_translucency_default;
 
@@ -869,6 +937,11 @@ static void M_CheckCVARs(void)
 
     vid_motionblur = BETWEEN(vid_motionblur_min, vid_motionblur, vid_motionblur_max);
 
+    if (vid_presentthread != false && vid_presentthread != true)
+        vid_presentthread = vid_presentthread_default;
+
+    vid_renderscale = BETWEEN(vid_renderscale_min, vid_renderscale, vid_renderscale_max);
+
     if (!M_StringCompare(vid_scaleapi, vid_scaleapi_direct3d)
         && !M_StringCompare(vid_scaleapi, vid_scaleapi_opengl)
 #if !defined(_WIN32)
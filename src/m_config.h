@@ -52,6 +52,14 @@ typedef enum
     r_detail_high
 } r_detail_values_t;
 
+typedef enum
+{
+    r_simd_auto,
+    r_simd_none,
+    r_simd_sse2,
+    r_simd_avx2
+} r_simd_values_t;
+
 typedef enum
 {
     units_imperial,
@@ -236,6 +244,8 @@ typedef enum
 
 #define r_brightmaps_default                    true
 
+#define r_columnmajor_default                   false
+
 #define r_corpses_color_default                 true
 
 #define r_corpses_mirrored_default              true
@@ -254,6 +264,14 @@ typedef enum
 
 #define r_dither_default                        false
 
+#define r_drawcommands_default                  false
+
+#define r_dynamicresolution_default             false
+
+#define r_dynamicresolution_budget_min          1.0f
+#define r_dynamicresolution_budget_default      8.3f
+#define r_dynamicresolution_budget_max          1000.0f
+
 #define r_fixmaperrors_default                  true
 
 #define r_fixspriteoffsets_default              true
@@ -282,8 +300,18 @@ typedef enum
 
 #define r_mirroredweapons_default               false
 
+#define r_parallelplanes_default                false
+
+#define r_parallelsprites_default               false
+
+#define r_planestats_default                    false
+
 #define r_playersprites_default                 true
 
+#define r_pvs_default                           false
+
+#define r_quadcolumns_default                   false
+
 #define r_rockettrails_default                  true
 
 #define r_screensize_min                        0
@@ -298,13 +326,27 @@ typedef enum
 #define r_shake_damage_default                  50
 #define r_shake_damage_max                      100
 
+#define r_simd_min                              r_simd_auto
+#define r_simd_default                          r_simd_auto
+#define r_simd_max                              r_simd_avx2
+
 #define r_skycolor_none                         -1
 #define r_skycolor_min                          0
 #define r_skycolor_default                      r_skycolor_none
 #define r_skycolor_max                          255
 
+#define r_texturecache_min                      8
+#define r_texturecache_default                  64
+#define r_texturecache_max                      1024
+
+#define r_texturecache_prebuild_default         true
+
 #define r_textures_default                      true
 
+#define r_threads_min                           1
+#define r_threads_default                       1
+#define r_threads_max                           16
+
 #define r_translucency_default                  true
 
 #define s_musicvolume_min                       0
@@ -365,6 +407,12 @@ typedef enum
 
 #define vid_pillarboxes_default                 false
 
+#define vid_presentthread_default               false
+
+#define vid_renderscale_min                     1
+#define vid_renderscale_default                 2
+#define vid_renderscale_max                     MAXSCREENSCALE
+
 #define vid_scaleapi_direct3d                   "direct3d"
 #define vid_scaleapi_opengl                     "opengl"
 #if !defined(_WIN32)
@@ -497,7 +545,8 @@ typedef enum
     BLOODVALUEALIAS,
     UNITSVALUEALIAS,
     CAPVALUEALIAS,
-    SKYVALUEALIAS
+    SKYVALUEALIAS,
+    SIMDVALUEALIAS
 } valuealias_type_t;
 
 typedef struct
@@ -521,6 +521,8 @@ void M_DarkBackground(void)
 
     height = (SCREENHEIGHT - vid_widescreen * SBARHEIGHT) * SCREENWIDTH;
 
+    V_MarkScreenDirty();
+
     if (!blurred || !blurred2)
     {
         BlurScreen(screens[0], tempscreen1, blurscreen1);
@@ -597,6 +599,8 @@ void M_DarkBlueBackground(void)
 {
     int x, y;
 
+    V_MarkScreenDirty();
+
     for (y = 0; y < SCREENWIDTH * SCREENHEIGHT; y += SCREENWIDTH * 2)
         for (x = y; x < y + SCREENWIDTH; x += 2)
         {
@@ -1510,8 +1514,8 @@ void M_DrawMainMenu(void)
     else
     {
         int     y = 11 + OFFSET;
-        int     dot1 = screens[0][(y * SCREENWIDTH + 98) * 2];
-        int     dot2 = screens[0][((y + 1) * SCREENWIDTH + 99) * 2];
+        int     dot1 = screens[0][(y * SCREENWIDTH + 98) * SCREENSCALE];
+        int     dot2 = screens[0][((y + 1) * SCREENWIDTH + 99) * SCREENSCALE];
 
         M_DrawCenteredPatchWithShadow(y, patch);
         if (gamemode != commercial)
@@ -3273,7 +3277,7 @@ void M_Drawer(void)
         M_DarkBackground();
 
         if (vid_widescreen)
-            y = viewwindowy / 2 + (viewheight / 2 - M_StringHeight(messageString)) / 2 - 1;
+            y = viewwindowy / 2 + (scaledviewheight / 2 - M_StringHeight(messageString)) / 2 - 1;
         else
             y = (ORIGINALHEIGHT - M_StringHeight(messageString)) / 2 - 1;
         while (messageString[start] != '\0')
@@ -3457,10 +3461,10 @@ void M_Init(void)
     messageString = NULL;
     messageLastMenuActive = menuactive;
     quickSaveSlot = -1;
-    tempscreen1 = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
-    tempscreen2 = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
-    blurscreen1 = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
-    blurscreen2 = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
+    tempscreen1 = Z_Malloc(MAXSCREENWIDTH * MAXSCREENHEIGHT, PU_STATIC, NULL);
+    tempscreen2 = Z_Malloc(MAXSCREENWIDTH * MAXSCREENHEIGHT, PU_STATIC, NULL);
+    blurscreen1 = Z_Malloc(MAXSCREENWIDTH * MAXSCREENHEIGHT, PU_STATIC, NULL);
+    blurscreen2 = Z_Malloc(MAXSCREENWIDTH * MAXSCREENHEIGHT, PU_STATIC, NULL);
 
     pipechar = W_CacheLumpName((W_CheckNumForName("STCFN121") >= 0 ? "STCFN121" : "STCFN124"),
         PU_CACHE);
@@ -59,6 +59,7 @@ result_e T_MovePlane(sector_t *sector, fixed_t speed, fixed_t dest, dboolean cru
     fixed_t     destheight;
 
     sector->oldgametic = gametic;
+    P_AddMovingSector(sector);
 
     switch (floorOrCeiling)
     {
@@ -119,6 +119,10 @@ extern int                      r_blood;
 extern int                      r_bloodsplats_total;
 extern int                      r_bloodsplats_max;
 
+extern bloodsplat_t             *bloodsplatpool;
+extern int                      bloodsplatpoolsize;
+extern int                      bloodsplathead;
+
 extern dboolean                 r_corpses_mirrored;
 extern dboolean                 r_corpses_moreblood;
 extern dboolean                 r_corpses_slide;
@@ -143,6 +147,9 @@ void P_MobjThinker(mobj_t *mobj);
 void P_SpawnPuff(fixed_t x, fixed_t y, fixed_t z, angle_t angle);
 void P_SpawnSmokeTrail(fixed_t x, fixed_t y, fixed_t z, angle_t angle);
 void P_SpawnBlood(fixed_t x, fixed_t y, fixed_t z, angle_t angle, int damage, mobj_t *target);
+void P_AddBloodSplat(const bloodsplat_t *splat);
+void P_ClearBloodSplats(void);
+void P_ResizeBloodSplats(void);
 void P_SpawnBloodSplat(fixed_t x, fixed_t y, int blood, int maxheight, mobj_t *target);
 mobj_t *P_SpawnMissile(mobj_t *source, mobj_t *dest, mobjtype_t type);
 void P_SpawnPlayerMissile(mobj_t *source, mobjtype_t type);
@@ -252,6 +259,7 @@ void P_MapEnd(void);
 // P_SETUP
 //
 extern const byte       *rejectmatrix;  // for fast sight rejection
+extern byte             *pvsmatrix;     // for rejecting sectors that can't be seen when drawing
 extern int              *blockmaplump;
 extern int              *blockmap;
 extern int              bmapwidth;
@@ -1978,15 +1978,8 @@ dboolean P_ChangeSector(sector_t *sector, dboolean crunch)
 
     if ((isliquidsector = sector->isliquid = isliquid[sector->floorpic]))
     {
-        bloodsplat_t    *splat = sector->splatlist;
-
-        while (splat)
-        {
-            bloodsplat_t        *next = splat->snext;
-
-            P_UnsetBloodSplatPosition(splat);
-            splat = next;
-        }
+        while (sector->splatfirst != -1)
+            P_UnsetBloodSplatPosition(bloodsplatpool + sector->splatfirst);
     }
     else
     {
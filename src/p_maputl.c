@@ -250,15 +250,28 @@ void P_UnsetThingPosition(mobj_t *thing)
 //
 void P_UnsetBloodSplatPosition(bloodsplat_t *splat)
 {
-    bloodsplat_t        **sprev = splat->sprev;
-    bloodsplat_t        *snext = splat->snext;
+    sector_t    *sec = splat->sector;
+    const int   index = (int)(splat - bloodsplatpool);
+    int         *link = &sec->splatfirst;
+    int         prev = -1;
 
-    if ((*sprev = snext))
-        snext->sprev = sprev;
+    // the oldest splat overall is always first in its sector, so this is quick
+    while (*link != index)
+    {
+        prev = *link;
+        link = &bloodsplatpool[prev].snext;
+    }
 
-    r_bloodsplats_total--;
+    *link = splat->snext;
+
+    if (sec->splatlast == index)
+        sec->splatlast = prev;
+
+    if (sec->splatfirst == -1)
+        M_ClearBox(sec->splatbbox);
 
-    free(splat);
+    splat->sector = NULL;
+    r_bloodsplats_total--;
 }
 
 //
@@ -336,13 +349,22 @@ void P_SetThingPosition(mobj_t *thing)
 //
 void P_SetBloodSplatPosition(bloodsplat_t *splat)
 {
-    bloodsplat_t        **link = &splat->sector->splatlist;
-    bloodsplat_t        *snext = *link;
+    sector_t        *sec = splat->sector;
+    const int       index = (int)(splat - bloodsplatpool);
+    const fixed_t   radius = spritewidth[splat->frame] >> 1;
+
+    splat->snext = -1;
+
+    if (sec->splatlast == -1)
+        sec->splatfirst = index;
+    else
+        bloodsplatpool[sec->splatlast].snext = index;
+
+    sec->splatlast = index;
 
-    if ((splat->snext = snext))
-        snext->sprev = &splat->snext;
-    splat->sprev = link;
-    *link = splat;
+    // keep a bounding box around the splats so they can be culled together
+    M_AddToBox(sec->splatbbox, splat->x - radius, splat->y - radius);
+    M_AddToBox(sec->splatbbox, splat->x + radius, splat->y + radius);
 }
 
 //
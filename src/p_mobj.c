@@ -41,6 +41,7 @@
 #include "hu_stuff.h"
 #include "i_gamepad.h"
 #include "i_system.h"
+#include "m_bbox.h"
 #include "m_random.h"
 #include "p_local.h"
 #include "p_tick.h"
@@ -55,6 +56,12 @@ int                     r_blood = r_blood_default;
 int                     r_bloodsplats_max = r_bloodsplats_max_default;
 int                     r_bloodsplats_total;
 
+// All the blood splats in the current map are kept in one ring buffer, so when it is full
+//  the oldest splat, at bloodsplathead, is the one replaced.
+bloodsplat_t            *bloodsplatpool;
+int                     bloodsplatpoolsize;
+int                     bloodsplathead;
+
 dboolean                r_corpses_color = r_corpses_color_default;
 dboolean                r_corpses_mirrored = r_corpses_mirrored_default;
 dboolean                r_corpses_moreblood = r_corpses_moreblood_default;
@@ -755,6 +762,9 @@ mobj_t *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type)
     mobj->oldy = mobj->y;
     mobj->oldz = mobj->z;
     mobj->oldangle = mobj->angle;
+    mobj->interpx = mobj->x;
+    mobj->interpy = mobj->y;
+    mobj->interpz = mobj->z;
 
     mobj->thinker.function = P_MobjThinker;
     P_AddThinker(&mobj->thinker);
@@ -1236,6 +1246,85 @@ void P_SpawnBlood(fixed_t x, fixed_t y, fixed_t z, angle_t angle, int damage, mo
     }
 }
 
+//
+// P_ClearBloodSplats
+// Remove all blood splats, and make room for r_bloodsplats_max of them.
+//
+void P_ClearBloodSplats(void)
+{
+    int i;
+
+    if (bloodsplatpoolsize != r_bloodsplats_max)
+    {
+        bloodsplatpoolsize = r_bloodsplats_max;
+        bloodsplatpool = realloc(bloodsplatpool, MAX(1, bloodsplatpoolsize) * sizeof(*bloodsplatpool));
+    }
+
+    for (i = 0; i < bloodsplatpoolsize; i++)
+        bloodsplatpool[i].sector = NULL;
+
+    bloodsplathead = 0;
+    r_bloodsplats_total = 0;
+
+    for (i = 0; i < numsectors; i++)
+    {
+        sector_t    *sec = sectors + i;
+
+        sec->splatfirst = -1;
+        sec->splatlast = -1;
+        M_ClearBox(sec->splatbbox);
+    }
+}
+
+//
+// P_ResizeBloodSplats
+// Make room for r_bloodsplats_max blood splats, keeping as many of the newest ones as
+//  there is room for.
+//
+void P_ResizeBloodSplats(void)
+{
+    const int       oldsize = bloodsplatpoolsize;
+    const int       oldhead = bloodsplathead;
+    bloodsplat_t    *oldpool = malloc(MAX(1, oldsize) * sizeof(*oldpool));
+    int             i;
+
+    memcpy(oldpool, bloodsplatpool, oldsize * sizeof(*oldpool));
+    P_ClearBloodSplats();
+
+    for (i = 0; i < oldsize; i++)
+    {
+        bloodsplat_t    *splat = oldpool + (oldhead + i) % oldsize;
+
+        if (splat->sector)
+            P_AddBloodSplat(splat);
+    }
+
+    free(oldpool);
+}
+
+//
+// P_AddBloodSplat
+// Copy a blood splat into bloodsplatpool[], in place of the oldest one if it's full.
+//
+void P_AddBloodSplat(const bloodsplat_t *splat)
+{
+    bloodsplat_t    *slot;
+
+    if (!bloodsplatpoolsize)
+        return;
+
+    slot = bloodsplatpool + bloodsplathead;
+
+    if (slot->sector)
+        P_UnsetBloodSplatPosition(slot);
+
+    *slot = *splat;
+    P_SetBloodSplatPosition(slot);
+    r_bloodsplats_total++;
+
+    bloodsplathead = (bloodsplathead + 1) % bloodsplatpoolsize;
+}
+
 //
 // P_SpawnBloodSplat
 //
@@ -1243,7 +1332,7 @@ extern short    firstbloodsplatlump;
 
 void P_SpawnBloodSplat(fixed_t x, fixed_t y, int blood, int maxheight, mobj_t *target)
 {
-    if (r_bloodsplats_total == r_bloodsplats_max)
+    if (!bloodsplatpoolsize)
         return;
     else
     {
@@ -1251,26 +1340,24 @@ void P_SpawnBloodSplat(fixed_t x, fixed_t y, int blood, int maxheight, mobj_t *t
 
         if (!sec->isliquid && sec->interpfloorheight <= maxheight && sec->floorpic != skyflatnum)
         {
-            bloodsplat_t    *splat = malloc(sizeof(*splat));
+            bloodsplat_t    splat;
 
-            splat->frame = firstbloodsplatlump + (rand() & 7);
-            splat->flags = rand() & BSF_MIRRORED;
+            splat.frame = firstbloodsplatlump + (rand() & 7);
+            splat.flags = rand() & BSF_MIRRORED;
 
             if (blood == FUZZYBLOOD)
             {
-                splat->flags |= BSF_FUZZ;
-                splat->colfunc = fuzzcolfunc;
+                splat.flags |= BSF_FUZZ;
+                splat.colfunc = fuzzcolfunc;
             }
             else
-                splat->colfunc = bloodsplatcolfunc;
-
-            splat->blood = blood;
-            splat->x = x;
-            splat->y = y;
-            splat->sector = sec;
-            P_SetBloodSplatPosition(splat);
+                splat.colfunc = bloodsplatcolfunc;
 
-            r_bloodsplats_total++;
+            splat.blood = blood;
+            splat.x = x;
+            splat.y = y;
+            splat.sector = sec;
+            P_AddBloodSplat(&splat);
 
             if (target && target->bloodsplats)
                 target->bloodsplats--;
@@ -416,6 +416,12 @@ typedef struct mobj_s
     fixed_t             oldz;
     angle_t             oldangle;
 
+    // Interpolated position, calculated once per frame
+    // by R_InterpolateMovers() and used by the renderer.
+    fixed_t             interpx;
+    fixed_t             interpy;
+    fixed_t             interpz;
+
     fixed_t             nudge;
 
     int                 pitch;
@@ -427,10 +433,9 @@ typedef struct bloodsplat_s
 {
     fixed_t             x;
     fixed_t             y;
-    struct bloodsplat_s *snext;
-    struct bloodsplat_s **sprev;
+    int                 snext;          // next splat in the same sector, or -1
     int                 frame;
-    struct sector_s     *sector;
+    struct sector_s     *sector;        // NULL once the splat has been removed
     int                 flags;
     int                 blood;
 
@@ -1021,6 +1021,8 @@ void P_UnArchiveWorld(void)
     {
         sec->floorheight = saveg_read16() << FRACBITS;
         sec->ceilingheight = saveg_read16() << FRACBITS;
+        sec->interpfloorheight = sec->floorheight;
+        sec->interpceilingheight = sec->ceilingheight;
         sec->floorpic = saveg_read16();
         sec->ceilingpic = saveg_read16();
         sec->lightlevel = saveg_read16();
@@ -1075,12 +1077,12 @@ void P_ArchiveThinkers(void)
         saveg_write_mobj_t((mobj_t *)th);
     }
 
-    // save off the bloodsplats
-    for (i = 0; i < numsectors; i++)
+    // save off the bloodsplats, oldest first
+    for (i = 0; i < bloodsplatpoolsize; i++)
     {
-        bloodsplat_t    *splat;
+        bloodsplat_t    *splat = bloodsplatpool + (bloodsplathead + i) % bloodsplatpoolsize;
 
-        for (splat = sectors[i].splatlist; splat; splat = splat->snext)
+        if (splat->sector)
         {
             saveg_write8(tc_bloodsplat);
             saveg_write_pad();
@@ -1112,7 +1114,6 @@ void P_UnArchiveThinkers(void)
 {
     thinker_t   *currentthinker = thinkercap.next;
     thinker_t   *next;
-    int i;
 
     // remove all the current thinkers
     while (currentthinker != &thinkercap)
@@ -1133,18 +1134,8 @@ void P_UnArchiveThinkers(void)
     P_InitThinkers();
 
     // remove the remaining bloodsplats
-    for (i = 0; i < numsectors; i++)
-    {
-        bloodsplat_t    *splat = sectors[i].splatlist;
-
-        while (splat)
-        {
-            bloodsplat_t    *next = splat->snext;
-
-            P_UnsetBloodSplatPosition(splat);
-            splat = next;
-        }
-    }
+    P_ClearBloodSplats();
+    P_ClearMovers();
 
     // read in saved thinkers
     while (1)
@@ -1165,6 +1156,9 @@ void P_UnArchiveThinkers(void)
 
                 P_SetThingPosition(mobj);
                 mobj->info = &mobjinfo[mobj->type];
+                mobj->interpx = mobj->x;
+                mobj->interpy = mobj->y;
+                mobj->interpz = mobj->z;
 
                 mobj->thinker.function = P_MobjThinker;
                 mobj->colfunc = mobj->info->colfunc;
@@ -1181,18 +1175,14 @@ void P_UnArchiveThinkers(void)
 
             case tc_bloodsplat:
             {
-                bloodsplat_t    *splat = Z_Malloc(sizeof(*splat), PU_LEVEL, NULL);
+                bloodsplat_t    splat;
 
                 saveg_read_pad();
-                saveg_read_bloodsplat_t(splat);
+                saveg_read_bloodsplat_t(&splat);
 
-                if (r_bloodsplats_total < r_bloodsplats_max)
-                {
-                    splat->sector = R_PointInSubsector(splat->x, splat->y)->sector;
-                    P_SetBloodSplatPosition(splat);
-                    splat->colfunc = (splat->blood == FUZZYBLOOD ? fuzzcolfunc : bloodsplatcolfunc);
-                    r_bloodsplats_total++;
-                }
+                splat.sector = R_PointInSubsector(splat.x, splat.y)->sector;
+                splat.colfunc = (splat.blood == FUZZYBLOOD ? fuzzcolfunc : bloodsplatcolfunc);
+                P_AddBloodSplat(&splat);
                 break;
             }
 
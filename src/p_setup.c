@@ -37,6 +37,7 @@
 */
 
 #include <ctype.h>
+#include <math.h>
 
 #include "am_map.h"
 #include "c_console.h"
@@ -44,6 +45,7 @@
 #include "doomstat.h"
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_timer.h"
 #include "m_argv.h"
 #include "m_bbox.h"
 #include "m_menu.h"
@@ -118,6 +120,8 @@ subsector_t     *subsectors;
 
 int             numnodes;
 node_t          *nodes;
+packednode_t    *packednodes;
+nodebbox_t      *packednodebboxes;
 
 int             numlines;
 line_t          *lines;
@@ -164,6 +168,7 @@ dboolean        skipblstart;            // MaxW: Skip initial blocklist short
 //
 static int      rejectlump = -1;        // cph - store reject lump num if cached
 const byte      *rejectmatrix;          // cph - const*
+byte            *pvsmatrix;
 
 static mapinfo_t mapinfo[99];
 
@@ -204,6 +209,7 @@ lumpindex_t     RMAPINFO;
 lumpindex_t     MAPINFO;
 
 dboolean        r_fixmaperrors = r_fixmaperrors_default;
+dboolean        r_pvs = r_pvs_default;
 
 static int      current_episode = -1;
 static int      current_map = -1;
@@ -1085,6 +1091,83 @@ static void P_LoadZNodes(int lump)
     W_ReleaseLumpNum(lump);
 }
 
+//
+// P_PackNodes
+// Copy nodes[] into packednodes[] and packednodebboxes[] (see r_defs.h), so that
+//  walking down the BSP tree touches as few cache lines as possible.
+//
+static void P_PackNodes(void)
+{
+    int *order = malloc(MAX(1, numnodes) * sizeof(*order));
+    int *stack = malloc(MAX(1, numnodes) * sizeof(*stack));
+    int numstack = 0;
+    int next = numnodes;
+    int i;
+
+    packednodes = realloc(packednodes, MAX(1, numnodes) * sizeof(*packednodes));
+    packednodebboxes = realloc(packednodebboxes, MAX(1, numnodes) * sizeof(*packednodebboxes));
+
+    for (i = 0; i < numnodes; i++)
+        order[i] = -1;
+
+    // number the nodes in depth-first order from the root, which keeps the last index
+    if (numnodes)
+    {
+        order[numnodes - 1] = 0;
+        stack[numstack++] = numnodes - 1;
+    }
+
+    while (numstack)
+    {
+        const int       k = stack[--numstack];
+        const node_t    *no = nodes + k;
+        int             j;
+
+        order[k] = --next;
+
+        // push the back child first so the front child is numbered next
+        for (j = 1; j >= 0; j--)
+        {
+            const int   child = no->children[j];
+
+            if (!(child & NF_SUBSECTOR) && child < numnodes && order[child] == -1)
+            {
+                order[child] = 0;
+                stack[numstack++] = child;
+            }
+        }
+    }
+
+    // any nodes that can't be reached from the root are put first
+    for (i = 0; i < numnodes; i++)
+        if (order[i] == -1)
+            order[i] = --next;
+
+    for (i = 0; i < numnodes; i++)
+    {
+        const node_t    *no = nodes + i;
+        packednode_t    *pn = packednodes + order[i];
+        int             j;
+
+        pn->x = no->x;
+        pn->y = no->y;
+        pn->dx = no->dx;
+        pn->dy = no->dy;
+
+        for (j = 0; j < 2; j++)
+        {
+            const int   child = no->children[j];
+
+            pn->children[j] = ((child & NF_SUBSECTOR) || child >= numnodes ? child : order[child]);
+        }
+
+        memcpy(packednodebboxes[order[i]], no->bbox, sizeof(no->bbox));
+    }
+
+    free(order);
+    free(stack);
+}
+
 //
 // P_LoadThings
 //
@@ -1762,6 +1845,378 @@ static void P_LoadReject(int lumpnum, int totallines)
     RejectOverrun(rejectlump, &rejectmatrix, totallines);
 }
 
+//
+// P_LoadPVS
+// Build a potentially visible set (PVS) for the current map, or load it from disk if it
+//  has been built before. Like REJECT, it is a matrix of one bit for each pair of sectors,
+//  but a set bit means that some part of the second sector might be seen from somewhere
+//  in the first. Each two-sided line between two different sectors is a portal, which is
+//  always treated as open, and the lines of sight that could pass through each chain of
+//  portals are followed from every portal in turn, in 2D.
+//
+#define PVSVERSION      1
+#define PVSEPSILON      0.5
+#define PVSSNAP         64.0
+#define PVSMAXSTEPS     200000000
+
+typedef struct
+{
+    // From the sector the portal leads out of, with the sector it leads into on the left.
+    double      x1, y1;
+    double      x2, y2;
+
+    int         line;
+    int         sector;
+} pvsportal_t;
+
+static int          numpvsportals;
+static pvsportal_t  *pvsportals;
+static int          *pvsfirstportal;    // index into pvssectorportals[] for each sector
+static int          *pvssectorportals;  // the portals leading out of each sector
+static double       *pvst0;             // the part of each portal that might be seen through
+static double       *pvst1;             //  the source portal
+static int          *pvsstamp;          // the source portal pvst0[] and pvst1[] are for
+static int          *pvsqueue;
+static byte         *pvsqueued;
+
+static void P_HashPVSInt(uint64_t *hash, int value)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        *hash ^= (value >> (i * 8)) & 0xFF;
+        *hash *= 1099511628211ull;
+    }
+}
+
+// Hash everything that the PVS is built from, so that it is rebuilt if any of it changes.
+static uint64_t P_HashPVS(void)
+{
+    uint64_t    hash = 14695981039346656037ull;
+    int         i;
+
+    P_HashPVSInt(&hash, PVSVERSION);
+    P_HashPVSInt(&hash, numsectors);
+    P_HashPVSInt(&hash, numlines);
+
+    for (i = 0; i < numlines; i++)
+    {
+        const line_t    *line = lines + i;
+
+        P_HashPVSInt(&hash, line->v1->x);
+        P_HashPVSInt(&hash, line->v1->y);
+        P_HashPVSInt(&hash, line->v2->x);
+        P_HashPVSInt(&hash, line->v2->y);
+        P_HashPVSInt(&hash, (line->frontsector ? (int)(line->frontsector - sectors) : -1));
+        P_HashPVSInt(&hash, (line->backsector ? (int)(line->backsector - sectors) : -1));
+    }
+
+    return hash;
+}
+
+// Return the distance of (x, y) to the left of the line from (x1, y1) to (x2, y2).
+static double P_PVSSide(double x1, double y1, double x2, double y2, double x, double y)
+{
+    const double    dx = x2 - x1;
+    const double    dy = y2 - y1;
+    const double    length = sqrt(dx * dx + dy * dy);
+
+    return (length < 1.0 ? 0.0 : (dx * (y - y1) - dy * (x - x1)) / length);
+}
+
+// Clip the part of a portal from t0 to t1 to what is left of the line from (x1, y1) to
+//  (x2, y2), and return false if nothing is left.
+static dboolean P_ClipPVSPortal(const pvsportal_t *portal, double x1, double y1, double x2,
+    double y2, double *t0, double *t1)
+{
+    const double    d1 = P_PVSSide(x1, y1, x2, y2, portal->x1, portal->y1) + PVSEPSILON;
+    const double    d2 = P_PVSSide(x1, y1, x2, y2, portal->x2, portal->y2) + PVSEPSILON;
+
+    if (d1 < 0.0)
+    {
+        if (d2 < 0.0)
+            return false;
+
+        *t0 = MAX(*t0, d1 / (d1 - d2));
+    }
+    else if (d2 < 0.0)
+        *t1 = MIN(*t1, d1 / (d1 - d2));
+
+    return (*t0 <= *t1);
+}
+
+// Clip the part of a portal from t0 to t1 to the lines separating the source and pass
+//  portals, so that only what a line through both of them could reach is left.
+static dboolean P_ClipPVSSeparators(const pvsportal_t *portal, const double source[4],
+    const double pass[4], double *t0, double *t1)
+{
+    int i, j;
+
+    for (i = 0; i < 4; i += 2)
+        for (j = 0; j < 4; j += 2)
+        {
+            const double    sx = source[i];
+            const double    sy = source[i + 1];
+            const double    px = pass[j];
+            const double    py = pass[j + 1];
+            const double    sourceside = P_PVSSide(sx, sy, px, py, source[i ^ 2], source[(i ^ 2) + 1]);
+            const double    passside = P_PVSSide(sx, sy, px, py, pass[j ^ 2], pass[(j ^ 2) + 1]);
+
+            if (sourceside < -PVSEPSILON && passside > PVSEPSILON)
+            {
+                if (!P_ClipPVSPortal(portal, sx, sy, px, py, t0, t1))
+                    return false;
+            }
+            else if (sourceside > PVSEPSILON && passside < -PVSEPSILON)
+            {
+                if (!P_ClipPVSPortal(portal, px, py, sx, sy, t0, t1))
+                    return false;
+            }
+        }
+
+    return true;
+}
+
+// Mark every sector that might be seen through the given source portal from the sector it
+//  leads out of. The part of each portal that might be seen only ever grows, so each is
+//  queued again whenever it does until nothing changes.
+static dboolean P_FlowPVSPortal(int source, int sector, int64_t *steps)
+{
+    const pvsportal_t   *s = pvsportals + source;
+    const double        sourceline[4] = { s->x1, s->y1, s->x2, s->y2 };
+    int                 head = 0;
+    int                 count = 1;
+
+    pvst0[source] = 0.0;
+    pvst1[source] = 1.0;
+    pvsstamp[source] = source;
+    pvsqueue[0] = source;
+    pvsqueued[source] = true;
+
+    while (count)
+    {
+        const int           p = pvsqueue[head];
+        const pvsportal_t   *pass = pvsportals + p;
+        const double        passline[4] =
+                            {
+                                pass->x1 + (pass->x2 - pass->x1) * pvst0[p],
+                                pass->y1 + (pass->y2 - pass->y1) * pvst0[p],
+                                pass->x1 + (pass->x2 - pass->x1) * pvst1[p],
+                                pass->y1 + (pass->y2 - pass->y1) * pvst1[p]
+                            };
+        const int           pnum = sector * numsectors + pass->sector;
+        int                 i;
+
+        head = (head + 1) % numpvsportals;
+        count--;
+        pvsqueued[p] = false;
+        pvsmatrix[pnum >> 3] |= 1 << (pnum & 7);
+
+        for (i = pvsfirstportal[pass->sector]; i < pvsfirstportal[pass->sector + 1]; i++)
+        {
+            const int           t = pvssectorportals[i];
+            const pvsportal_t   *target = pvsportals + t;
+            double              t0 = 0.0;
+            double              t1 = 1.0;
+
+            // a line of sight can only cross each line once
+            if (target->line == pass->line || target->line == s->line)
+                continue;
+
+            if (++*steps > PVSMAXSTEPS)
+                return false;
+
+            if (!P_ClipPVSPortal(target, passline[0], passline[1], passline[2], passline[3], &t0, &t1))
+                continue;
+
+            if (p != source && (!P_ClipPVSPortal(target, s->x1, s->y1, s->x2, s->y2, &t0, &t1)
+                || !P_ClipPVSSeparators(target, sourceline, passline, &t0, &t1)))
+                continue;
+
+            // round outwards so that each portal can only grow so many times
+            t0 = floor(t0 * PVSSNAP) / PVSSNAP;
+            t1 = ceil(t1 * PVSSNAP) / PVSSNAP;
+
+            if (pvsstamp[t] != source)
+            {
+                pvsstamp[t] = source;
+                pvst0[t] = t0;
+                pvst1[t] = t1;
+            }
+            else if (t0 >= pvst0[t] && t1 <= pvst1[t])
+                continue;
+            else
+            {
+                pvst0[t] = MIN(pvst0[t], t0);
+                pvst1[t] = MAX(pvst1[t], t1);
+            }
+
+            if (!pvsqueued[t])
+            {
+                pvsqueue[(head + count++) % numpvsportals] = t;
+                pvsqueued[t] = true;
+            }
+        }
+    }
+
+    return true;
+}
+
+static dboolean P_BuildPVS(void)
+{
+    int         i;
+    int64_t     steps = 0;
+    dboolean    result = true;
+
+    numpvsportals = 0;
+
+    for (i = 0; i < numlines; i++)
+        if (lines[i].frontsector && lines[i].backsector && lines[i].frontsector != lines[i].backsector)
+            numpvsportals += 2;
+
+    pvsportals = malloc(MAX(1, numpvsportals) * sizeof(*pvsportals));
+    pvsfirstportal = calloc(numsectors + 1, sizeof(*pvsfirstportal));
+    pvssectorportals = malloc(MAX(1, numpvsportals) * sizeof(*pvssectorportals));
+    pvst0 = malloc(MAX(1, numpvsportals) * sizeof(*pvst0));
+    pvst1 = malloc(MAX(1, numpvsportals) * sizeof(*pvst1));
+    pvsstamp = malloc(MAX(1, numpvsportals) * sizeof(*pvsstamp));
+    pvsqueue = malloc(MAX(1, numpvsportals) * sizeof(*pvsqueue));
+    pvsqueued = calloc(MAX(1, numpvsportals), sizeof(*pvsqueued));
+
+    numpvsportals = 0;
+
+    for (i = 0; i < numlines; i++)
+    {
+        const line_t    *line = lines + i;
+        pvsportal_t     *portal;
+
+        if (!line->frontsector || !line->backsector || line->frontsector == line->backsector)
+            continue;
+
+        // from the front sector into the back sector...
+        portal = pvsportals + numpvsportals++;
+        portal->x1 = line->v1->x / (double)FRACUNIT;
+        portal->y1 = line->v1->y / (double)FRACUNIT;
+        portal->x2 = line->v2->x / (double)FRACUNIT;
+        portal->y2 = line->v2->y / (double)FRACUNIT;
+        portal->line = i;
+        portal->sector = (int)(line->backsector - sectors);
+        pvsfirstportal[line->frontsector - sectors + 1]++;
+
+        // ...and back again
+        portal = pvsportals + numpvsportals++;
+        portal->x1 = line->v2->x / (double)FRACUNIT;
+        portal->y1 = line->v2->y / (double)FRACUNIT;
+        portal->x2 = line->v1->x / (double)FRACUNIT;
+        portal->y2 = line->v1->y / (double)FRACUNIT;
+        portal->line = i;
+        portal->sector = (int)(line->frontsector - sectors);
+        pvsfirstportal[line->backsector - sectors + 1]++;
+    }
+
+    for (i = 0; i < numsectors; i++)
+        pvsfirstportal[i + 1] += pvsfirstportal[i];
+
+    for (i = 0; i < numpvsportals; i++)
+    {
+        const line_t    *line = lines + pvsportals[i].line;
+        const int       from = (int)((i & 1 ? line->backsector : line->frontsector) - sectors);
+
+        pvssectorportals[pvsfirstportal[from]++] = i;
+        pvsstamp[i] = -1;
+    }
+
+    // pvsfirstportal[] now points to the end of each sector's portals, so shift it back
+    for (i = numsectors; i > 0; i--)
+        pvsfirstportal[i] = pvsfirstportal[i - 1];
+
+    pvsfirstportal[0] = 0;
+
+    for (i = 0; i < numsectors && result; i++)
+    {
+        const int   pnum = i * numsectors + i;
+        int         j;
+
+        pvsmatrix[pnum >> 3] |= 1 << (pnum & 7);
+
+        for (j = pvsfirstportal[i]; j < pvsfirstportal[i + 1]; j++)
+            if (!P_FlowPVSPortal(pvssectorportals[j], i, &steps))
+            {
+                result = false;
+                break;
+            }
+    }
+
+    free(pvsportals);
+    free(pvsfirstportal);
+    free(pvssectorportals);
+    free(pvst0);
+    free(pvst1);
+    free(pvsstamp);
+    free(pvsqueue);
+    free(pvsqueued);
+
+    return result;
+}
+
+void P_LoadPVS(void)
+{
+    const int   size = (numsectors * numsectors + 7) / 8;
+    char        *folder;
+    char        filename[MAX_PATH];
+    uint64_t    hash;
+    FILE        *file;
+    int         starttime;
+
+    free(pvsmatrix);
+    pvsmatrix = NULL;
+    pvsviewsector = -1;
+
+    if (!r_pvs || !numsectors)
+        return;
+
+    folder = M_StringJoin(M_GetAppDataFolder(), DIR_SEPARATOR_S, "pvs", NULL);
+    M_MakeDirectory(folder);
+    hash = P_HashPVS();
+    M_snprintf(filename, sizeof(filename), "%s"DIR_SEPARATOR_S"%08X%08X.pvs", folder,
+        (unsigned int)(hash >> 32), (unsigned int)hash);
+    free(folder);
+
+    pvsmatrix = calloc(size, 1);
+
+    // use the PVS built for this map before if there is one
+    if ((file = fopen(filename, "rb")))
+    {
+        const dboolean  result = (fread(pvsmatrix, 1, size, file) == size && fgetc(file) == EOF);
+
+        fclose(file);
+
+        if (result)
+            return;
+
+        memset(pvsmatrix, 0, size);
+    }
+
+    starttime = I_GetTimeMS();
+
+    if (!P_BuildPVS())
+    {
+        C_Warning("A PVS couldn't be built for this map.");
+        free(pvsmatrix);
+        pvsmatrix = NULL;
+        return;
+    }
+
+    C_Output("A PVS was built for this map in %s milliseconds.", commify(I_GetTimeMS() - starttime));
+
+    if ((file = fopen(filename, "wb")))
+    {
+        fwrite(pvsmatrix, 1, size, file);
+        fclose(file);
+    }
+}
+
 //
 // P_GroupLines
 // Builds sector line lists and subsector sector numbers.
@@ -2184,6 +2639,7 @@ void P_SetupLevel(int ep, int map)
 
     idclev = false;
 
+    AM_WaitForExternalAutomap();
     Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
 
     if (rejectlump != -1)
@@ -2271,15 +2727,20 @@ void P_SetupLevel(int ep, int map)
         P_LoadSegs(lumpnum + ML_SEGS);
     }
 
+    P_PackNodes();
+
     // reject loading and underflow padding separated out into new function
     // P_GroupLines modified to return a number the underflow padding needs
     P_LoadReject(lumpnum, P_GroupLines());
 
+    P_LoadPVS();
+
     P_RemoveSlimeTrails();
 
     P_CalcSegsLength();
 
-    r_bloodsplats_total = 0;
+    P_ClearBloodSplats();
+    P_ClearMovers();
 
     pathpointnum = 0;
     pathpointnum_max = 0;
@@ -2301,6 +2762,7 @@ void P_SetupLevel(int ep, int map)
 
     // preload graphics
     R_PrecacheLevel();
+    R_ResetPlaneStats();
 
     S_Start();
 
@@ -43,6 +43,7 @@ extern dboolean skipblstart;    // MaxW: Skip initial blocklist short
 
 void P_SetupLevel(int ep, int map);
 void P_MapName(int ep, int map);
+void P_LoadPVS(void);
 
 // Called by startup code.
 void P_Init(void);
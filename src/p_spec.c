@@ -125,6 +125,7 @@ static void P_SpawnPushers(void);       // phares 3/20/98
 extern char     *playername;
 extern int      numflats;
 extern dboolean canmodify;
+extern dboolean r_liquid_current;
 
 dboolean        *isliquid;
 dboolean        *isteleport;
@@ -1955,6 +1956,18 @@ void P_UpdateSpecials(void)
     if (animatedliquidyoffs > 64 * FRACUNIT)
         animatedliquidyoffs = 0;
 
+    if (r_liquid_current)
+        for (i = 0; i < numsectors; i++)
+        {
+            sector_t    *sector = sectors + i;
+
+            if (sector->isliquid && sector->heightsec == -1)
+            {
+                sector->floor_xoffs = animatedliquidxoffs;
+                sector->floor_yoffs = animatedliquidyoffs;
+            }
+        }
+
     skycolumnoffset += skyscrolldelta;
 
     // DO BUTTONS
@@ -46,6 +46,14 @@
 int     leveltime;
 int     stat_time = 0;
 
+sector_t        **movingsectors;
+int             nummovingsectors;
+static int      maxmovingsectors;
+
+mobj_t          **movingmobjs;
+int             nummovingmobjs;
+static int      maxmovingmobjs;
+
 //
 // THINKERS
 // All thinkers should be allocated by Z_Malloc
@@ -229,6 +237,90 @@ static void P_RunThinkers(void)
     T_MAPMusic();
 }
 
+//
+// P_AddMovingSector
+// Called whenever a sector's floor or ceiling moves, so the renderer only
+// needs to interpolate the sectors that are actually moving.
+//
+void P_AddMovingSector(sector_t *sector)
+{
+    if (sector->moving)
+        return;
+
+    if (nummovingsectors == maxmovingsectors)
+    {
+        maxmovingsectors = (maxmovingsectors ? maxmovingsectors * 2 : 64);
+        movingsectors = realloc(movingsectors, maxmovingsectors * sizeof(*movingsectors));
+    }
+
+    sector->moving = true;
+    movingsectors[nummovingsectors++] = sector;
+}
+
+//
+// P_UpdateMovers
+// Called at the end of each tic. Sectors that didn't move during the tic are
+// snapped to their final heights and dropped from the list, and the list of
+// mobjs to interpolate is rebuilt from those that have moved. Mobjs can be
+// moved by other thinkers (such as by P_ChangeSector()), so they are checked
+// here rather than as they think.
+//
+static void P_UpdateMovers(void)
+{
+    int         i = 0;
+    thinker_t   *th;
+
+    while (i < nummovingsectors)
+    {
+        sector_t    *sector = movingsectors[i];
+
+        if (sector->oldgametic != gametic)
+        {
+            sector->interpfloorheight = sector->floorheight;
+            sector->interpceilingheight = sector->ceilingheight;
+            sector->moving = false;
+            movingsectors[i] = movingsectors[--nummovingsectors];
+        }
+        else
+            i++;
+    }
+
+    nummovingmobjs = 0;
+
+    for (th = thinkerclasscap[th_mobj].cnext; th != &thinkerclasscap[th_mobj]; th = th->cnext)
+    {
+        mobj_t  *mo = (mobj_t *)th;
+
+        if (mo->interp && (mo->x != mo->oldx || mo->y != mo->oldy || mo->z != mo->oldz))
+        {
+            if (nummovingmobjs == maxmovingmobjs)
+            {
+                maxmovingmobjs = (maxmovingmobjs ? maxmovingmobjs * 2 : 256);
+                movingmobjs = realloc(movingmobjs, maxmovingmobjs * sizeof(*movingmobjs));
+            }
+
+            movingmobjs[nummovingmobjs++] = mo;
+        }
+        else
+        {
+            mo->interpx = mo->x;
+            mo->interpy = mo->y;
+            mo->interpz = mo->z;
+        }
+    }
+}
+
+//
+// P_ClearMovers
+// Called when a map or savegame is loaded, once the sectors and mobjs the lists
+// pointed to are gone.
+//
+void P_ClearMovers(void)
+{
+    nummovingsectors = 0;
+    nummovingmobjs = 0;
+}
+
 //
 // P_Ticker
 //
@@ -245,6 +337,7 @@ void P_Ticker(void)
     P_RespawnSpecials();
 
     P_MapEnd();
+    P_UpdateMovers();
 
     // for par times
     leveltime++;
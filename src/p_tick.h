@@ -45,6 +45,16 @@
 
 void P_Ticker(void);
 
+// Sectors and mobjs that moved during the last tic, and so need to be
+// interpolated by the renderer.
+extern sector_t         **movingsectors;
+extern int              nummovingsectors;
+extern mobj_t           **movingmobjs;
+extern int              nummovingmobjs;
+
+void P_AddMovingSector(sector_t *sector);
+void P_ClearMovers(void);
+
 void P_InitThinkers(void);
 void P_AddThinker(thinker_t *thinker);
 void P_RemoveThinker(thinker_t *thinker);
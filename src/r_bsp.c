@@ -40,21 +40,48 @@
 
 #include "doomstat.h"
 #include "m_bbox.h"
+#include "p_local.h"
 #include "r_main.h"
 #include "r_plane.h"
 #include "r_things.h"
+#include "z_zone.h"
 
-seg_t           *curline;
-side_t          *sidedef;
-line_t          *linedef;
-sector_t        *frontsector;
-sector_t        *backsector;
+THREADLOCAL seg_t           *curline;
+THREADLOCAL side_t          *sidedef;
+THREADLOCAL line_t          *linedef;
+THREADLOCAL sector_t        *frontsector;
+THREADLOCAL sector_t        *backsector;
 
-dboolean        doorclosed;
+THREADLOCAL dboolean        doorclosed;
 
-drawseg_t       *drawsegs;
-unsigned int    maxdrawsegs;
-drawseg_t       *ds_p;
+THREADLOCAL drawseg_t       *drawsegs;
+THREADLOCAL unsigned int    maxdrawsegs;
+THREADLOCAL drawseg_t       *ds_p;
+
+// Each rendering thread walks the entire BSP tree, so it keeps its own copy of
+// sector_t.validcount to make sure the sprites in each sector are only added once.
+static THREADLOCAL int      *sectorvalidcount;
+static THREADLOCAL int      numsectorvalidcount;
+
+// Each vertex is shared by several segs, so the angle to it from the viewpoint is
+// only calculated once a frame, and kept along with the validcount it was calculated for.
+typedef struct
+{
+    int                     validcount;
+    angle_t                 angle;
+} vertexcache_t;
+
+static THREADLOCAL vertexcache_t    *vertexcache;
+static THREADLOCAL int      numvertexcache;
+static THREADLOCAL uint64_t vertexcachehits;
+static THREADLOCAL uint64_t vertexcachemisses;
+
+// If there is a PVS for the current map, whether each node in packednodes[] has a
+// subsector below it that might be seen from the sector the viewpoint is in.
+static byte                 *pvsnodes;
+static int                  numpvsnodes;
+
+int                         pvsviewsector = -1;
 
 void R_StoreWallRange(int start, int stop);
 
@@ -64,6 +91,125 @@ void R_StoreWallRange(int start, int stop);
 void R_ClearDrawSegs(void)
 {
     ds_p = drawsegs;
+
+    if (numsectorvalidcount < numsectors)
+    {
+        sectorvalidcount = Z_Realloc(sectorvalidcount, numsectors * sizeof(*sectorvalidcount));
+        memset(sectorvalidcount + numsectorvalidcount, 0,
+            (numsectors - numsectorvalidcount) * sizeof(*sectorvalidcount));
+        numsectorvalidcount = numsectors;
+    }
+
+    if (numvertexcache < numvertexes)
+    {
+        vertexcache = Z_Realloc(vertexcache, numvertexes * sizeof(*vertexcache));
+        memset(vertexcache + numvertexcache, 0, (numvertexes - numvertexcache) * sizeof(*vertexcache));
+        numvertexcache = numvertexes;
+    }
+}
+
+//
+// R_FreeDrawSegs
+// Called by each rendering thread before it exits, to free its own buffers.
+//
+void R_FreeDrawSegs(void)
+{
+    free(drawsegs);
+    drawsegs = ds_p = NULL;
+    maxdrawsegs = 0;
+
+    free(sectorvalidcount);
+    sectorvalidcount = NULL;
+    numsectorvalidcount = 0;
+
+    free(vertexcache);
+    vertexcache = NULL;
+    numvertexcache = 0;
+}
+
+//
+// R_VertexAngle
+// The angle from the viewpoint to a vertex, as returned by R_PointToAngleEx().
+//
+static angle_t R_VertexAngle(const vertex_t *v)
+{
+    vertexcache_t   *cache = &vertexcache[v - vertexes];
+
+    if (cache->validcount == validcount)
+    {
+        vertexcachehits++;
+        return cache->angle;
+    }
+
+    vertexcachemisses++;
+    cache->validcount = validcount;
+    return (cache->angle = R_PointToAngleEx(v->x, v->y));
+}
+
+//
+// R_UpdateVertexCacheStats
+// Add this thread's vertex cache hits and misses to the totals shown by renderstats.
+//
+void R_UpdateVertexCacheStats(void)
+{
+    R_LockRenderCache();
+    renderstats.vertexcachehits += vertexcachehits;
+    renderstats.vertexcachemisses += vertexcachemisses;
+    R_UnlockRenderCache();
+
+    vertexcachehits = 0;
+    vertexcachemisses = 0;
+}
+
+static __inline dboolean R_SubsectorPotentiallyVisible(int num)
+{
+    const int   pnum = pvsviewsector * numsectors + (int)(subsectors[num].sector - sectors);
+
+    return (pvsmatrix[pnum >> 3] & (1 << (pnum & 7)));
+}
+
+//
+// R_UpdatePVS
+// Find which nodes have a subsector below them that might be seen from the sector
+// the viewpoint is in, whenever that sector changes. The children of each node in
+// packednodes[] are always before it.
+//
+void R_UpdatePVS(void)
+{
+    int sector;
+    int i;
+
+    if (!pvsmatrix)
+        return;
+
+    sector = (int)(R_PointInSubsector(viewx, viewy)->sector - sectors);
+
+    if (sector == pvsviewsector && numpvsnodes >= numnodes)
+        return;
+
+    pvsviewsector = sector;
+
+    if (numpvsnodes < numnodes)
+    {
+        pvsnodes = Z_Realloc(pvsnodes, numnodes * sizeof(*pvsnodes));
+        numpvsnodes = numnodes;
+    }
+
+    for (i = 0; i < numnodes; i++)
+    {
+        const int   *children = packednodes[i].children;
+        int         j;
+
+        pvsnodes[i] = false;
+
+        for (j = 0; j < 2; j++)
+            if (!(children[j] & NF_SUBSECTOR))
+                // a corrupt child can't be ruled out, so leave it to be walked as before
+                pvsnodes[i] |= (children[j] < numnodes ? pvsnodes[children[j]] : true);
+            else
+                pvsnodes[i] |= R_SubsectorPotentiallyVisible(children[j] == -1 ? 0 :
+                    (children[j] & ~NF_SUBSECTOR));
+    }
 }
 
 //
@@ -93,11 +239,11 @@ typedef struct
 // have anything to do with visplanes, but it had everything to do with these
 // clip posts.
 
-#define MAXSEGS (SCREENWIDTH / 2 + 1)
+#define MAXSEGS (MAXSCREENWIDTH / 2 + 1)
 
 // newend is one past the last valid seg
-static cliprange_t      *newend;
-static cliprange_t      solidsegs[MAXSEGS];
+static THREADLOCAL cliprange_t  *newend;
+static THREADLOCAL cliprange_t  solidsegs[MAXSEGS];
 
 //
 // R_ClipSolidWallSegment
@@ -256,32 +402,6 @@ dboolean R_DoorClosed(void)
             || frontsector->ceilingpic != skyflatnum));
 }
 
-// [AM] Interpolate the passed sector, if prudent.
-void R_MaybeInterpolateSector(sector_t *sector)
-{
-    if (vid_capfps != TICRATE
-        // Only if we moved the sector last tic.
-        && sector->oldgametic == gametic - 1)
-    {
-        // Interpolate between current and last floor/ceiling position.
-        if (sector->floorheight != sector->oldfloorheight)
-            sector->interpfloorheight = sector->oldfloorheight
-                + FixedMul(sector->floorheight - sector->oldfloorheight, fractionaltic);
-        else
-            sector->interpfloorheight = sector->floorheight;
-        if (sector->ceilingheight != sector->oldceilingheight)
-            sector->interpceilingheight = sector->oldceilingheight
-                + FixedMul(sector->ceilingheight - sector->oldceilingheight, fractionaltic);
-        else
-            sector->interpceilingheight = sector->ceilingheight;
-    }
-    else
-    {
-        sector->interpfloorheight = sector->floorheight;
-        sector->interpceilingheight = sector->ceilingheight;
-    }
-}
-
 //
 // killough 3/7/98: Hack floor/ceiling heights for deep water etc.
 //
@@ -400,12 +520,12 @@ static void R_AddLine(seg_t *line)
     int                 x2;
     angle_t             angle1;
     angle_t             angle2;
-    static sector_t     tempsec;        // killough 3/8/98: ceiling/water hack
+    static THREADLOCAL sector_t tempsec;    // killough 3/8/98: ceiling/water hack
 
     curline = line;
 
-    angle1 = R_PointToAngleEx(line->v1->x, line->v1->y);
-    angle2 = R_PointToAngleEx(line->v2->x, line->v2->y);
+    angle1 = R_VertexAngle(line->v1);
+    angle2 = R_VertexAngle(line->v2);
 
     // Back side? I.e. backface culling?
     if (angle1 - angle2 >= ANG180)
@@ -453,11 +573,6 @@ static void R_AddLine(seg_t *line)
     if (!backsector)
         goto clipsolid;
 
-    // [AM] Interpolate sector movement before
-    //      running clipping tests. Frontsector
-    //      should already be interpolated.
-    R_MaybeInterpolateSector(backsector);
-
     // killough 3/8/98, 4/4/98: hack for invisible ceilings / deep water
     backsector = R_FakeFlat(backsector, &tempsec, NULL, NULL, true);
 
@@ -528,7 +643,7 @@ static const int checkcoord[12][4] =
     { 2, 1, 3, 0 }
 };
 
-static dboolean R_CheckBBox(const fixed_t *bspcoord)
+dboolean R_CheckBBox(const fixed_t *bspcoord)
 {
     int         boxpos;
     const int   *check;
@@ -622,10 +737,6 @@ static void R_Subsector(int num)
 
     frontsector = sub->sector;
 
-    // [AM] Interpolate sector movement. Usually only needed
-    //      when you're standing inside the sector.
-    R_MaybeInterpolateSector(frontsector);
-
     // killough 3/8/98, 4/4/98: Deep water / fake ceiling effect
     frontsector = R_FakeFlat(frontsector, &tempsec, &floorlightlevel, &ceilinglightlevel, false);
 
@@ -662,9 +773,9 @@ static void R_Subsector(int num)
     // Either you must pass the fake sector and handle validcount here, on the
     // real sector, or you must account for the lighting in some other way,
     // like passing it as an argument.
-    if (sub->sector->validcount != validcount)
+    if (sectorvalidcount[sub->sector - sectors] != validcount)
     {
-        sub->sector->validcount = validcount;
+        sectorvalidcount[sub->sector - sectors] = validcount;
         R_AddSprites(sub->sector, (frontsector->ceilingpic == skyflatnum
             && !(frontsector->sky & PL_SKYFLAT) ? (ceilinglightlevel + floorlightlevel) / 2 :
             floorlightlevel));
@@ -683,19 +794,34 @@ void R_RenderBSPNode(int bspnum)
 {
     while (!(bspnum & NF_SUBSECTOR))    // Found a subsector?
     {
-        const node_t    *bsp = &nodes[bspnum];
+        const packednode_t  *bsp = packednodes + bspnum;
+        int                 side;
+
+        // Nothing below this node can be seen from the view sector.
+        if (pvsmatrix && !pvsnodes[bspnum])
+            return;
 
         // Decide which side the view point is on.
-        int             side = R_PointOnSide(viewx, viewy, bsp);
+        side = R_PointOnSide(viewx, viewy, bsp);
+
+        // Start fetching the back space while the front space is divided.
+        if (!(bsp->children[side ^ 1] & NF_SUBSECTOR))
+            PREFETCH(packednodes + bsp->children[side ^ 1]);
+
+        PREFETCH(packednodebboxes[bspnum][side ^ 1]);
 
         // Recursively divide front space.
         R_RenderBSPNode(bsp->children[side]);
 
         // Possibly divide back space.
-        if (!R_CheckBBox(bsp->bbox[side ^= 1]))
+        if (!R_CheckBBox(packednodebboxes[bspnum][side ^= 1]))
             return;
 
         bspnum = bsp->children[side];
     }
-    R_Subsector(bspnum == -1 ? 0 : (bspnum & ~NF_SUBSECTOR));
+
+    bspnum = (bspnum == -1 ? 0 : (bspnum & ~NF_SUBSECTOR));
+
+    if (!pvsmatrix || R_SubsectorPotentiallyVisible(bspnum))
+        R_Subsector(bspnum);
 }
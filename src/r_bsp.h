@@ -39,22 +39,29 @@
 #if !defined(__R_BSP_H__)
 #define __R_BSP_H__
 
-extern seg_t            *curline;
-extern side_t           *sidedef;
-extern line_t           *linedef;
-extern sector_t         *frontsector;
-extern sector_t         *backsector;
+extern THREADLOCAL seg_t        *curline;
+extern THREADLOCAL side_t       *sidedef;
+extern THREADLOCAL line_t       *linedef;
+extern THREADLOCAL sector_t     *frontsector;
+extern THREADLOCAL sector_t     *backsector;
 
-extern drawseg_t        *drawsegs;
-extern unsigned int     maxdrawsegs;
+extern THREADLOCAL drawseg_t    *drawsegs;
+extern THREADLOCAL unsigned int maxdrawsegs;
 
-extern drawseg_t        *ds_p;
+extern THREADLOCAL drawseg_t    *ds_p;
+
+
+extern int                      pvsviewsector;
 
 // BSP?
 void R_ClearClipSegs(void);
 void R_ClearDrawSegs(void);
+void R_FreeDrawSegs(void);
+dboolean R_CheckBBox(const fixed_t *bspcoord);
 
 void R_RenderBSPNode(int bspnum);
+void R_UpdatePVS(void);
+void R_UpdateVertexCacheStats(void);
 dboolean R_DoorClosed(void);
 
 // killough 4/13/98: fake floors/ceilings for deep water / fake ceilings:
@@ -726,6 +726,8 @@ void R_PrecacheLevel(void)
     //  name.
     hitlist[skytexture] = 1;
 
+    R_SetMapTextureComposites(hitlist);
+
     for (i = 0; i < numtextures; i++)
         if (hitlist[i])
         {
@@ -118,7 +118,10 @@ typedef struct sector_s
     // list of mobjs in sector
     mobj_t              *thinglist;
 
-    bloodsplat_t        *splatlist;
+    // blood splats in sector, oldest first, as indices into bloodsplatpool[]
+    int                 splatfirst;
+    int                 splatlast;
+    fixed_t             splatbbox[4];
 
     // thinker_t for reversible actions
     void                *floordata;             // jff 2/22/98 make thinkers on
@@ -132,9 +135,6 @@ typedef struct sector_s
     int                 linecount;
     struct line_s       **lines;                // [linecount] size
 
-    int                 cachedheight;
-    int                 scaleindex;
-
     // [AM] Previous position of floor and ceiling before
     //      think. Used to interpolate between positions.
     fixed_t             oldfloorheight;
@@ -147,6 +147,9 @@ typedef struct sector_s
     //      if old values were not updated recently.
     int                 oldgametic;
 
+    // true while the sector is on the moving sector list
+    dboolean            moving;
+
     // [AM] Interpolated floor and ceiling height.
     //      Calculated once per tic and used inside
     //      the renderer.
@@ -783,6 +786,28 @@ typedef struct
     int                 children[2];
 } node_t;
 
+//
+// Packed BSP node.
+// P_PackNodes() copies the partition line and children of each node_t into
+//  packednodes[], in depth-first order from the root down, with the front child
+//  of each node just before it. The root is still the last node. The bounding
+//  boxes, which are only needed for nodes that aren't culled, are kept apart in
+//  packednodebboxes[], in the same order.
+//
+typedef struct
+{
+    // Partition line.
+    fixed_t             x;
+    fixed_t             y;
+    fixed_t             dx;
+    fixed_t             dy;
+
+    // Index into packednodes[], or if NF_SUBSECTOR its a subsector.
+    int                 children[2];
+} packednode_t;
+
+typedef fixed_t         nodebbox_t[2][4];
+
 #if defined(_MSC_VER) || defined(__GNUC__)
 #pragma pack(push, 1)
 #endif
@@ -968,19 +993,10 @@ typedef struct visplane_s
     fixed_t             height;
     fixed_t             xoffs, yoffs;   // killough 2/28/98: Support scrolling flats
 
-    // leave pads for [minx-1]/[maxx+1]
-    unsigned short      pad1;
-
-    // Here lies the rub for all
-    //  dynamic resize/change of resolution.
-    unsigned short      top[SCREENWIDTH];
-
-    unsigned short      pad2;
-    unsigned short      pad3;
-
-    unsigned short      bottom[SCREENWIDTH];
-
-    unsigned short      pad4;
+    // SCREENWIDTH entries each, allocated together by new_visplane()
+    //  with pads for [minx-1]/[maxx+1]
+    unsigned short      *top;
+    unsigned short      *bottom;
 
     sector_t            *sector;        // [BH] Support animated liquid sectors
 } visplane_t;
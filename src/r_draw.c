@@ -37,11 +37,29 @@
 */
 
 #include "c_console.h"
+#include "m_config.h"
 #include "r_local.h"
 #include "st_stuff.h"
 #include "v_video.h"
+#include "w_wad.h"
 #include "z_zone.h"
 
+// SSE2 and AVX2 versions of the wall column and span drawers are available on x86 and x64.
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SIMDDRAWERS
+
+#include <immintrin.h>
+
+// GCC and Clang need to be told which instructions each drawer may use.
+#if defined(_MSC_VER)
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2     __attribute__((target("sse2")))
+#define TARGET_AVX2     __attribute__((target("avx2")))
+#endif
+#endif
+
 //
 // All drawing to the view buffer is accomplished in this file.
 // The other refresh files only know about coordinates,
@@ -54,14 +72,20 @@
 int     viewwidth;
 int     scaledviewwidth;
 int     viewheight;
+int     scaledviewheight;
 int     viewheight2;
 int     viewwindowx;
 int     viewwindowy;
-int     fuzztable[SCREENWIDTH * SCREENHEIGHT];
+int     fuzztable[MAXSCREENWIDTH * MAXSCREENHEIGHT];
 
 byte    *topleft0;
 byte    *topleft1;
 
+// The distance between vertically (dc_pitch) and horizontally (ds_pitch) adjacent
+//  pixels in the buffer that the 3D view is being drawn into.
+int     dc_pitch;
+int     ds_pitch;
+
 // Color tables for different players,
 //  translate a limited part to another
 //  (color ramps used for  suit colors).
@@ -152,20 +176,20 @@ byte megasphere[] =
 // R_DrawColumn
 // Source is the top of the column to scale.
 //
-lighttable_t    *dc_colormap;
-int             dc_x;
-int             dc_yl;
-int             dc_yh;
-fixed_t         dc_iscale;
-fixed_t         dc_texturemid;
-fixed_t         dc_texheight;
-fixed_t         dc_texturefrac;
-byte            *dc_blood;
-byte            *dc_colormask;
-int             dc_baseclip;
+THREADLOCAL lighttable_t    *dc_colormap;
+THREADLOCAL int             dc_x;
+THREADLOCAL int             dc_yl;
+THREADLOCAL int             dc_yh;
+THREADLOCAL fixed_t         dc_iscale;
+THREADLOCAL fixed_t         dc_texturemid;
+THREADLOCAL fixed_t         dc_texheight;
+THREADLOCAL fixed_t         dc_texturefrac;
+THREADLOCAL byte            *dc_blood;
+THREADLOCAL byte            *dc_colormask;
+THREADLOCAL int             dc_baseclip;
 
 // first pixel in a column (possibly virtual)
-byte            *dc_source;
+THREADLOCAL byte            *dc_source;
 
 extern int      skycolor;
 
@@ -177,35 +201,166 @@ extern int      skycolor;
 //  be used. It has also been used with Wolfenstein 3D.
 //
 
-void R_DrawColumn(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-
-    while (--count)
-    {
-        *dest = colormap[source[frac >> FRACBITS]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
+//
+// Most of the column drawers below differ only in the table they blend with,
+//  whether each texel is remapped (from red to blue, for example) before it is
+//  lit, whether it is lit before or after it is blended, and (for walls and the
+//  sky) whether the brightmap is applied. Rather than each being written out by
+//  hand, they are all generated from the two kernels that follow.
+// Each kernel is given the address and pitch to draw to, so that the same code
+//  can also draw into the quad-column buffer (see R_DrawQuadWallColumn()).
+//
+#define BLEND_NONE      0       // colormap[texel]
+#define BLEND_LIT       1       // translucency[(*dest << 8) + colormap[texel]]
+#define BLEND_UNLIT     2       // colormap[translucency[(*dest << 8) + texel]]
+
+#define TEXEL(dot)      (dot)
+#define REDTOBLUE(dot)  redtoblue[dot]
+#define REDTOGREEN(dot) redtogreen[dot]
+#define MEGASPHERE(dot) megasphere[dot]
+
+#define COLUMNPIXEL(blend, remap, dot)                                                      \
+    (blend == BLEND_LIT ? translucency[(*dest << 8) + colormap[remap(dot)]] :               \
+    (blend == BLEND_UNLIT ? colormap[translucency[(*dest << 8) + remap(dot)]] :             \
+    colormap[remap(dot)]))
+
+#define DRAWCOLUMN(name, blend, table, remap)                                               \
+static __inline void name##Kernel(byte *dest, const int pitch)                             \
+{                                                                                           \
+    int                 count = dc_yh - dc_yl + 1;                                          \
+    fixed_t             frac = dc_texturefrac;                                              \
+    const fixed_t       fracstep = dc_iscale;                                               \
+    const byte          *source = dc_source;                                                \
+    const lighttable_t  *colormap = dc_colormap;                                            \
+    const byte          *translucency = table;                                              \
+                                                                                            \
+    while (--count)                                                                         \
+    {                                                                                       \
+        *dest = COLUMNPIXEL(blend, remap, source[frac >> FRACBITS]);                        \
+        dest += pitch;                                                                      \
+        frac += fracstep;                                                                   \
+    }                                                                                       \
+                                                                                            \
+    *dest = COLUMNPIXEL(blend, remap, source[frac >> FRACBITS]);                            \
+}                                                                                           \
+                                                                                            \
+void name(void)                                                                             \
+{                                                                                           \
+    name##Kernel(topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch, dc_pitch);                  \
+}
 
-    *dest = colormap[source[frac >> FRACBITS]];
+// [BH] Apply the brightmap in dc_colormask to fullbright walls, and don't light the sky.
+#define WALLPIXEL(lit, fullbright, dot)                                                     \
+    (fullbright && colormask[dot] ? dot : (lit ? colormap[dot] : dot))
+
+#define WALLSTEP(lit, fullbright)                                                           \
+    dot = source[(frac >> FRACBITS) & heightmask];                                          \
+    *dest = WALLPIXEL(lit, fullbright, dot);                                                \
+    dest += pitch;                                                                          \
+    frac += fracstep
+
+#define DRAWWALLCOLUMN(name, lit, fullbright, sparklefix)                                   \
+/* texture height is a power-of-2, so do some loop unrolling */                            \
+static __inline void name##Pow2Kernel(byte *dest, const int pitch, int count, fixed_t frac, \
+    const fixed_t fracstep, const fixed_t heightmask)                                       \
+{                                                                                           \
+    const byte          *source = dc_source;                                                \
+    const byte          *colormask = dc_colormask;                                          \
+    const lighttable_t  *colormap = dc_colormap;                                            \
+    byte                dot;                                                                \
+                                                                                            \
+    while (count >= 8)                                                                      \
+    {                                                                                       \
+        WALLSTEP(lit, fullbright);                                                          \
+        WALLSTEP(lit, fullbright);                                                          \
+        WALLSTEP(lit, fullbright);                                                          \
+        WALLSTEP(lit, fullbright);                                                          \
+        WALLSTEP(lit, fullbright);                                                          \
+        WALLSTEP(lit, fullbright);                                                          \
+        WALLSTEP(lit, fullbright);                                                          \
+        WALLSTEP(lit, fullbright);                                                          \
+        count -= 8;                                                                         \
+    }                                                                                       \
+                                                                                            \
+    if (count & 1)                                                                          \
+    {                                                                                       \
+        WALLSTEP(lit, fullbright);                                                          \
+    }                                                                                       \
+                                                                                            \
+    if (count & 2)                                                                          \
+    {                                                                                       \
+        WALLSTEP(lit, fullbright);                                                          \
+        WALLSTEP(lit, fullbright);                                                          \
+    }                                                                                       \
+                                                                                            \
+    if (count & 4)                                                                          \
+    {                                                                                       \
+        WALLSTEP(lit, fullbright);                                                          \
+        WALLSTEP(lit, fullbright);                                                          \
+        WALLSTEP(lit, fullbright);                                                          \
+        WALLSTEP(lit, fullbright);                                                          \
+    }                                                                                       \
+}                                                                                           \
+                                                                                            \
+/* [SL] Properly tile textures whose heights are not a power-of-2, */                      \
+/* avoiding a tutti-frutti effect. From Eternity Engine. */                                 \
+static __inline void name##NonPow2Kernel(byte *dest, const int pitch, int count,           \
+    fixed_t frac, const fixed_t fracstep, const fixed_t texheight)                          \
+{                                                                                           \
+    const byte          *source = dc_source;                                                \
+    const byte          *colormask = dc_colormask;                                          \
+    const lighttable_t  *colormap = dc_colormap;                                            \
+    const fixed_t       heightmask = texheight << FRACBITS;                                 \
+    byte                dot;                                                                \
+                                                                                            \
+    if (frac < 0)                                                                           \
+        while ((frac += heightmask) < 0);                                                   \
+    else                                                                                    \
+        while (frac >= heightmask)                                                          \
+            frac -= heightmask;                                                             \
+                                                                                            \
+    while (count--)                                                                         \
+    {                                                                                       \
+        dot = source[frac >> FRACBITS];                                                     \
+        *dest = WALLPIXEL(lit, fullbright, dot);                                            \
+        dest += pitch;                                                                      \
+                                                                                            \
+        if ((frac += fracstep) >= heightmask)                                               \
+            frac -= heightmask;                                                             \
+    }                                                                                       \
+}                                                                                           \
+                                                                                            \
+static __inline void name##Kernel(byte *dest, const int pitch)                             \
+{                                                                                           \
+    const int           count = dc_yh - dc_yl + 1;                                          \
+    const fixed_t       iscale = dc_iscale;                                                 \
+    const fixed_t       frac = dc_texturemid + (dc_yl - centery) * iscale;                  \
+    const fixed_t       texheight = dc_texheight;                                           \
+                                                                                            \
+    if (texheight & (texheight - 1))                                                        \
+        name##NonPow2Kernel(dest, pitch, count, frac, iscale - sparklefix, texheight);     \
+    else                                                                                    \
+        name##Pow2Kernel(dest, pitch, count, frac, iscale - sparklefix, texheight - 1);    \
+}                                                                                           \
+                                                                                            \
+void name(void)                                                                             \
+{                                                                                           \
+    name##Kernel(topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch, dc_pitch);                  \
 }
 
+DRAWCOLUMN(R_DrawColumn, BLEND_NONE, NULL, TEXEL)
+
 void R_DrawColorColumn(void)
 {
     int         count = dc_yh - dc_yl + 1;
-    byte        *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
+    byte        *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int   pitch = dc_pitch;
     const byte  color = dc_colormap[NOTEXTURECOLOR];
 
     while (--count)
     {
         *dest = color;
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
 
     *dest = color;
@@ -214,17 +369,18 @@ void R_DrawColorColumn(void)
 void R_DrawShadowColumn(void)
 {
     int         count = dc_yh - dc_yl + 1;
-    byte        *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
+    byte        *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int   pitch = dc_pitch;
     const byte  *body = tinttab40;
     const byte  *edge = tinttab25;
 
     *dest = edge[*dest];
-    dest += SCREENWIDTH;
+    dest += pitch;
 
     while (--count)
     {
         *dest = body[*dest];
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
 
     *dest = edge[*dest];
@@ -233,18 +389,19 @@ void R_DrawShadowColumn(void)
 void R_DrawFuzzyShadowColumn(void)
 {
     int         count = dc_yh - dc_yl + 1;
-    byte        *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
+    byte        *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int   pitch = dc_pitch;
     const byte  *translucency = tinttab25;
 
     if (!(rand() % 4) && !consoleactive)
         *dest = translucency[*dest];
 
-    dest += SCREENWIDTH;
+    dest += pitch;
 
     while (--count)
     {
         *dest = translucency[*dest];
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
 
     if (!(rand() % 4) && !consoleactive)
@@ -254,12 +411,13 @@ void R_DrawFuzzyShadowColumn(void)
 void R_DrawSolidShadowColumn(void)
 {
     int         count = dc_yh - dc_yl + 1;
-    byte        *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
+    byte        *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int   pitch = dc_pitch;
 
     while (--count)
     {
         *dest = 0;
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
 
     *dest = 0;
@@ -268,13 +426,14 @@ void R_DrawSolidShadowColumn(void)
 void R_DrawBloodSplatColumn(void)
 {
     int         count = dc_yh - dc_yl + 1;
-    byte        *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
+    byte        *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int   pitch = dc_pitch;
     const byte  *blood = dc_blood;
 
     while (--count)
     {
         *dest = *(*dest + blood);
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
 
     *dest = *(*dest + blood);
@@ -283,235 +442,22 @@ void R_DrawBloodSplatColumn(void)
 void R_DrawSolidBloodSplatColumn(void)
 {
     int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
     const fixed_t       blood = *dc_blood;
 
     while (--count)
     {
         *dest = blood;
-        dest += SCREENWIDTH;
+        dest += pitch;
     }
 
     *dest = blood;
 }
 
-void R_DrawWallColumn(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    const fixed_t       iscale = dc_iscale;
-    fixed_t             frac = dc_texturemid + (dc_yl - centery) * iscale;
-    const fixed_t       fracstep = iscale - SPARKLEFIX;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const fixed_t       texheight = dc_texheight;
-    fixed_t             heightmask = texheight - 1;
-
-    // [SL] Properly tile textures whose heights are not a power-of-2,
-    // avoiding a tutti-frutti effect. From Eternity Engine.
-    if (texheight & heightmask)
-    {
-        heightmask++;
-        heightmask <<= FRACBITS;
-
-        if (frac < 0)
-            while ((frac += heightmask) < 0);
-        else
-            while (frac >= heightmask)
-                frac -= heightmask;
-
-        while (count--)
-        {
-            *dest = colormap[source[frac >> FRACBITS]];
-            dest += SCREENWIDTH;
-
-            if ((frac += fracstep) >= heightmask)
-                frac -= heightmask;
-        }
-    }
-    else
-    {
-        // texture height is a power-of-2
-        // do some loop unrolling
-        while (count >= 8)
-        {
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            count -= 8;
-        }
-
-        if (count & 1)
-        {
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-        }
-
-        if (count & 2)
-        {
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-        }
-
-        if (count & 4)
-        {
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
-        }
-    }
-}
-
-void R_DrawFullbrightWallColumn(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    const fixed_t       iscale = dc_iscale;
-    fixed_t             frac = dc_texturemid + (dc_yl - centery) * iscale;
-    const fixed_t       fracstep = iscale - SPARKLEFIX;
-    const byte          *source = dc_source;
-    const byte          *colormask = dc_colormask;
-    const lighttable_t  *colormap = dc_colormap;
-    const fixed_t       texheight = dc_texheight;
-    fixed_t             heightmask = texheight - 1;
-    byte                dot;
-
-    // [SL] Properly tile textures whose heights are not a power-of-2,
-    // avoiding a tutti-frutti effect. From Eternity Engine.
-    if (texheight & heightmask)
-    {
-        heightmask++;
-        heightmask <<= FRACBITS;
-
-        if (frac < 0)
-            while ((frac += heightmask) < 0);
-        else
-            while (frac >= heightmask)
-                frac -= heightmask;
-
-        while (count--)
-        {
-            dot = source[frac >> FRACBITS];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-
-            if ((frac += fracstep) >= heightmask)
-                frac -= heightmask;
-        }
-    }
-    else
-    {
-        // texture height is a power-of-2
-        // do some loop unrolling
-        while (count >= 8)
-        {
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            count -= 8;
-        }
-
-        if (count & 1)
-        {
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-        }
-
-        if (count & 2)
-        {
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-        }
+DRAWWALLCOLUMN(R_DrawWallColumn, true, false, SPARKLEFIX)
 
-        if (count & 4)
-        {
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            dot = source[(frac >> FRACBITS) & heightmask];
-            *dest = (colormask[dot] ? dot : colormap[dot]);
-        }
-    }
-}
+DRAWWALLCOLUMN(R_DrawFullbrightWallColumn, true, true, SPARKLEFIX)
 
 void R_DrawPlayerSpriteColumn(void)
 {
@@ -534,7 +480,8 @@ void R_DrawPlayerSpriteColumn(void)
 void R_DrawSuperShotgunColumn(void)
 {
     int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
     fixed_t             frac = dc_texturefrac;
     const fixed_t       fracstep = dc_iscale;
     const byte          *source = dc_source;
@@ -547,7 +494,7 @@ void R_DrawSuperShotgunColumn(void)
         if (dot != 71)
             *dest = colormap[dot];
 
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
 
@@ -557,7 +504,8 @@ void R_DrawSuperShotgunColumn(void)
 void R_DrawTranslucentSuperShotgunColumn(void)
 {
     int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
     fixed_t             frac = dc_texturefrac;
     const fixed_t       fracstep = dc_iscale;
     const byte          *source = dc_source;
@@ -571,867 +519,2337 @@ void R_DrawTranslucentSuperShotgunColumn(void)
         if (dot != 71)
             *dest = colormap[translucency[(*dest << 8) + dot]];
 
-        dest += SCREENWIDTH;
+        dest += pitch;
         frac += fracstep;
     }
 
     *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
 }
 
-void R_DrawSkyColumn(void)
+DRAWWALLCOLUMN(R_DrawSkyColumn, false, false, 0)
+
+void R_DrawFlippedSkyColumn(void)
 {
     int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
     const fixed_t       fracstep = dc_iscale;
     fixed_t             frac = dc_texturemid + (dc_yl - centery) * fracstep;
     const byte          *source = dc_source;
-    const fixed_t       texheight = dc_texheight;
-    fixed_t             heightmask = texheight - 1;
+    fixed_t             i;
 
-    // [SL] Properly tile textures whose heights are not a power-of-2,
-    // avoiding a tutti-frutti effect. From Eternity Engine.
-    if (texheight & heightmask)
+    while (--count)
     {
-        heightmask++;
-        heightmask <<= FRACBITS;
+        i = frac >> FRACBITS;
+        *dest = source[i > 127 ? 126 - (i & 127) : i];
+        dest += pitch;
+        frac += fracstep;
+    }
 
-        if (frac < 0)
-            while ((frac += heightmask) < 0);
-        else
-            while (frac >= heightmask)
-                frac -= heightmask;
+    i = frac >> FRACBITS;
+    *dest = source[i > 127 ? 126 - (i & 127) : i];
+}
 
-        while (count--)
-        {
-            *dest = source[frac >> FRACBITS];
-            dest += SCREENWIDTH;
+void R_DrawSkyColorColumn(void)
+{
+    int         count = dc_yh - dc_yl + 1;
+    byte        *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int   pitch = dc_pitch;
+    byte        color = skycolor;
 
-            if ((frac += fracstep) >= heightmask)
-                frac -= heightmask;
-        }
-    }
-    else
+    while (--count)
     {
-        // texture height is a power-of-2
-        // do some loop unrolling
-        while (count >= 8)
-        {
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
-            frac += fracstep;
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+        *dest = color;
+        dest += pitch;
+    }
+
+    *dest = color;
+}
+
+DRAWCOLUMN(R_DrawRedToBlueColumn, BLEND_NONE, NULL, REDTOBLUE)
+
+DRAWCOLUMN(R_DrawTranslucentRedToBlue33Column, BLEND_LIT, tinttab33, REDTOBLUE)
+
+DRAWCOLUMN(R_DrawRedToGreenColumn, BLEND_NONE, NULL, REDTOGREEN)
+
+DRAWCOLUMN(R_DrawTranslucentRedToGreen33Column, BLEND_LIT, tinttab33, REDTOGREEN)
+
+DRAWCOLUMN(R_DrawTranslucentColumn, BLEND_LIT, tinttab, TEXEL)
+
+DRAWCOLUMN(R_DrawTranslucent50Column, BLEND_LIT, tranmap, TEXEL)
+
+void R_DrawDitheredColumn(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale << 1;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tranmap;
+
+    if (((viewwindowy + dc_yl) & 1) == ((viewwindowx + dc_x) & 1))
+    {
+        dest += pitch;
+        frac += fracstep >> 1;
+
+        if (!--count)
+            return;
+    }
+
+    do
+    {
+        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+        dest += pitch << 1;
+        frac += fracstep;
+    } while ((count -= 2) > 0);
+}
+
+DRAWCOLUMN(R_DrawTranslucent33Column, BLEND_LIT, tinttab33, TEXEL)
+
+DRAWCOLUMN(R_DrawMegaSphereColumn, BLEND_LIT, tinttab33, MEGASPHERE)
+
+DRAWCOLUMN(R_DrawSolidMegaSphereColumn, BLEND_NONE, NULL, MEGASPHERE)
+
+DRAWCOLUMN(R_DrawTranslucentRedColumn, BLEND_LIT, tinttabred, TEXEL)
+
+DRAWCOLUMN(R_DrawTranslucentRedWhiteColumn1, BLEND_UNLIT, tinttabredwhite1, TEXEL)
+
+DRAWCOLUMN(R_DrawTranslucentRedWhiteColumn2, BLEND_UNLIT, tinttabredwhite2, TEXEL)
+
+DRAWCOLUMN(R_DrawTranslucentRedWhite50Column, BLEND_UNLIT, tinttabredwhite50, TEXEL)
+
+DRAWCOLUMN(R_DrawTranslucentGreenColumn, BLEND_LIT, tinttabgreen, TEXEL)
+
+DRAWCOLUMN(R_DrawTranslucentBlueColumn, BLEND_LIT, tinttabblue, TEXEL)
+
+DRAWCOLUMN(R_DrawTranslucentRed33Column, BLEND_UNLIT, tinttabred33, TEXEL)
+
+DRAWCOLUMN(R_DrawTranslucentGreen33Column, BLEND_UNLIT, tinttabgreen33, TEXEL)
+
+DRAWCOLUMN(R_DrawTranslucentBlue25Column, BLEND_UNLIT, tinttabblue25, TEXEL)
+
+//
+// Spectre/Invisibility.
+//
+// Offsets to the pixel above, the same pixel and the pixel below, in multiples
+//  of dc_pitch.
+int             fuzzrange[3] = { -1, 0, 1 };
+
+// The fuzz of each column is seeded from its position and the frame, rather than
+//  taken from rand(), and is kept in fuzztable[] at the position of each pixel on
+//  the screen. That way it comes out the same however many threads draw the view
+//  and in whatever order the columns are drawn.
+unsigned int                    fuzzframe;
+static THREADLOCAL unsigned int fuzzseed;
+
+static __inline int R_FuzzRandom(void)
+{
+    fuzzseed = fuzzseed * 1103515245 + 12345;
+    return ((fuzzseed >> 16) & 0x7FFF);
+}
+
+static __inline void R_SeedFuzz(void)
+{
+    fuzzseed = (unsigned int)dc_x * 0x9E3779B1 ^ (unsigned int)dc_yl * 0x85EBCA77
+        ^ (unsigned int)dc_yh * 0x27D4EB2F ^ fuzzframe * 0xC2B2AE3D;
+}
+
+#define FUZZ(a, b)      fuzzrange[R_FuzzRandom() % (b - a + 1) + a]
+#define NOFUZZ          251
+
+void R_DrawFuzzColumn(void)
+{
+    byte        *dest;
+    int         *fuzz;
+    int         count = dc_yh - dc_yl;
+    const int   pitch = dc_pitch;
+
+    if (count < 0)
+        return;
+
+    dest = topleft0 + dc_yl * pitch + dc_x * ds_pitch;
+    fuzz = fuzztable + (viewwindowy + dc_yl) * SCREENWIDTH + viewwindowx + dc_x;
+    R_SeedFuzz();
+
+    if (count)
+    {
+        // top
+        if (!dc_yl)
+            *dest = fullcolormap[6 * 256 + dest[(*fuzz = FUZZ(1, 2)) * pitch]];
+        else if (!(R_FuzzRandom() % 4))
+            *dest = fullcolormap[12 * 256 + dest[(*fuzz = FUZZ(0, 2)) * pitch]];
+        dest += pitch;
+        fuzz += SCREENWIDTH;
+
+        while (--count)
+        {
+            // middle
+            *dest = fullcolormap[6 * 256 + dest[(*fuzz = FUZZ(0, 2)) * pitch]];
+            dest += pitch;
+            fuzz += SCREENWIDTH;
+        }
+
+        // bottom
+        if (dc_yh == viewheight - 1)
+            *dest = fullcolormap[5 * 256 + dest[(*fuzz = FUZZ(0, 1)) * pitch]];
+        else if (dc_baseclip == -1 && !(R_FuzzRandom() % 4))
+            *dest = fullcolormap[14 * 256 + dest[(*fuzz = FUZZ(0, 1)) * pitch]];
+    }
+}
+
+void R_DrawPausedFuzzColumn(void)
+{
+    byte        *dest;
+    const int   *fuzz;
+    int         count = dc_yh - dc_yl;
+    const int   pitch = dc_pitch;
+
+    if (count < 0)
+        return;
+
+    dest = topleft0 + dc_yl * pitch + dc_x * ds_pitch;
+    fuzz = fuzztable + (viewwindowy + dc_yl) * SCREENWIDTH + viewwindowx + dc_x;
+
+    if (count)
+    {
+        // top
+        if (!dc_yl)
+            *dest = fullcolormap[6 * 256 + dest[*fuzz * pitch]];
+        dest += pitch;
+        fuzz += SCREENWIDTH;
+
+        while (--count)
+        {
+            // middle
+            *dest = fullcolormap[6 * 256 + dest[*fuzz * pitch]];
+            dest += pitch;
+            fuzz += SCREENWIDTH;
+        }
+
+        // bottom
+        if (dc_yh == viewheight - 1)
+            *dest = fullcolormap[5 * 256 + dest[*fuzz * pitch]];
+    }
+}
+
+void R_DrawFuzzColumns(void)
+{
+    int         x, y;
+    int         w = viewwindowx + viewwidth;
+    int         h = (viewwindowy + viewheight) * SCREENWIDTH;
+
+    for (x = viewwindowx; x < w; x++)
+        for (y = viewwindowy * SCREENWIDTH; y < h; y += SCREENWIDTH)
+        {
+            int         i = x + y;
+            byte        *src = screens[1] + i;
+
+            if (*src != NOFUZZ)
+            {
+                byte    *dest = screens[0] + i;
+
+                if (!y || *(src - SCREENWIDTH) == NOFUZZ)
+                {
+                    // top
+                    if (!(rand() % 4))
+                        *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2)) * SCREENWIDTH]];
+                }
+                else if (y == h - SCREENWIDTH)
+                {
+                    // bottom of view
+                    *dest = fullcolormap[5 * 256 + dest[(fuzztable[i] = FUZZ(0, 1)) * SCREENWIDTH]];
+                }
+                else if (*(src + SCREENWIDTH) == NOFUZZ)
+                {
+                    // bottom of post
+                    if (!(rand() % 4))
+                        *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2)) * SCREENWIDTH]];
+                }
+                else
+                {
+                    // middle
+                    if (*(src - 1) == NOFUZZ || *(src + 1) == NOFUZZ)
+                    {
+                        if (!(rand() % 4))
+                            *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2)) * SCREENWIDTH]];
+                    }
+                    else
+                        *dest = fullcolormap[6 * 256 + dest[(fuzztable[i] = FUZZ(0, 2)) * SCREENWIDTH]];
+                }
+            }
+        }
+}
+
+void R_DrawPausedFuzzColumns(void)
+{
+    int         x, y;
+    int         w = viewwindowx + viewwidth;
+    int         h = (viewwindowy + viewheight) * SCREENWIDTH;
+
+    for (x = viewwindowx; x < w; x++)
+        for (y = viewwindowy * SCREENWIDTH; y < h; y += SCREENWIDTH)
+        {
+            int         i = x + y;
+            byte        *src = screens[1] + i;
+
+            if (*src != NOFUZZ)
+            {
+                byte    *dest = screens[0] + i;
+
+                if (!y || *(src - SCREENWIDTH) == NOFUZZ)
+                {
+                    // top
+                    // do nothing
+                }
+                else if (y == h - SCREENWIDTH)
+                {
+                    // bottom of view
+                    *dest = fullcolormap[5 * 256 + dest[fuzztable[i] * SCREENWIDTH]];
+                }
+                else if (*(src + SCREENWIDTH) == NOFUZZ)
+                {
+                    // bottom of post
+                    // do nothing
+                }
+                else
+                {
+                    // middle
+                    if (*(src - 1) == NOFUZZ || *(src + 1) == NOFUZZ)
+                    {
+                        // do nothing
+                    }
+                    else
+                        *dest = fullcolormap[6 * 256 + dest[fuzztable[i] * SCREENWIDTH]];
+                }
+            }
+        }
+}
+
+//
+// R_DrawTranslatedColumn
+// Used to draw player sprites
+//  with the green colorramp mapped to others.
+// Could be used with different translation
+//  tables, e.g. the lighter colored version
+//  of the BaronOfHell, the HellKnight, uses
+//  identical sprites, kinda brightened up.
+//
+THREADLOCAL byte    *dc_translation;
+byte                *translationtables;
+
+void R_DrawTranslatedColumn(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translation = dc_translation;
+
+    while (--count)
+    {
+        *dest = colormap[translation[source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = colormap[translation[source[frac >> FRACBITS]]];
+}
+
+//
+// R_InitTranslationTables
+// Creates the translation tables to map
+//  the green color ramp to gray, brown, red.
+// Assumes a given structure of the PLAYPAL.
+// Could be read from a lump instead.
+//
+void R_InitTranslationTables(void)
+{
+    int i;
+
+    translationtables = Z_Malloc(256 * 3, PU_STATIC, NULL);
+
+    // translate just the 16 green colors
+    for (i = 0; i < 256; i++)
+        if (i >= 0x70 && i <= 0x7F)
+        {
+            // map green ramp to gray, brown, red
+            translationtables[i] = 0x60 + (i & 0xF);
+            translationtables[i + 256] = 0x40 + (i & 0xF);
+            translationtables[i + 512] = 0x20 + (i & 0xF);
+        }
+        else
+            // Keep all other colors as is.
+            translationtables[i] = translationtables[i + 256] = translationtables[i + 512] = i;
+}
+
+//
+// R_DrawSpan
+// With DOOM style restrictions on view orientation,
+//  the floors and ceilings consist of horizontal slices
+//  or spans with constant z depth.
+// However, rotation around the world z axis is possible,
+//  thus this mapping, while simpler and faster than
+//  perspective correct texture mapping, has to traverse
+//  the texture at an angle in all but a few cases.
+// In consequence, flats are not stored by column (like walls),
+//  and the inner loop has to step in texture space u and v.
+//
+THREADLOCAL int             ds_y;
+THREADLOCAL int             ds_x1;
+THREADLOCAL int             ds_x2;
+
+THREADLOCAL lighttable_t    *ds_colormap;
+
+THREADLOCAL fixed_t         ds_xfrac;
+THREADLOCAL fixed_t         ds_yfrac;
+THREADLOCAL fixed_t         ds_xstep;
+THREADLOCAL fixed_t         ds_ystep;
+
+// start of a 64*64 tile image
+THREADLOCAL byte            *ds_source;
+
+//
+// Draws the actual span.
+//
+void R_DrawSpan(void)
+{
+    unsigned int        count = ds_x2 - ds_x1 + 1;
+    byte                *dest = topleft0 + ds_y * dc_pitch + ds_x1 * ds_pitch;
+    const int           pitch = ds_pitch;
+    fixed_t             xfrac = ds_xfrac;
+    fixed_t             yfrac = ds_yfrac;
+    const fixed_t       xstep = ds_xstep;
+    const fixed_t       ystep = ds_ystep;
+    const byte          *source = ds_source;
+    const lighttable_t  *colormap = ds_colormap;
+
+    while (count >= 8)
+    {
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        count -= 8;
+    }
+
+    while (count >= 4)
+    {
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+        count -= 4;
+    }
+
+    while (count--)
+    {
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+    }
+}
+
+void R_DrawColorSpan(void)
+{
+    unsigned int        count = ds_x2 - ds_x1 + 1;
+    byte                *dest = topleft0 + ds_y * dc_pitch + ds_x1 * ds_pitch;
+    const int           pitch = ds_pitch;
+    byte                color = ds_colormap[NOTEXTURECOLOR];
+
+    while (--count)
+    {
+        *dest = color;
+        dest += pitch;
+    }
+
+    *dest = color;
+}
+
+static int R_RandomInt(int min, int max)
+{
+    return (min + (int)(((unsigned int)rand() << 15 | rand()) % (unsigned int)(max - min + 1)));
+}
+
+//
+// Quad-column buffer
+// When the r_quadcolumns CVAR is enabled, wall columns aren't drawn straight into
+//  the 3D view. Instead, up to four adjacent columns are drawn into a small buffer
+//  that is four bytes wide, and the rows they have in common are then copied into
+//  the view 32 bits at a time. From Boom.
+// Each column in the buffer can hold up to two ranges of rows that don't overlap,
+//  so that the top and bottom walls of a two-sided line can share it. The buffer is
+//  flushed whenever a column won't fit, and at the end of each seg.
+//
+dboolean    r_quadcolumns = r_quadcolumns_default;
+
+#define QUADRANGES  2
+
+typedef struct
+{
+    int         yl[QUADRANGES];
+    int         yh[QUADRANGES];
+    int         numranges;
+} quadcolumn_t;
+
+static THREADLOCAL byte         quadbuffer[MAXSCREENHEIGHT * 4];
+static THREADLOCAL quadcolumn_t quadcolumns[4];
+static THREADLOCAL int          quadx = -1;
+
+static void R_CopyQuadRows(byte *dest, int column, int yl, int yh)
+{
+    const int   pitch = dc_pitch;
+    const byte  *src = quadbuffer + yl * 4 + column;
+
+    dest += yl * pitch + column * ds_pitch;
+
+    for (; yl <= yh; yl++, src += 4, dest += pitch)
+        *dest = *src;
+}
+
+void R_FlushQuadColumns(void)
+{
+    byte    *dest;
+    int     i, j;
+
+    if (quadx < 0)
+        return;
+
+    dest = topleft0 + quadx * ds_pitch;
+
+    for (j = 0; j < QUADRANGES; j++)
+    {
+        int top = INT_MAX;
+        int bottom = INT_MAX - 1;
+
+        // copy the rows that all four columns have in common 32 bits at a time
+        if (ds_pitch == 1 && quadcolumns[0].numranges > j && quadcolumns[1].numranges > j
+            && quadcolumns[2].numranges > j && quadcolumns[3].numranges > j)
+        {
+            const int   pitch = dc_pitch;
+            int         y;
+
+            top = MAX(MAX(quadcolumns[0].yl[j], quadcolumns[1].yl[j]),
+                MAX(quadcolumns[2].yl[j], quadcolumns[3].yl[j]));
+            bottom = MIN(MIN(quadcolumns[0].yh[j], quadcolumns[1].yh[j]),
+                MIN(quadcolumns[2].yh[j], quadcolumns[3].yh[j]));
+
+            for (y = top; y <= bottom; y++)
+                memcpy(dest + y * pitch, quadbuffer + y * 4, 4);
+        }
+
+        // and the rest a byte at a time
+        for (i = 0; i < 4; i++)
+            if (quadcolumns[i].numranges > j)
+            {
+                const int   yl = quadcolumns[i].yl[j];
+                const int   yh = quadcolumns[i].yh[j];
+
+                if (top > bottom)
+                    R_CopyQuadRows(dest, i, yl, yh);
+                else
+                {
+                    R_CopyQuadRows(dest, i, yl, MIN(yh, top - 1));
+                    R_CopyQuadRows(dest, i, MAX(yl, bottom + 1), yh);
+                }
+            }
+    }
+
+    for (i = 0; i < 4; i++)
+        quadcolumns[i].numranges = 0;
+
+    quadx = -1;
+}
+
+static void R_AddQuadColumn(void (*kernel)(byte *, const int))
+{
+    const int       x = dc_x & ~3;
+    quadcolumn_t    *column = &quadcolumns[dc_x & 3];
+
+    if (x != quadx || column->numranges == QUADRANGES
+        || (column->numranges && dc_yl <= column->yh[column->numranges - 1]))
+    {
+        R_FlushQuadColumns();
+        quadx = x;
+    }
+
+    column->yl[column->numranges] = dc_yl;
+    column->yh[column->numranges] = dc_yh;
+    column->numranges++;
+
+    kernel(quadbuffer + dc_yl * 4 + (dc_x & 3), 4);
+}
+
+void R_DrawQuadWallColumn(void)
+{
+    R_AddQuadColumn(R_DrawWallColumnKernel);
+}
+
+void R_DrawQuadFullbrightWallColumn(void)
+{
+    R_AddQuadColumn(R_DrawFullbrightWallColumnKernel);
+}
+
+typedef struct
+{
+    int         x;
+    int         yl;
+    int         yh;
+    fixed_t     iscale;
+    fixed_t     texturemid;
+    fixed_t     texheight;
+    dboolean    fullbright;
+} testcolumn_t;
+
+//
+// R_TestQuadColumns
+// Draw runs of random wall columns both straight into a screen and through the
+//  quad-column buffer, and check that the output is identical.
+//
+static dboolean R_TestQuadColumns(void)
+{
+    byte            *screens[2];
+    byte            *oldtopleft0 = topleft0;
+    int             oldcentery = centery;
+    int             olddcpitch = dc_pitch;
+    int             olddspitch = ds_pitch;
+    static byte     texture[4096];
+    static byte     colormap[256];
+    static byte     colormask[256];
+    testcolumn_t    columns[16 * 3];
+    dboolean        result = true;
+    int             i;
+
+    screens[0] = calloc(SCREENWIDTH * SCREENHEIGHT, 1);
+    screens[1] = calloc(SCREENWIDTH * SCREENHEIGHT, 1);
+
+    for (i = 0; i < 4096; i++)
+        texture[i] = rand() & 255;
+
+    for (i = 0; i < 256; i++)
+    {
+        colormap[i] = rand() & 255;
+        colormask[i] = !(rand() & 3);
+    }
+
+    centery = SCREENHEIGHT / 2;
+
+    for (i = 0; i < 1024 && result; i++)
+    {
+        const int   heights[] = { 1, 2, 4, 8, 16, 32, 64, 72, 128, 256 };
+        const int   x1 = R_RandomInt(0, SCREENWIDTH - 1);
+        const int   x2 = R_RandomInt(x1, MIN(x1 + 15, SCREENWIDTH - 1));
+        const int   columnmajor = R_RandomInt(0, 1);
+        int         numcolumns = 0;
+        int         x, j;
+
+        // up to three columns that don't overlap at each x, as R_RenderSegLoop() draws
+        for (x = x1; x <= x2; x++)
+        {
+            int yl = R_RandomInt(0, SCREENHEIGHT - 1);
+
+            for (j = R_RandomInt(1, 3); j > 0 && yl < SCREENHEIGHT; j--)
+            {
+                testcolumn_t    *column = &columns[numcolumns++];
+
+                column->x = x;
+                column->yl = yl;
+                column->yh = R_RandomInt(yl, SCREENHEIGHT - 1);
+                column->iscale = R_RandomInt(FRACUNIT / 64, FRACUNIT * 4);
+                column->texturemid = R_RandomInt(-256 * FRACUNIT, 256 * FRACUNIT);
+                column->texheight = heights[R_RandomInt(0, arrlen(heights) - 1)];
+                column->fullbright = R_RandomInt(0, 1);
+                yl = column->yh + 1 + R_RandomInt(0, 8);
+            }
+        }
+
+        dc_pitch = (columnmajor ? 1 : SCREENWIDTH);
+        ds_pitch = (columnmajor ? SCREENHEIGHT : 1);
+        dc_source = texture;
+        dc_colormap = colormap;
+        dc_colormask = colormask;
+
+        for (j = 0; j < 2; j++)
+        {
+            int k;
+
+            topleft0 = screens[j];
+
+            for (k = 0; k < numcolumns; k++)
+            {
+                const testcolumn_t  *column = &columns[k];
+
+                dc_x = column->x;
+                dc_yl = column->yl;
+                dc_yh = column->yh;
+                dc_iscale = column->iscale;
+                dc_texturemid = column->texturemid;
+                dc_texheight = column->texheight;
+
+                if (j)
+                    (column->fullbright ? R_DrawQuadFullbrightWallColumn : R_DrawQuadWallColumn)();
+                else
+                    (column->fullbright ? R_DrawFullbrightWallColumn : R_DrawWallColumn)();
+            }
+
+            R_FlushQuadColumns();
+        }
+
+        result = !memcmp(screens[0], screens[1], SCREENWIDTH * SCREENHEIGHT);
+    }
+
+    free(screens[0]);
+    free(screens[1]);
+    topleft0 = oldtopleft0;
+    centery = oldcentery;
+    dc_pitch = olddcpitch;
+    ds_pitch = olddspitch;
+
+    return result;
+}
+
+//
+// R_InitQuadColumns
+// Check that the quad-column buffer draws exactly the same walls as the normal
+//  drawers before it is first used.
+//
+dboolean R_InitQuadColumns(void)
+{
+    static dboolean tested;
+    static dboolean passed;
+
+    if (!tested)
+    {
+        tested = true;
+
+        if (!(passed = R_TestQuadColumns()))
+            C_Warning("The quad-column drawers failed their self-test and won't be used.");
+    }
+
+    return passed;
+}
+
+#if defined(_DEBUG)
+//
+// Reference column drawers
+// The hand-written column drawers that DRAWCOLUMN() and DRAWWALLCOLUMN() replaced. They
+//  are only kept in debug builds, so that R_TestColumnDrawers() can check that the
+//  generated drawers still draw exactly the same pixels.
+//
+static void R_DrawColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+
+    while (--count)
+    {
+        *dest = colormap[source[frac >> FRACBITS]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = colormap[source[frac >> FRACBITS]];
+}
+
+static void R_DrawRedToBlueColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+
+    while (--count)
+    {
+        *dest = colormap[redtoblue[source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = colormap[redtoblue[source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucentRedToBlue33ColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttab33;
+
+    while (--count)
+    {
+        *dest = translucency[(*dest << 8) + colormap[redtoblue[source[frac >> FRACBITS]]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = translucency[(*dest << 8) + colormap[redtoblue[source[frac >> FRACBITS]]]];
+}
+
+static void R_DrawRedToGreenColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+
+    while (--count)
+    {
+        *dest = colormap[redtogreen[source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = colormap[redtogreen[source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucentRedToGreen33ColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttab33;
+
+    while (--count)
+    {
+        *dest = translucency[(*dest << 8) + colormap[redtogreen[source[frac >> FRACBITS]]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = translucency[(*dest << 8) + colormap[redtogreen[source[frac >> FRACBITS]]]];
+}
+
+static void R_DrawTranslucentColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttab;
+
+    while (--count)
+    {
+        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucent50ColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tranmap;
+
+    while (--count)
+    {
+        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucent33ColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttab33;
+
+    while (--count)
+    {
+        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+}
+
+static void R_DrawMegaSphereColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttab33;
+
+    while (--count)
+    {
+        *dest = translucency[(*dest << 8) + colormap[megasphere[source[frac >> FRACBITS]]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = translucency[(*dest << 8) + colormap[megasphere[source[frac >> FRACBITS]]]];
+}
+
+static void R_DrawSolidMegaSphereColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+
+    while (--count)
+    {
+        *dest = colormap[megasphere[source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = colormap[megasphere[source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucentRedColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttabred;
+
+    while (--count)
+    {
+        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucentRedWhiteColumn1Reference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttabredwhite1;
+
+    while (--count)
+    {
+        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucentRedWhiteColumn2Reference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttabredwhite2;
+
+    while (--count)
+    {
+        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucentRedWhite50ColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttabredwhite50;
+
+    while (--count)
+    {
+        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucentGreenColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttabgreen;
+
+    while (--count)
+    {
+        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucentBlueColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttabblue;
+
+    while (--count)
+    {
+        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucentRed33ColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttabred33;
+
+    while (--count)
+    {
+        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucentGreen33ColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttabgreen33;
+
+    while (--count)
+    {
+        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+}
+
+static void R_DrawTranslucentBlue25ColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    fixed_t             frac = dc_texturefrac;
+    const fixed_t       fracstep = dc_iscale;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const byte          *translucency = tinttabblue25;
+
+    while (--count)
+    {
+        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+        dest += pitch;
+        frac += fracstep;
+    }
+
+    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+}
+
+static void R_DrawWallColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    const fixed_t       iscale = dc_iscale;
+    fixed_t             frac = dc_texturemid + (dc_yl - centery) * iscale;
+    const fixed_t       fracstep = iscale - SPARKLEFIX;
+    const byte          *source = dc_source;
+    const lighttable_t  *colormap = dc_colormap;
+    const fixed_t       texheight = dc_texheight;
+    fixed_t             heightmask = texheight - 1;
+
+    // [SL] Properly tile textures whose heights are not a power-of-2,
+    // avoiding a tutti-frutti effect. From Eternity Engine.
+    if (texheight & heightmask)
+    {
+        heightmask++;
+        heightmask <<= FRACBITS;
+
+        if (frac < 0)
+            while ((frac += heightmask) < 0);
+        else
+            while (frac >= heightmask)
+                frac -= heightmask;
+
+        while (count--)
+        {
+            *dest = colormap[source[frac >> FRACBITS]];
+            dest += pitch;
+
+            if ((frac += fracstep) >= heightmask)
+                frac -= heightmask;
+        }
+    }
+    else
+    {
+        // texture height is a power-of-2
+        // do some loop unrolling
+        while (count >= 8)
+        {
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            count -= 8;
+        }
+
+        if (count & 1)
+        {
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+        }
+
+        if (count & 2)
+        {
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+        }
+
+        if (count & 4)
+        {
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+        }
+    }
+}
+
+static void R_DrawFullbrightWallColumnReference(void)
+{
+    int                 count = dc_yh - dc_yl + 1;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
+    const fixed_t       iscale = dc_iscale;
+    fixed_t             frac = dc_texturemid + (dc_yl - centery) * iscale;
+    const fixed_t       fracstep = iscale - SPARKLEFIX;
+    const byte          *source = dc_source;
+    const byte          *colormask = dc_colormask;
+    const lighttable_t  *colormap = dc_colormap;
+    const fixed_t       texheight = dc_texheight;
+    fixed_t             heightmask = texheight - 1;
+    byte                dot;
+
+    // [SL] Properly tile textures whose heights are not a power-of-2,
+    // avoiding a tutti-frutti effect. From Eternity Engine.
+    if (texheight & heightmask)
+    {
+        heightmask++;
+        heightmask <<= FRACBITS;
+
+        if (frac < 0)
+            while ((frac += heightmask) < 0);
+        else
+            while (frac >= heightmask)
+                frac -= heightmask;
+
+        while (count--)
+        {
+            dot = source[frac >> FRACBITS];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
+
+            if ((frac += fracstep) >= heightmask)
+                frac -= heightmask;
+        }
+    }
+    else
+    {
+        // texture height is a power-of-2
+        // do some loop unrolling
+        while (count >= 8)
+        {
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
+            frac += fracstep;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
+            frac += fracstep;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
             count -= 8;
         }
 
         if (count & 1)
         {
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
         }
 
         if (count & 2)
         {
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
         }
 
         if (count & 4)
         {
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
-            *dest = source[(frac >> FRACBITS) & heightmask];
-            dest += SCREENWIDTH;
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
+            dest += pitch;
             frac += fracstep;
-            *dest = source[(frac >> FRACBITS) & heightmask];
+            dot = source[(frac >> FRACBITS) & heightmask];
+            *dest = (colormask[dot] ? dot : colormap[dot]);
         }
     }
 }
 
-void R_DrawFlippedSkyColumn(void)
+static void R_DrawSkyColumnReference(void)
 {
     int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
+    byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+    const int           pitch = dc_pitch;
     const fixed_t       fracstep = dc_iscale;
     fixed_t             frac = dc_texturemid + (dc_yl - centery) * fracstep;
     const byte          *source = dc_source;
-    fixed_t             i;
-
-    while (--count)
-    {
-        i = frac >> FRACBITS;
-        *dest = source[i > 127 ? 126 - (i & 127) : i];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
-
-    i = frac >> FRACBITS;
-    *dest = source[i > 127 ? 126 - (i & 127) : i];
-}
-
-void R_DrawSkyColorColumn(void)
-{
-    int         count = dc_yh - dc_yl + 1;
-    byte        *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    byte        color = skycolor;
-
-    while (--count)
-    {
-        *dest = color;
-        dest += SCREENWIDTH;
-    }
-
-    *dest = color;
-}
-
-void R_DrawRedToBlueColumn(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-
-    while (--count)
-    {
-        *dest = colormap[redtoblue[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
-
-    *dest = colormap[redtoblue[source[frac >> FRACBITS]]];
-}
-
-void R_DrawTranslucentRedToBlue33Column(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttab33;
-
-    while (--count)
-    {
-        *dest = translucency[(*dest << 8) + colormap[redtoblue[source[frac >> FRACBITS]]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
-
-    *dest = translucency[(*dest << 8) + colormap[redtoblue[source[frac >> FRACBITS]]]];
-}
-
-void R_DrawRedToGreenColumn(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+    const fixed_t       texheight = dc_texheight;
+    fixed_t             heightmask = texheight - 1;
 
-    while (--count)
+    // [SL] Properly tile textures whose heights are not a power-of-2,
+    // avoiding a tutti-frutti effect. From Eternity Engine.
+    if (texheight & heightmask)
     {
-        *dest = colormap[redtogreen[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
+        heightmask++;
+        heightmask <<= FRACBITS;
 
-    *dest = colormap[redtogreen[source[frac >> FRACBITS]]];
-}
+        if (frac < 0)
+            while ((frac += heightmask) < 0);
+        else
+            while (frac >= heightmask)
+                frac -= heightmask;
 
-void R_DrawTranslucentRedToGreen33Column(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttab33;
+        while (count--)
+        {
+            *dest = source[frac >> FRACBITS];
+            dest += pitch;
 
-    while (--count)
-    {
-        *dest = translucency[(*dest << 8) + colormap[redtogreen[source[frac >> FRACBITS]]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
+            if ((frac += fracstep) >= heightmask)
+                frac -= heightmask;
+        }
     }
-
-    *dest = translucency[(*dest << 8) + colormap[redtogreen[source[frac >> FRACBITS]]]];
-}
-
-void R_DrawTranslucentColumn(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttab;
-
-    while (--count)
+    else
     {
-        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
+        // texture height is a power-of-2
+        // do some loop unrolling
+        while (count >= 8)
+        {
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            count -= 8;
+        }
 
-    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-}
+        if (count & 1)
+        {
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+        }
 
-void R_DrawTranslucent50Column(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tranmap;
+        if (count & 2)
+        {
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+        }
 
-    while (--count)
-    {
-        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
+        if (count & 4)
+        {
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            *dest = source[(frac >> FRACBITS) & heightmask];
+            dest += pitch;
+            frac += fracstep;
+            *dest = source[(frac >> FRACBITS) & heightmask];
+        }
     }
-
-    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
 }
 
-void R_DrawDitheredColumn(void)
+typedef struct
 {
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale << 1;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tranmap;
+    void        (*generated)(void);
+    void        (*reference)(void);
+    dboolean    wall;
+} testdrawer_t;
 
-    if (((viewwindowy + dc_yl) & 1) == ((viewwindowx + dc_x) & 1))
-    {
-        dest += SCREENWIDTH;
-        frac += fracstep >> 1;
+static const testdrawer_t testdrawers[] =
+{
+    { R_DrawColumn, R_DrawColumnReference, false },
+    { R_DrawRedToBlueColumn, R_DrawRedToBlueColumnReference, false },
+    { R_DrawTranslucentRedToBlue33Column, R_DrawTranslucentRedToBlue33ColumnReference, false },
+    { R_DrawRedToGreenColumn, R_DrawRedToGreenColumnReference, false },
+    { R_DrawTranslucentRedToGreen33Column, R_DrawTranslucentRedToGreen33ColumnReference, false },
+    { R_DrawTranslucentColumn, R_DrawTranslucentColumnReference, false },
+    { R_DrawTranslucent50Column, R_DrawTranslucent50ColumnReference, false },
+    { R_DrawTranslucent33Column, R_DrawTranslucent33ColumnReference, false },
+    { R_DrawMegaSphereColumn, R_DrawMegaSphereColumnReference, false },
+    { R_DrawSolidMegaSphereColumn, R_DrawSolidMegaSphereColumnReference, false },
+    { R_DrawTranslucentRedColumn, R_DrawTranslucentRedColumnReference, false },
+    { R_DrawTranslucentRedWhiteColumn1, R_DrawTranslucentRedWhiteColumn1Reference, false },
+    { R_DrawTranslucentRedWhiteColumn2, R_DrawTranslucentRedWhiteColumn2Reference, false },
+    { R_DrawTranslucentRedWhite50Column, R_DrawTranslucentRedWhite50ColumnReference, false },
+    { R_DrawTranslucentGreenColumn, R_DrawTranslucentGreenColumnReference, false },
+    { R_DrawTranslucentBlueColumn, R_DrawTranslucentBlueColumnReference, false },
+    { R_DrawTranslucentRed33Column, R_DrawTranslucentRed33ColumnReference, false },
+    { R_DrawTranslucentGreen33Column, R_DrawTranslucentGreen33ColumnReference, false },
+    { R_DrawTranslucentBlue25Column, R_DrawTranslucentBlue25ColumnReference, false },
+    { R_DrawWallColumn, R_DrawWallColumnReference, true },
+    { R_DrawFullbrightWallColumn, R_DrawFullbrightWallColumnReference, true },
+    { R_DrawSkyColumn, R_DrawSkyColumnReference, true }
+};
 
-        if (!--count)
-            return;
+//
+// R_TestColumnDrawers
+// Draw the same random columns with each generated drawer and its reference drawer,
+//  over the same random background and in both framebuffer layouts, and check that
+//  the output is identical. Run with -testdrawers.
+//
+void R_TestColumnDrawers(void)
+{
+    byte            **tables[] =
+    {
+        &tinttab, &tinttab33, &tranmap, &tinttabred, &tinttabredwhite1, &tinttabredwhite2,
+        &tinttabredwhite50, &tinttabgreen, &tinttabblue, &tinttabred33, &tinttabgreen33,
+        &tinttabblue25
+    };
+    byte            *oldtables[arrlen(tables)];
+    byte            *screens[3];
+    byte            *table = malloc(256 * 256);
+    byte            *oldtopleft0 = topleft0;
+    int             oldcentery = centery;
+    int             olddcpitch = dc_pitch;
+    int             olddspitch = ds_pitch;
+    static byte     texture[4096];
+    static byte     colormap[256];
+    static byte     colormask[256];
+    dboolean        result = true;
+    int             i;
+
+    // the translucency tables haven't been built yet, so use a random one in their place
+    for (i = 0; i < 256 * 256; i++)
+        table[i] = rand() & 255;
+
+    for (i = 0; i < (int)arrlen(tables); i++)
+    {
+        oldtables[i] = *tables[i];
+        *tables[i] = table;
     }
 
-    do
-    {
-        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH << 1;
-        frac += fracstep;
-    } while ((count -= 2) > 0);
-}
+    for (i = 0; i < 3; i++)
+        screens[i] = malloc(SCREENWIDTH * SCREENHEIGHT);
 
-void R_DrawTranslucent33Column(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttab33;
+    for (i = 0; i < 4096; i++)
+        texture[i] = rand() & 255;
 
-    while (--count)
+    for (i = 0; i < 256; i++)
     {
-        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
+        colormap[i] = rand() & 255;
+        colormask[i] = !(rand() & 3);
     }
 
-    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-}
-
-void R_DrawMegaSphereColumn(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttab33;
+    centery = SCREENHEIGHT / 2;
+    dc_source = texture;
+    dc_colormap = colormap;
+    dc_colormask = colormask;
 
-    while (--count)
+    for (i = 0; i < 256 && result; i++)
     {
-        *dest = translucency[(*dest << 8) + colormap[megasphere[source[frac >> FRACBITS]]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
+        const int   heights[] = { 1, 2, 4, 8, 16, 32, 64, 72, 128, 256 };
+        const int   columnmajor = i & 1;
+        int         j;
 
-    *dest = translucency[(*dest << 8) + colormap[megasphere[source[frac >> FRACBITS]]]];
-}
+        for (j = 0; j < SCREENWIDTH * SCREENHEIGHT; j++)
+            screens[0][j] = rand() & 255;
 
-void R_DrawSolidMegaSphereColumn(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
+        dc_pitch = (columnmajor ? 1 : SCREENWIDTH);
+        ds_pitch = (columnmajor ? SCREENHEIGHT : 1);
+        dc_x = R_RandomInt(0, SCREENWIDTH - 1);
+        dc_yl = R_RandomInt(0, SCREENHEIGHT - 1);
+        dc_yh = R_RandomInt(dc_yl, SCREENHEIGHT - 1);
 
-    while (--count)
-    {
-        *dest = colormap[megasphere[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
+        for (j = 0; j < (int)arrlen(testdrawers) && result; j++)
+        {
+            const testdrawer_t  *drawer = &testdrawers[j];
+
+            if (drawer->wall)
+            {
+                dc_iscale = R_RandomInt(FRACUNIT / 64, FRACUNIT * 4);
+                dc_texturemid = R_RandomInt(-256 * FRACUNIT, 256 * FRACUNIT);
+                dc_texheight = heights[R_RandomInt(0, arrlen(heights) - 1)];
+            }
+            else
+            {
+                dc_iscale = R_RandomInt(FRACUNIT / 64, FRACUNIT * 2);
+                dc_texturefrac = R_RandomInt(0, 64 * FRACUNIT - 1);
+            }
+
+            memcpy(screens[1], screens[0], SCREENWIDTH * SCREENHEIGHT);
+            memcpy(screens[2], screens[0], SCREENWIDTH * SCREENHEIGHT);
+
+            topleft0 = screens[1];
+            drawer->generated();
+            topleft0 = screens[2];
+            drawer->reference();
+
+            result = !memcmp(screens[1], screens[2], SCREENWIDTH * SCREENHEIGHT);
+        }
     }
 
-    *dest = colormap[megasphere[source[frac >> FRACBITS]]];
+    for (i = 0; i < 3; i++)
+        free(screens[i]);
+
+    for (i = 0; i < (int)arrlen(tables); i++)
+        *tables[i] = oldtables[i];
+
+    free(table);
+    topleft0 = oldtopleft0;
+    centery = oldcentery;
+    dc_pitch = olddcpitch;
+    ds_pitch = olddspitch;
+
+    if (result)
+        C_Output("The column drawers passed their self-test.");
+    else
+        C_Warning("The column drawers failed their self-test.");
 }
+#endif
 
-void R_DrawTranslucentRedColumn(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttabred;
+//
+// SIMD drawers
+// These step the texture coordinates of 4 (SSE2) or 8 (AVX2) pixels at a time, and
+//  with AVX2, also gather the texels and colormap entries 8 at a time. Each must
+//  produce exactly the same output as R_DrawWallColumn() and R_DrawSpan(), which is
+//  verified by R_TestSIMDDrawers() before they are used.
+//
+int     r_simd = r_simd_default;
 
-    while (--count)
-    {
-        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
+void    (*simdwallcolfunc)(void) = R_DrawWallColumn;
+void    (*simdspanfunc)(void) = R_DrawSpan;
 
-    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+#if defined(SIMDDRAWERS)
+// Fill frac[] with start, start + step, start + 2 * step...
+static void R_StepFracs(fixed_t *frac, int count, fixed_t start, fixed_t step)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        frac[i] = (fixed_t)((unsigned int)start + (unsigned int)step * i);
 }
 
-void R_DrawTranslucentRedWhiteColumn1(void)
+TARGET_SSE2 static void R_DrawWallColumnSSE2(void)
 {
     int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttabredwhite1;
+    const fixed_t       texheight = dc_texheight;
 
-    while (--count)
+    // textures whose heights aren't a power-of-2 are left to the original drawer
+    if ((texheight & (texheight - 1)) || count < 4)
+        R_DrawWallColumn();
+    else
     {
-        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
+        byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+        const int           pitch = dc_pitch;
+        const fixed_t       iscale = dc_iscale;
+        fixed_t             frac = dc_texturemid + (dc_yl - centery) * iscale;
+        const fixed_t       fracstep = iscale - SPARKLEFIX;
+        const byte          *source = dc_source;
+        const lighttable_t  *colormap = dc_colormap;
+        const fixed_t       heightmask = texheight - 1;
+        fixed_t             fracs[4];
+        int                 index[4];
+        __m128i             vfrac;
+        const __m128i       vstep = _mm_set1_epi32((int)((unsigned int)fracstep * 4));
+        const __m128i       vmask = _mm_set1_epi32(heightmask);
+
+        R_StepFracs(fracs, 4, frac, fracstep);
+        vfrac = _mm_loadu_si128((__m128i *)fracs);
+
+        while (count >= 4)
+        {
+            _mm_storeu_si128((__m128i *)index, _mm_and_si128(_mm_srai_epi32(vfrac, FRACBITS), vmask));
+            *dest = colormap[source[index[0]]];
+            dest += pitch;
+            *dest = colormap[source[index[1]]];
+            dest += pitch;
+            *dest = colormap[source[index[2]]];
+            dest += pitch;
+            *dest = colormap[source[index[3]]];
+            dest += pitch;
+            vfrac = _mm_add_epi32(vfrac, vstep);
+            count -= 4;
+        }
 
-    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+        frac = _mm_cvtsi128_si32(vfrac);
+
+        while (count--)
+        {
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+        }
+    }
 }
 
-void R_DrawTranslucentRedWhiteColumn2(void)
+TARGET_SSE2 static void R_DrawSpanSSE2(void)
 {
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttabredwhite2;
+    unsigned int        count = ds_x2 - ds_x1 + 1;
+    byte                *dest = topleft0 + ds_y * dc_pitch + ds_x1 * ds_pitch;
+    const int           pitch = ds_pitch;
+    fixed_t             xfrac = ds_xfrac;
+    fixed_t             yfrac = ds_yfrac;
+    const fixed_t       xstep = ds_xstep;
+    const fixed_t       ystep = ds_ystep;
+    const byte          *source = ds_source;
+    const lighttable_t  *colormap = ds_colormap;
 
-    while (--count)
+    if (count >= 4)
     {
-        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
+        fixed_t         fracs[4];
+        int             spot[4];
+        __m128i         vxfrac;
+        __m128i         vyfrac;
+        const __m128i   vxstep = _mm_set1_epi32((int)((unsigned int)xstep * 4));
+        const __m128i   vystep = _mm_set1_epi32((int)((unsigned int)ystep * 4));
+        const __m128i   xmask = _mm_set1_epi32(63);
+        const __m128i   ymask = _mm_set1_epi32(4032);
+
+        R_StepFracs(fracs, 4, xfrac, xstep);
+        vxfrac = _mm_loadu_si128((__m128i *)fracs);
+        R_StepFracs(fracs, 4, yfrac, ystep);
+        vyfrac = _mm_loadu_si128((__m128i *)fracs);
+
+        do
+        {
+            _mm_storeu_si128((__m128i *)spot, _mm_or_si128(
+                _mm_and_si128(_mm_srai_epi32(vxfrac, 16), xmask),
+                _mm_and_si128(_mm_srai_epi32(vyfrac, 10), ymask)));
+            *dest = colormap[source[spot[0]]];
+            dest += pitch;
+            *dest = colormap[source[spot[1]]];
+            dest += pitch;
+            *dest = colormap[source[spot[2]]];
+            dest += pitch;
+            *dest = colormap[source[spot[3]]];
+            dest += pitch;
+            vxfrac = _mm_add_epi32(vxfrac, vxstep);
+            vyfrac = _mm_add_epi32(vyfrac, vystep);
+            count -= 4;
+        } while (count >= 4);
+
+        xfrac = _mm_cvtsi128_si32(vxfrac);
+        yfrac = _mm_cvtsi128_si32(vyfrac);
     }
 
-    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+    while (count--)
+    {
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+    }
 }
 
-void R_DrawTranslucentRedWhite50Column(void)
+// Look up 8 bytes in table at once. Only the aligned dwords that contain each
+//  byte are read, so these reads can never cross into another page.
+TARGET_AVX2 static __inline __m256i R_GatherBytesAVX2(const byte *table, __m256i index)
 {
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttabredwhite50;
+    const int       offset = (int)((uintptr_t)table & 3);
+    __m256i         dwords;
+    __m256i         shift;
 
-    while (--count)
-    {
-        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
+    index = _mm256_add_epi32(index, _mm256_set1_epi32(offset));
+    dwords = _mm256_i32gather_epi32((const int *)(table - offset), _mm256_srli_epi32(index, 2), 4);
+    shift = _mm256_slli_epi32(_mm256_and_si256(index, _mm256_set1_epi32(3)), 3);
 
-    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+    return _mm256_and_si256(_mm256_srlv_epi32(dwords, shift), _mm256_set1_epi32(0xFF));
 }
 
-void R_DrawTranslucentGreenColumn(void)
+TARGET_AVX2 static void R_DrawWallColumnAVX2(void)
 {
     int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttabgreen;
+    const fixed_t       texheight = dc_texheight;
 
-    while (--count)
+    // textures whose heights aren't a power-of-2 are left to the original drawer
+    if ((texheight & (texheight - 1)) || count < 8)
+        R_DrawWallColumn();
+    else
     {
-        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
+        byte                *dest = topleft0 + dc_yl * dc_pitch + dc_x * ds_pitch;
+        const int           pitch = dc_pitch;
+        const fixed_t       iscale = dc_iscale;
+        fixed_t             frac = dc_texturemid + (dc_yl - centery) * iscale;
+        const fixed_t       fracstep = iscale - SPARKLEFIX;
+        const byte          *source = dc_source;
+        const lighttable_t  *colormap = dc_colormap;
+        const fixed_t       heightmask = texheight - 1;
+        fixed_t             fracs[8];
+        int                 pixels[8];
+        __m256i             vfrac;
+        const __m256i       vstep = _mm256_set1_epi32((int)((unsigned int)fracstep * 8));
+        const __m256i       vmask = _mm256_set1_epi32(heightmask);
+
+        R_StepFracs(fracs, 8, frac, fracstep);
+        vfrac = _mm256_loadu_si256((__m256i *)fracs);
 
-    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+        while (count >= 8)
+        {
+            const __m256i   index = _mm256_and_si256(_mm256_srai_epi32(vfrac, FRACBITS), vmask);
+
+            _mm256_storeu_si256((__m256i *)pixels,
+                R_GatherBytesAVX2(colormap, R_GatherBytesAVX2(source, index)));
+            *dest = pixels[0];
+            dest += pitch;
+            *dest = pixels[1];
+            dest += pitch;
+            *dest = pixels[2];
+            dest += pitch;
+            *dest = pixels[3];
+            dest += pitch;
+            *dest = pixels[4];
+            dest += pitch;
+            *dest = pixels[5];
+            dest += pitch;
+            *dest = pixels[6];
+            dest += pitch;
+            *dest = pixels[7];
+            dest += pitch;
+            vfrac = _mm256_add_epi32(vfrac, vstep);
+            count -= 8;
+        }
+
+        frac = _mm_cvtsi128_si32(_mm256_castsi256_si128(vfrac));
+
+        while (count--)
+        {
+            *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+            dest += pitch;
+            frac += fracstep;
+        }
+    }
 }
 
-void R_DrawTranslucentBlueColumn(void)
+TARGET_AVX2 static void R_DrawSpanAVX2(void)
 {
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttabblue;
+    unsigned int        count = ds_x2 - ds_x1 + 1;
+    byte                *dest = topleft0 + ds_y * dc_pitch + ds_x1 * ds_pitch;
+    const int           pitch = ds_pitch;
+    fixed_t             xfrac = ds_xfrac;
+    fixed_t             yfrac = ds_yfrac;
+    const fixed_t       xstep = ds_xstep;
+    const fixed_t       ystep = ds_ystep;
+    const byte          *source = ds_source;
+    const lighttable_t  *colormap = ds_colormap;
 
-    while (--count)
+    // pixels can only be written 8 at a time if the span is contiguous in memory
+    if (count >= 8 && pitch == 1)
     {
-        *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
+        fixed_t         fracs[8];
+        __m256i         vxfrac;
+        __m256i         vyfrac;
+        const __m256i   vxstep = _mm256_set1_epi32((int)((unsigned int)xstep * 8));
+        const __m256i   vystep = _mm256_set1_epi32((int)((unsigned int)ystep * 8));
+        const __m256i   xmask = _mm256_set1_epi32(63);
+        const __m256i   ymask = _mm256_set1_epi32(4032);
+
+        // moves the low byte of each dword to the bottom of each 128-bit lane
+        const __m256i   pack = _mm256_setr_epi8(
+                            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+        R_StepFracs(fracs, 8, xfrac, xstep);
+        vxfrac = _mm256_loadu_si256((__m256i *)fracs);
+        R_StepFracs(fracs, 8, yfrac, ystep);
+        vyfrac = _mm256_loadu_si256((__m256i *)fracs);
+
+        do
+        {
+            const __m256i   spot = _mm256_or_si256(
+                                _mm256_and_si256(_mm256_srai_epi32(vxfrac, 16), xmask),
+                                _mm256_and_si256(_mm256_srai_epi32(vyfrac, 10), ymask));
+            const __m256i   pixels = _mm256_shuffle_epi8(
+                                R_GatherBytesAVX2(colormap, R_GatherBytesAVX2(source, spot)), pack);
+
+            _mm_storel_epi64((__m128i *)dest, _mm_unpacklo_epi32(_mm256_castsi256_si128(pixels),
+                _mm256_extracti128_si256(pixels, 1)));
+            dest += 8;
+            vxfrac = _mm256_add_epi32(vxfrac, vxstep);
+            vyfrac = _mm256_add_epi32(vyfrac, vystep);
+            count -= 8;
+        } while (count >= 8);
+
+        xfrac = _mm_cvtsi128_si32(_mm256_castsi256_si128(vxfrac));
+        yfrac = _mm_cvtsi128_si32(_mm256_castsi256_si128(vyfrac));
     }
 
-    *dest = translucency[(*dest << 8) + colormap[source[frac >> FRACBITS]]];
+    while (count--)
+    {
+        *dest = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
+        dest += pitch;
+        xfrac += xstep;
+        yfrac += ystep;
+    }
 }
 
-void R_DrawTranslucentRed33Column(void)
+//
+// R_TestSIMDDrawers
+// Draw random wall columns and spans with both the original drawers and the
+//  given SIMD drawers, and check that the output is identical.
+//
+static dboolean R_TestSIMDDrawers(void (*wallcolumn)(void), void (*span)(void))
 {
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttabred33;
+    byte            *screens[2];
+    byte            *oldtopleft0 = topleft0;
+    int             oldcentery = centery;
+    int             olddcpitch = dc_pitch;
+    int             olddspitch = ds_pitch;
+    static byte     texture[4096];
+    static byte     colormap[256];
+    dboolean        result = true;
+    int             i;
+
+    screens[0] = calloc(SCREENWIDTH * SCREENHEIGHT, 1);
+    screens[1] = calloc(SCREENWIDTH * SCREENHEIGHT, 1);
+
+    for (i = 0; i < 4096; i++)
+        texture[i] = rand() & 255;
 
-    while (--count)
+    for (i = 0; i < 256; i++)
+        colormap[i] = rand() & 255;
+
+    centery = SCREENHEIGHT / 2;
+    dc_pitch = SCREENWIDTH;
+    ds_pitch = 1;
+
+    for (i = 0; i < 4096 && result; i++)
     {
-        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
+        const int   heights[] = { 1, 2, 4, 8, 16, 32, 64, 72, 128, 256 };
+        int         j;
+
+        dc_source = texture;
+        dc_colormap = colormap;
+        dc_x = R_RandomInt(0, SCREENWIDTH - 1);
+        dc_yl = R_RandomInt(0, SCREENHEIGHT - 1);
+        dc_yh = R_RandomInt(dc_yl, SCREENHEIGHT - 1);
+        dc_iscale = R_RandomInt(FRACUNIT / 64, FRACUNIT * 4);
+        dc_texturemid = R_RandomInt(-256 * FRACUNIT, 256 * FRACUNIT);
+        dc_texheight = heights[R_RandomInt(0, arrlen(heights) - 1)];
+
+        ds_source = texture;
+        ds_colormap = colormap;
+        ds_y = R_RandomInt(0, SCREENHEIGHT - 1);
+        ds_x1 = R_RandomInt(0, SCREENWIDTH - 1);
+        ds_x2 = R_RandomInt(ds_x1, SCREENWIDTH - 1);
+        ds_xfrac = (fixed_t)((unsigned int)rand() << 16 ^ rand());
+        ds_yfrac = (fixed_t)((unsigned int)rand() << 16 ^ rand());
+        ds_xstep = R_RandomInt(-FRACUNIT * 4, FRACUNIT * 4);
+        ds_ystep = R_RandomInt(-FRACUNIT * 4, FRACUNIT * 4);
+
+        for (j = 0; j < 2; j++)
+        {
+            topleft0 = screens[j];
+            (j ? wallcolumn : R_DrawWallColumn)();
+            (j ? span : R_DrawSpan)();
+        }
+
+        result = !memcmp(screens[0], screens[1], SCREENWIDTH * SCREENHEIGHT);
     }
 
-    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+    free(screens[0]);
+    free(screens[1]);
+    topleft0 = oldtopleft0;
+    centery = oldcentery;
+    dc_pitch = olddcpitch;
+    ds_pitch = olddspitch;
+
+    return result;
 }
+#endif
 
-void R_DrawTranslucentGreen33Column(void)
+//
+// R_InitSIMDDrawers
+// Choose the wall column and span drawers to use, based on the r_simd CVAR
+//  and what the CPU supports.
+//
+void R_InitSIMDDrawers(void)
 {
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttabgreen33;
+#if defined(SIMDDRAWERS)
+    static dboolean tested;
+    static dboolean sse2;
+    static dboolean avx2;
+    int             simd = r_simd;
 
-    while (--count)
+    if (!tested)
     {
-        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
-    }
+        tested = true;
 
-    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
-}
+        if (SDL_HasSSE2() && !(sse2 = R_TestSIMDDrawers(R_DrawWallColumnSSE2, R_DrawSpanSSE2)))
+            C_Warning("The <b>SSE2</b> drawers failed their self-test and won't be used.");
 
-void R_DrawTranslucentBlue25Column(void)
-{
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translucency = tinttabblue25;
+        if (SDL_HasAVX2() && !(avx2 = R_TestSIMDDrawers(R_DrawWallColumnAVX2, R_DrawSpanAVX2)))
+            C_Warning("The <b>AVX2</b> drawers failed their self-test and won't be used.");
+    }
 
-    while (--count)
+    if (simd == r_simd_auto)
+        simd = (avx2 ? r_simd_avx2 : (sse2 ? r_simd_sse2 : r_simd_none));
+    else if ((simd == r_simd_avx2 && !avx2) || (simd == r_simd_sse2 && !sse2))
     {
-        *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
+        C_Warning("The <b>%s</b> drawers aren't available on this computer.",
+            (simd == r_simd_avx2 ? "AVX2" : "SSE2"));
+        simd = r_simd_none;
     }
 
-    *dest = colormap[translucency[(*dest << 8) + source[frac >> FRACBITS]]];
+    switch (simd)
+    {
+        case r_simd_avx2:
+            simdwallcolfunc = R_DrawWallColumnAVX2;
+            simdspanfunc = R_DrawSpanAVX2;
+            break;
+
+        case r_simd_sse2:
+            simdwallcolfunc = R_DrawWallColumnSSE2;
+            simdspanfunc = R_DrawSpanSSE2;
+            break;
+
+        default:
+            simdwallcolfunc = R_DrawWallColumn;
+            simdspanfunc = R_DrawSpan;
+            break;
+    }
+#endif
 }
 
 //
-// Spectre/Invisibility.
+// Column-major 3D view
+// When r_columnmajor is on, the 3D view is drawn into a transposed buffer so that
+//  each column drawer writes to consecutive bytes, rather than to bytes that are
+//  SCREENWIDTH apart. The buffer is then transposed into screens[0] a tile at a time.
 //
-extern int      fuzzpos;
+dboolean        r_columnmajor = r_columnmajor_default;
 
-int             fuzzrange[3] = { -SCREENWIDTH, 0, SCREENWIDTH };
+static byte     *columnmajorscreen;
 
-#define FUZZ(a, b)      fuzzrange[rand() % (b - a + 1) + a]
-#define NOFUZZ          251
+#define TRANSPOSETILESIZE   16
 
-void R_DrawFuzzColumn(void)
+void R_StartColumnMajorView(void)
 {
-    byte        *dest;
-    int         count = dc_yh - dc_yl;
-
-    if (count < 0)
+    if (!r_columnmajor)
         return;
 
-    dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-
-    if (count)
-    {
-        // top
-        if (!dc_yl)
-            *dest = fullcolormap[6 * 256 + dest[(fuzztable[fuzzpos++] = FUZZ(1, 2))]];
-        else if (!(rand() % 4))
-            *dest = fullcolormap[12 * 256 + dest[(fuzztable[fuzzpos++] = FUZZ(0, 2))]];
-        dest += SCREENWIDTH;
-
-        while (--count)
-        {
-            // middle
-            *dest = fullcolormap[6 * 256 + dest[(fuzztable[fuzzpos++] = FUZZ(0, 2))]];
-            dest += SCREENWIDTH;
-        }
+    if (!columnmajorscreen)
+        columnmajorscreen = Z_Malloc(MAXSCREENWIDTH * MAXSCREENHEIGHT, PU_STATIC, NULL);
 
-        // bottom
-        if (dc_yh == viewheight - 1)
-            *dest = fullcolormap[5 * 256 + dest[(fuzztable[fuzzpos] = FUZZ(0, 1))]];
-        else if (dc_baseclip == -1 && !(rand() % 4))
-            *dest = fullcolormap[14 * 256 + dest[(fuzztable[fuzzpos] = FUZZ(0, 1))]];
-    }
+    topleft0 = columnmajorscreen + viewwindowx * SCREENHEIGHT + viewwindowy;
+    dc_pitch = 1;
+    ds_pitch = SCREENHEIGHT;
 }
 
-void R_DrawPausedFuzzColumn(void)
+void R_FinishColumnMajorView(void)
 {
-    byte        *dest;
-    int         count = dc_yh - dc_yl;
+    int x, y;
 
-    if (count < 0)
+    if (dc_pitch != 1)
         return;
 
-    dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-
-    if (count)
+    for (x = 0; x < viewwidth; x += TRANSPOSETILESIZE)
     {
-        // top
-        if (!dc_yl)
-        {
-            *dest = fullcolormap[6 * 256 + dest[fuzztable[fuzzpos++]]];
-            if (fuzzpos == SCREENWIDTH * SCREENHEIGHT)
-                fuzzpos = 0;
-        }
-        dest += SCREENWIDTH;
+        const int   width = MIN(TRANSPOSETILESIZE, viewwidth - x);
 
-        while (--count)
+        for (y = 0; y < viewheight; y += TRANSPOSETILESIZE)
         {
-            // middle
-            *dest = fullcolormap[6 * 256 + dest[fuzztable[fuzzpos++]]];
-            if (fuzzpos == SCREENWIDTH * SCREENHEIGHT)
-                fuzzpos = 0;
-            dest += SCREENWIDTH;
+            const int   height = MIN(TRANSPOSETILESIZE, viewheight - y);
+            const byte  *src = topleft0 + x * SCREENHEIGHT + y;
+            byte        *dest = screens[0] + (viewwindowy + y) * SCREENWIDTH + viewwindowx + x;
+            int         i, j;
+
+            for (j = 0; j < height; j++, src++, dest += SCREENWIDTH)
+                for (i = 0; i < width; i++)
+                    dest[i] = src[i * SCREENHEIGHT];
         }
-
-        // bottom
-        if (dc_yh == viewheight - 1)
-            *dest = fullcolormap[5 * 256 + dest[fuzztable[fuzzpos]]];
     }
+
+    topleft0 = screens[0] + viewwindowy * SCREENWIDTH + viewwindowx;
+    dc_pitch = SCREENWIDTH;
+    ds_pitch = 1;
 }
 
-void R_DrawFuzzColumns(void)
+//
+// R_FillView
+// Fill the 3D view with a single color, in whichever buffer it is being drawn into.
+//
+void R_FillView(byte color)
 {
-    int         x, y;
-    int         w = viewwindowx + viewwidth;
-    int         h = (viewwindowy + viewheight) * SCREENWIDTH;
-
-    for (x = viewwindowx; x < w; x++)
-        for (y = viewwindowy * SCREENWIDTH; y < h; y += SCREENWIDTH)
-        {
-            int         i = x + y;
-            byte        *src = screens[1] + i;
-
-            if (*src != NOFUZZ)
-            {
-                byte    *dest = screens[0] + i;
+    if (dc_pitch == 1)
+    {
+        int x;
 
-                if (!y || *(src - SCREENWIDTH) == NOFUZZ)
-                {
-                    // top
-                    if (!(rand() % 4))
-                        *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2))]];
-                }
-                else if (y == h - SCREENWIDTH)
-                {
-                    // bottom of view
-                    *dest = fullcolormap[5 * 256 + dest[(fuzztable[i] = FUZZ(0, 1))]];
-                }
-                else if (*(src + SCREENWIDTH) == NOFUZZ)
-                {
-                    // bottom of post
-                    if (!(rand() % 4))
-                        *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2))]];
-                }
-                else
-                {
-                    // middle
-                    if (*(src - 1) == NOFUZZ || *(src + 1) == NOFUZZ)
-                    {
-                        if (!(rand() % 4))
-                            *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(0, 2))]];
-                    }
-                    else
-                        *dest = fullcolormap[6 * 256 + dest[(fuzztable[i] = FUZZ(0, 2))]];
-                }
-            }
-        }
+        for (x = 0; x < viewwidth; x++)
+            memset(topleft0 + x * SCREENHEIGHT, color, viewheight);
+    }
+    else
+        V_FillRect(0, viewwindowx, viewwindowy, viewwidth, viewheight, color);
 }
 
-void R_DrawPausedFuzzColumns(void)
+//
+// R_UpscaleView
+// When the 3D view has been rendered at a lower resolution than the view window
+//  (see R_UpdateViewScale()), it is drawn into the top-left corner of the view
+//  window. Scale it up in place to fill the view window. Working backwards from
+//  the bottom-right corner means no pixel is overwritten before it is read.
+//
+void R_UpscaleView(void)
 {
+    static int  xmap[MAXSCREENWIDTH];
+    byte        *view = screens[0] + viewwindowy * SCREENWIDTH + viewwindowx;
     int         x, y;
-    int         w = viewwindowx + viewwidth;
-    int         h = (viewwindowy + viewheight) * SCREENWIDTH;
 
-    for (x = viewwindowx; x < w; x++)
-        for (y = viewwindowy * SCREENWIDTH; y < h; y += SCREENWIDTH)
-        {
-            int         i = x + y;
-            byte        *src = screens[1] + i;
+    if (viewwidth == scaledviewwidth && viewheight == scaledviewheight)
+        return;
 
-            if (*src != NOFUZZ)
-            {
-                byte    *dest = screens[0] + i;
+    for (x = 0; x < scaledviewwidth; x++)
+        xmap[x] = x * viewwidth / scaledviewwidth;
 
-                if (!y || *(src - SCREENWIDTH) == NOFUZZ)
-                {
-                    // top
-                    // do nothing
-                }
-                else if (y == h - SCREENWIDTH)
-                {
-                    // bottom of view
-                    *dest = fullcolormap[5 * 256 + dest[fuzztable[i]]];
-                }
-                else if (*(src + SCREENWIDTH) == NOFUZZ)
-                {
-                    // bottom of post
-                    // do nothing
-                }
-                else
-                {
-                    // middle
-                    if (*(src - 1) == NOFUZZ || *(src + 1) == NOFUZZ)
-                    {
-                        // do nothing
-                    }
-                    else
-                        *dest = fullcolormap[6 * 256 + dest[fuzztable[i]]];
-                }
-            }
-        }
+    for (y = scaledviewheight - 1; y >= 0; y--)
+    {
+        const byte  *src = view + y * viewheight / scaledviewheight * SCREENWIDTH;
+        byte        *dest = view + y * SCREENWIDTH;
+
+        for (x = scaledviewwidth - 1; x >= 0; x--)
+            dest[x] = src[xmap[x]];
+    }
 }
 
 //
-// R_DrawTranslatedColumn
-// Used to draw player sprites
-//  with the green colorramp mapped to others.
-// Could be used with different translation
-//  tables, e.g. the lighter colored version
-//  of the BaronOfHell, the HellKnight, uses
-//  identical sprites, kinda brightened up.
+// Draw command buffer
+// When the r_drawcommands CVAR is enabled, the columns and spans of the 3D
+//  view aren't drawn as soon as they are found to be visible. Instead, the
+//  state of the dc_* or ds_* variables is recorded in a command buffer, and
+//  drawn in the same order when the buffer is flushed. Each rendering thread
+//  has its own buffer.
 //
-byte    *dc_translation;
-byte    *translationtables;
+#define MAXDRAWCOMMANDS 16384
 
-void R_DrawTranslatedColumn(void)
+typedef enum
 {
-    int                 count = dc_yh - dc_yl + 1;
-    byte                *dest = topleft0 + dc_yl * SCREENWIDTH + dc_x;
-    fixed_t             frac = dc_texturefrac;
-    const fixed_t       fracstep = dc_iscale;
-    const byte          *source = dc_source;
-    const lighttable_t  *colormap = dc_colormap;
-    const byte          *translation = dc_translation;
+    DC_COLUMN,
+    DC_SPAN
+} drawcommandtype_t;
 
-    while (--count)
+typedef struct
+{
+    void                (*func)(void);
+    byte                *source;
+    lighttable_t        *colormap;
+    byte                *colormask;
+    byte                *translation;
+    byte                *blood;
+    short               type;
+    short               x;              // dc_x, or ds_y for spans
+    short               y1;             // dc_yl, or ds_x1 for spans
+    short               y2;             // dc_yh, or ds_x2 for spans
+    fixed_t             frac;           // dc_texturefrac, or ds_xfrac for spans
+    fixed_t             step;           // dc_iscale, or ds_xstep for spans
+    fixed_t             texturemid;     // dc_texturemid, or ds_yfrac for spans
+    fixed_t             texheight;      // dc_texheight, or ds_ystep for spans
+    int                 baseclip;
+} drawcommand_t;
+
+THREADLOCAL dboolean            drawcommands;
+
+static THREADLOCAL drawcommand_t    *drawcommandbuffer;
+static THREADLOCAL int          numdrawcommands;
+static THREADLOCAL int          totaldrawcommands;
+
+// composite textures to unlock once the commands that read from them have been drawn
+static THREADLOCAL int          *drawcommandunlocks;
+static THREADLOCAL int          numdrawcommandunlocks;
+
+// flats to release once the spans that read from them have been drawn
+static THREADLOCAL int          *drawcommandreleases;
+static THREADLOCAL int          numdrawcommandreleases;
+
+void R_StartDrawCommands(void)
+{
+    if ((drawcommands = r_drawcommands) && !drawcommandbuffer)
     {
-        *dest = colormap[translation[source[frac >> FRACBITS]]];
-        dest += SCREENWIDTH;
-        frac += fracstep;
+        drawcommandbuffer = malloc(MAXDRAWCOMMANDS * sizeof(*drawcommandbuffer));
+        drawcommandunlocks = malloc(MAXDRAWCOMMANDS * sizeof(*drawcommandunlocks));
+        drawcommandreleases = malloc(MAXDRAWCOMMANDS * sizeof(*drawcommandreleases));
     }
 
-    *dest = colormap[translation[source[frac >> FRACBITS]]];
+    numdrawcommands = 0;
+    totaldrawcommands = 0;
 }
 
-//
-// R_InitTranslationTables
-// Creates the translation tables to map
-//  the green color ramp to gray, brown, red.
-// Assumes a given structure of the PLAYPAL.
-// Could be read from a lump instead.
-//
-void R_InitTranslationTables(void)
+void R_FreeDrawCommands(void)
 {
-    int i;
+    free(drawcommandbuffer);
+    free(drawcommandunlocks);
+    free(drawcommandreleases);
+    drawcommandbuffer = NULL;
+    drawcommandunlocks = NULL;
+    drawcommandreleases = NULL;
+}
 
-    translationtables = Z_Malloc(256 * 3, PU_STATIC, NULL);
+void R_FlushDrawCommands(void)
+{
+    drawcommand_t   *command = drawcommandbuffer;
+    drawcommand_t   *end = drawcommandbuffer + numdrawcommands;
 
-    // translate just the 16 green colors
-    for (i = 0; i < 256; i++)
-        if (i >= 0x70 && i <= 0x7F)
+    for (; command < end; command++)
+        if (command->type == DC_COLUMN)
         {
-            // map green ramp to gray, brown, red
-            translationtables[i] = 0x60 + (i & 0xF);
-            translationtables[i + 256] = 0x40 + (i & 0xF);
-            translationtables[i + 512] = 0x20 + (i & 0xF);
+            dc_source = command->source;
+            dc_colormap = command->colormap;
+            dc_colormask = command->colormask;
+            dc_translation = command->translation;
+            dc_blood = command->blood;
+            dc_x = command->x;
+            dc_yl = command->y1;
+            dc_yh = command->y2;
+            dc_texturefrac = command->frac;
+            dc_iscale = command->step;
+            dc_texturemid = command->texturemid;
+            dc_texheight = command->texheight;
+            dc_baseclip = command->baseclip;
+            command->func();
         }
         else
-            // Keep all other colors as is.
-            translationtables[i] = translationtables[i + 256] = translationtables[i + 512] = i;
-}
+        {
+            ds_source = command->source;
+            ds_colormap = command->colormap;
+            ds_y = command->x;
+            ds_x1 = command->y1;
+            ds_x2 = command->y2;
+            ds_xfrac = command->frac;
+            ds_xstep = command->step;
+            ds_yfrac = command->texturemid;
+            ds_ystep = command->texheight;
+            command->func();
+        }
 
-//
-// R_DrawSpan
-// With DOOM style restrictions on view orientation,
-//  the floors and ceilings consist of horizontal slices
-//  or spans with constant z depth.
-// However, rotation around the world z axis is possible,
-//  thus this mapping, while simpler and faster than
-//  perspective correct texture mapping, has to traverse
-//  the texture at an angle in all but a few cases.
-// In consequence, flats are not stored by column (like walls),
-//  and the inner loop has to step in texture space u and v.
-//
-int             ds_y;
-int             ds_x1;
-int             ds_x2;
+    totaldrawcommands += numdrawcommands;
+    numdrawcommands = 0;
 
-lighttable_t    *ds_colormap;
+    if (numdrawcommandunlocks)
+    {
+        R_UnlockTextureComposites(drawcommandunlocks, numdrawcommandunlocks);
+        numdrawcommandunlocks = 0;
+    }
 
-fixed_t         ds_xfrac;
-fixed_t         ds_yfrac;
-fixed_t         ds_xstep;
-fixed_t         ds_ystep;
+    if (numdrawcommandreleases)
+    {
+        int i;
 
-// start of a 64*64 tile image
-byte            *ds_source;
+        R_LockRenderCache();
 
-//
-// Draws the actual span.
-//
-void R_DrawSpan(void)
-{
-    unsigned int        count = ds_x2 - ds_x1 + 1;
-    byte                *dest = topleft0 + ds_y * SCREENWIDTH + ds_x1;
-    fixed_t             xfrac = ds_xfrac;
-    fixed_t             yfrac = ds_yfrac;
-    const fixed_t       xstep = ds_xstep;
-    const fixed_t       ystep = ds_ystep;
-    const byte          *source = ds_source;
-    const lighttable_t  *colormap = ds_colormap;
+        for (i = 0; i < numdrawcommandreleases; i++)
+            W_ReleaseLumpNum(drawcommandreleases[i]);
 
-    while (count >= 8)
-    {
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        count -= 8;
+        R_UnlockRenderCache();
+        numdrawcommandreleases = 0;
     }
+}
 
-    while (count >= 4)
+int R_FinishDrawCommands(void)
+{
+    if (drawcommands)
     {
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-        count -= 4;
+        R_FlushDrawCommands();
+        drawcommands = false;
     }
 
-    while (count--)
-    {
-        *dest++ = colormap[source[((xfrac >> 16) & 63) | ((yfrac >> 10) & 4032)]];
-        xfrac += xstep;
-        yfrac += ystep;
-    }
+    return totaldrawcommands;
 }
 
-void R_DrawColorSpan(void)
+void R_AddColumnCommand(void (*func)(void))
 {
-    unsigned int        count = ds_x2 - ds_x1 + 1;
-    byte                *dest = topleft0 + ds_y * SCREENWIDTH + ds_x1;
-    byte                color = ds_colormap[NOTEXTURECOLOR];
+    drawcommand_t   *command;
+
+    if (numdrawcommands == MAXDRAWCOMMANDS)
+        R_FlushDrawCommands();
+
+    command = &drawcommandbuffer[numdrawcommands++];
+    command->func = func;
+    command->type = DC_COLUMN;
+    command->source = dc_source;
+    command->colormap = dc_colormap;
+    command->colormask = dc_colormask;
+    command->translation = dc_translation;
+    command->blood = dc_blood;
+    command->x = dc_x;
+    command->y1 = dc_yl;
+    command->y2 = dc_yh;
+    command->frac = dc_texturefrac;
+    command->step = dc_iscale;
+    command->texturemid = dc_texturemid;
+    command->texheight = dc_texheight;
+    command->baseclip = dc_baseclip;
+}
 
-    while (--count)
-        *dest++ = color;
+void R_AddUnlockCommand(int id)
+{
+    if (numdrawcommandunlocks == MAXDRAWCOMMANDS)
+        R_FlushDrawCommands();
 
-    *dest = color;
+    drawcommandunlocks[numdrawcommandunlocks++] = id;
+}
+
+void R_AddReleaseCommand(int lumpnum)
+{
+    if (numdrawcommandreleases == MAXDRAWCOMMANDS)
+        R_FlushDrawCommands();
+
+    drawcommandreleases[numdrawcommandreleases++] = lumpnum;
+}
+
+void R_AddSpanCommand(void (*func)(void))
+{
+    drawcommand_t   *command;
+
+    if (numdrawcommands == MAXDRAWCOMMANDS)
+        R_FlushDrawCommands();
+
+    command = &drawcommandbuffer[numdrawcommands++];
+    command->func = func;
+    command->type = DC_SPAN;
+    command->source = ds_source;
+    command->colormap = ds_colormap;
+    command->x = ds_y;
+    command->y1 = ds_x1;
+    command->y2 = ds_x2;
+    command->frac = ds_xfrac;
+    command->step = ds_xstep;
+    command->texturemid = ds_yfrac;
+    command->texheight = ds_ystep;
 }
 
 //
@@ -1447,6 +2865,8 @@ void R_InitBuffer(int width, int height)
 
     topleft0 = screens[0] + viewwindowy * SCREENWIDTH + viewwindowx;
     topleft1 = screens[1] + viewwindowy * SCREENWIDTH + viewwindowx;
+    dc_pitch = SCREENWIDTH;
+    ds_pitch = 1;
 }
 
 //
@@ -1492,7 +2912,7 @@ void R_FillBackScreen(void)
 
     // Draw screen and bezel; this is done to a separate screen buffer.
     width = scaledviewwidth / 2;
-    height = viewheight / 2;
+    height = scaledviewheight / 2;
     windowx = viewwindowx / 2;
     windowy = viewwindowy / 2;
 
@@ -1545,21 +2965,21 @@ void R_DrawViewBorder(void)
     if (scaledviewwidth == SCREENWIDTH)
         return;
 
-    top = (SCREENHEIGHT - SBARHEIGHT - viewheight) / 2;
+    top = (SCREENHEIGHT - SBARHEIGHT - scaledviewheight) / 2;
     side = (SCREENWIDTH - scaledviewwidth) / 2;
 
     // copy top and one line of left side
     R_VideoErase(0, top * SCREENWIDTH + side);
 
     // copy one line of right side and bottom
-    ofs = (viewheight + top) * SCREENWIDTH - side;
+    ofs = (scaledviewheight + top) * SCREENWIDTH - side;
     R_VideoErase(ofs, top * SCREENWIDTH + side);
 
     // copy sides using wraparound
     ofs = top * SCREENWIDTH + SCREENWIDTH - side;
     side <<= 1;
 
-    for (i = 1; i < viewheight; i++)
+    for (i = 1; i < scaledviewheight; i++)
     {
         R_VideoErase(ofs, side);
         ofs += SCREENWIDTH;
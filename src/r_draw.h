@@ -46,20 +46,27 @@
 
 #define NOTEXTURECOLOR  80
 
-extern lighttable_t     *dc_colormap;
-extern int              dc_x;
-extern int              dc_yl;
-extern int              dc_yh;
-extern fixed_t          dc_iscale;
-extern fixed_t          dc_texturemid;
-extern fixed_t          dc_texheight;
-extern fixed_t          dc_texturefrac;
-extern byte             *dc_blood;
-extern byte             *dc_colormask;
-extern int              dc_baseclip;
+extern THREADLOCAL lighttable_t *dc_colormap;
+extern THREADLOCAL int          dc_x;
+extern THREADLOCAL int          dc_yl;
+extern THREADLOCAL int          dc_yh;
+extern THREADLOCAL fixed_t      dc_iscale;
+extern THREADLOCAL fixed_t      dc_texturemid;
+extern THREADLOCAL fixed_t      dc_texheight;
+extern THREADLOCAL fixed_t      dc_texturefrac;
+extern THREADLOCAL byte         *dc_blood;
+extern THREADLOCAL byte         *dc_colormask;
+extern THREADLOCAL int          dc_baseclip;
 
 // first pixel in a column
-extern byte             *dc_source;
+extern THREADLOCAL byte         *dc_source;
+
+// distance between adjacent pixels in a column and in a span
+extern int                      dc_pitch;
+extern int                      ds_pitch;
+
+// advanced every frame to vary the fuzz effect
+extern unsigned int             fuzzframe;
 
 extern byte             *tinttab;
 extern byte             *tinttab25;
@@ -128,28 +135,89 @@ void R_DrawTranslatedColumn(void);
 
 void R_VideoErase(unsigned int ofs, int count);
 
-extern int              ds_y;
-extern int              ds_x1;
-extern int              ds_x2;
+extern THREADLOCAL int          ds_y;
+extern THREADLOCAL int          ds_x1;
+extern THREADLOCAL int          ds_x2;
 
-extern lighttable_t     *ds_colormap;
+extern THREADLOCAL lighttable_t *ds_colormap;
 
-extern fixed_t          ds_xfrac;
-extern fixed_t          ds_yfrac;
-extern fixed_t          ds_xstep;
-extern fixed_t          ds_ystep;
+extern THREADLOCAL fixed_t      ds_xfrac;
+extern THREADLOCAL fixed_t      ds_yfrac;
+extern THREADLOCAL fixed_t      ds_xstep;
+extern THREADLOCAL fixed_t      ds_ystep;
 
 // start of a 64*64 tile image
-extern byte             *ds_source;
+extern THREADLOCAL byte         *ds_source;
 
-extern byte             *translationtables;
-extern byte             *dc_translation;
+extern byte                     *translationtables;
+extern THREADLOCAL byte         *dc_translation;
 
 // Span blitting for rows, floor/ceiling.
 // No Spectre effect needed.
 void R_DrawSpan(void);
 void R_DrawColorSpan(void);
 
+// Draw the 3D view into a column-major buffer, and then transpose it into screens[0].
+extern dboolean                 r_columnmajor;
+
+void R_StartColumnMajorView(void);
+void R_FinishColumnMajorView(void);
+void R_FillView(byte color);
+
+// Scale the 3D view up to fill the view window when it was rendered at a lower resolution.
+void R_UpscaleView(void);
+
+// Draw wall columns four at a time through a small buffer, rather than one at a time.
+extern dboolean                 r_quadcolumns;
+
+void R_DrawQuadWallColumn(void);
+void R_DrawQuadFullbrightWallColumn(void);
+void R_FlushQuadColumns(void);
+dboolean R_InitQuadColumns(void);
+
+#if defined(_DEBUG)
+void R_TestColumnDrawers(void);
+#endif
+
+// SIMD versions of R_DrawWallColumn() and R_DrawSpan(), as chosen by R_InitSIMDDrawers().
+extern int                      r_simd;
+extern void                     (*simdwallcolfunc)(void);
+extern void                     (*simdspanfunc)(void);
+
+void R_InitSIMDDrawers(void);
+
+// Command buffer, used to defer drawing columns and spans until after the
+//  visible parts of the 3D view have been found.
+extern dboolean                 r_drawcommands;
+extern THREADLOCAL dboolean     drawcommands;
+
+void R_StartDrawCommands(void);
+void R_FreeDrawCommands(void);
+void R_FlushDrawCommands(void);
+void R_AddUnlockCommand(int id);
+void R_AddReleaseCommand(int lumpnum);
+int R_FinishDrawCommands(void);
+void R_AddColumnCommand(void (*func)(void));
+void R_AddSpanCommand(void (*func)(void));
+
+// Draw a column now, or record it in the command buffer.
+static __inline void R_ColumnCommand(void (*func)(void))
+{
+    if (drawcommands)
+        R_AddColumnCommand(func);
+    else
+        func();
+}
+
+// Draw a span now, or record it in the command buffer.
+static __inline void R_SpanCommand(void (*func)(void))
+{
+    if (drawcommands)
+        R_AddSpanCommand(func);
+    else
+        func();
+}
+
 void R_InitBuffer(int width, int height);
 
 // Initialize color translation tables,
@@ -36,14 +36,22 @@
 ========================================================================
 */
 
+#include <string.h>
+
 #include "c_console.h"
 #include "doomstat.h"
 #include "i_timer.h"
+#include "m_argv.h"
+#include "m_bbox.h"
+#include "m_config.h"
 #include "m_random.h"
 #include "p_local.h"
+#include "p_tick.h"
 #include "r_sky.h"
 #include "v_video.h"
 
+#include "SDL.h"
+
 // Fineangles in the SCREENWIDTH wide window.
 #define FIELDOFVIEW     2048
 
@@ -51,7 +59,12 @@
 int                     validcount = 1;
 
 lighttable_t            *fixedcolormap;
-extern lighttable_t     **walllights;
+extern THREADLOCAL lighttable_t **walllights;
+
+// killough 3/20/98: localize scalelightfixed (readability/optimization)
+static lighttable_t     *scalelightfixed[MAXLIGHTSCALE];
+
+THREADLOCAL void        (*colfunc)(void);
 
 int                     centerx;
 int                     centery;
@@ -75,6 +88,39 @@ player_t                *viewplayer;
 //      range of [0.0, 1.0). Used for interpolation.
 fixed_t                 fractionaltic;
 
+THREADLOCAL int         stripx1;
+THREADLOCAL int         stripx2;
+
+int                     numrenderthreads = 1;
+
+renderstats_t           renderstats;
+
+// Dynamic resolution
+dboolean                r_dynamicresolution = r_dynamicresolution_default;
+float                   r_dynamicresolution_budget = r_dynamicresolution_budget_default;
+
+int                     viewscale = 100;
+viewscalechange_t       viewscalechanges[MAXVIEWSCALECHANGES];
+int                     numviewscalechanges;
+
+static uint64_t         viewscaletime;
+static int              viewscaleframes;
+
+static dboolean         benchmarking;
+
+typedef struct
+{
+    SDL_Thread          *thread;
+    SDL_sem             *start;
+    int                 strip;
+} renderthread_t;
+
+static renderthread_t   renderthreads[MAXRENDERTHREADS];
+static SDL_sem          *renderdone;
+static SDL_mutex        *rendercachelock;
+static void             (*renderjob)(int strip);
+static dboolean         quitrenderthreads;
+
 //
 // precalculated math tables
 //
@@ -89,7 +135,7 @@ int                     viewangletox[FINEANGLES / 2];
 // The xtoviewangleangle[] table maps a screen pixel
 // to the lowest viewangle that maps back to x ranges
 // from clipangle to -clipangle.
-angle_t                 xtoviewangle[SCREENWIDTH + 1];
+angle_t                 xtoviewangle[MAXSCREENWIDTH + 1];
 
 fixed_t                 *finecosine = &finesine[FINEANGLES / 4];
 
@@ -111,13 +157,16 @@ int                     extralight;
 dboolean                drawbloodsplats;
 
 dboolean                r_dither = r_dither_default;
+dboolean                r_drawcommands = r_drawcommands_default;
 dboolean                r_homindicator = r_homindicator_default;
 dboolean                r_shake_barrels = r_shake_barrels_default;
 dboolean                r_textures = r_textures_default;
+int                     r_threads = r_threads_default;
 dboolean                r_translucency = r_translucency_default;
 
 extern dboolean         canmodify;
 extern int              explosiontics;
+extern dboolean         inhelpscreens;
 extern int              skycolor;
 extern dboolean         transferredsky;
 extern dboolean         vanilla;
@@ -132,7 +181,7 @@ extern int              r_skycolor;
 //  check point against partition plane.
 // Returns side 0 (front) or 1 (back).
 //
-int R_PointOnSide(fixed_t x, fixed_t y, const node_t *node)
+int R_PointOnSide(fixed_t x, fixed_t y, const packednode_t *node)
 {
     return ((int64_t)(y - node->y) * node->dx + (int64_t)(node->x - x) * node->dy >= 0);
 }
@@ -378,7 +427,7 @@ void R_InitLightTables(void)
 
         for (j = 0; j < MAXLIGHTZ; j++)
         {
-            int scale = FixedDiv(SCREENWIDTH / 2 * FRACUNIT, (j + 1) << LIGHTZSHIFT);
+            int scale = FixedDiv(ORIGINALWIDTH * FRACUNIT, (j + 1) << LIGHTZSHIFT);
             int t;
             int level = BETWEEN(0, startmap - (scale >>= LIGHTSCALESHIFT) / DISTMAP,
                 NUMCOLORMAPS - 1) * 256;
@@ -418,17 +467,20 @@ void R_ExecuteSetViewSize(void)
     if (setblocks == 11)
     {
         scaledviewwidth = SCREENWIDTH;
-        viewheight = SCREENHEIGHT;
+        scaledviewheight = SCREENHEIGHT;
         viewheight2 = SCREENHEIGHT;
     }
     else
     {
         scaledviewwidth = setblocks * SCREENWIDTH / 10;
-        viewheight = (setblocks * (SCREENHEIGHT - SBARHEIGHT) / 10) & ~7;
+        scaledviewheight = (setblocks * (SCREENHEIGHT - SBARHEIGHT) / 10) & ~7;
         viewheight2 = SCREENHEIGHT - SBARHEIGHT;
     }
 
-    viewwidth = scaledviewwidth;
+    // the 3D view may be rendered at a lower resolution than the view window, and
+    //  then upscaled to fill it (see R_UpdateViewScale())
+    viewwidth = scaledviewwidth * viewscale / 100;
+    viewheight = scaledviewheight * viewscale / 100;
 
     centery = viewheight / 2;
     centerx = viewwidth / 2;
@@ -437,7 +489,7 @@ void R_ExecuteSetViewSize(void)
     projectiony = ((SCREENHEIGHT * centerx * ORIGINALWIDTH) / ORIGINALHEIGHT) / SCREENWIDTH
         * FRACUNIT;
 
-    R_InitBuffer(scaledviewwidth, viewheight);
+    R_InitBuffer(scaledviewwidth, scaledviewheight);
 
     R_InitTextureMapping();
 
@@ -499,8 +551,17 @@ void R_InitColumnFunctions(void)
         basecolfunc = R_DrawColumn;
         fuzzcolfunc = R_DrawFuzzColumn;
         transcolfunc = R_DrawTranslatedColumn;
-        wallcolfunc = R_DrawWallColumn;
-        fbwallcolfunc = R_DrawFullbrightWallColumn;
+        if (r_quadcolumns && R_InitQuadColumns())
+        {
+            wallcolfunc = R_DrawQuadWallColumn;
+            fbwallcolfunc = R_DrawQuadFullbrightWallColumn;
+        }
+        else
+        {
+            wallcolfunc = simdwallcolfunc;
+            fbwallcolfunc = R_DrawFullbrightWallColumn;
+        }
+
         if (r_skycolor != r_skycolor_default)
         {
             skycolfunc = R_DrawSkyColorColumn;
@@ -509,7 +570,7 @@ void R_InitColumnFunctions(void)
         else
             skycolfunc = (canmodify && !transferredsky && (gamemode != commercial || gamemap < 21) ?
                 R_DrawFlippedSkyColumn : R_DrawSkyColumn);
-        spanfunc = R_DrawSpan;
+        spanfunc = simdspanfunc;
 
         if (r_translucency)
         {
@@ -642,7 +703,216 @@ void R_Init(void)
     R_InitSkyMap();
     R_InitTranslationTables();
     R_InitPatches();
+
+#if defined(_DEBUG)
+    if (M_CheckParm("-testdrawers"))
+        R_TestColumnDrawers();
+#endif
+
+    R_InitSIMDDrawers();
     R_InitColumnFunctions();
+    R_InitRenderThreads();
+}
+
+//
+// R_RenderThread
+// Each additional rendering thread waits here until it is given a strip of
+//  the screen to render.
+//
+static int SDLCALL R_RenderThread(void *data)
+{
+    renderthread_t  *renderthread = data;
+
+    while (true)
+    {
+        SDL_SemWait(renderthread->start);
+
+        if (quitrenderthreads)
+            break;
+
+        renderjob(renderthread->strip);
+        SDL_SemPost(renderdone);
+    }
+
+    // free the buffers this thread allocated for itself
+    R_FreeDrawSegs();
+    R_FreePlanes();
+    R_FreeSprites();
+    R_FreeDrawCommands();
+
+    return 0;
+}
+
+//
+// R_InitRenderThreads
+// (Re)create the threads used to render the 3D view, as set by the r_threads CVAR.
+//
+void R_InitRenderThreads(void)
+{
+    int i;
+
+    // stop any threads that are already running
+    if (numrenderthreads > 1)
+    {
+        quitrenderthreads = true;
+
+        for (i = 1; i < numrenderthreads; i++)
+            SDL_SemPost(renderthreads[i].start);
+
+        for (i = 1; i < numrenderthreads; i++)
+        {
+            SDL_WaitThread(renderthreads[i].thread, NULL);
+            SDL_DestroySemaphore(renderthreads[i].start);
+        }
+
+        quitrenderthreads = false;
+        numrenderthreads = 1;
+    }
+
+    if (!renderdone)
+        renderdone = SDL_CreateSemaphore(0);
+
+    if (!rendercachelock)
+        rendercachelock = SDL_CreateMutex();
+
+    for (i = 1; i < r_threads; i++)
+    {
+        renderthread_t  *renderthread = &renderthreads[i];
+
+        renderthread->strip = i;
+
+        if (!(renderthread->start = SDL_CreateSemaphore(0)))
+            break;
+
+        if (!(renderthread->thread = SDL_CreateThread(R_RenderThread, "R_RenderThread", renderthread)))
+        {
+            SDL_DestroySemaphore(renderthread->start);
+            break;
+        }
+
+        numrenderthreads++;
+    }
+
+    if (numrenderthreads < r_threads)
+        C_Warning("Only %i of %i rendering threads could be created.", numrenderthreads, r_threads);
+
+    R_ResetRenderStats();
+}
+
+//
+// R_RunRenderJob
+// Run job once for each strip of the screen, with the first strip being
+//  done on the main thread, and wait for all of them to finish.
+//
+void R_RunRenderJob(void (*job)(int strip))
+{
+    int i;
+
+    renderjob = job;
+
+    for (i = 1; i < numrenderthreads; i++)
+        SDL_SemPost(renderthreads[i].start);
+
+    job(0);
+
+    for (i = 1; i < numrenderthreads; i++)
+        SDL_SemWait(renderdone);
+}
+
+//
+// R_LockRenderCache
+// The zone memory and texture composites are shared by all rendering
+//  threads, so must be locked while cached. The lock may be nested.
+//
+void R_LockRenderCache(void)
+{
+    if (numrenderthreads > 1)
+        SDL_LockMutex(rendercachelock);
+}
+
+void R_UnlockRenderCache(void)
+{
+    if (numrenderthreads > 1)
+        SDL_UnlockMutex(rendercachelock);
+}
+
+void R_ResetRenderStats(void)
+{
+    memset(&renderstats, 0, sizeof(renderstats));
+}
+
+uint64_t R_GetTimeUS(void)
+{
+    return (SDL_GetPerformanceCounter() * 1000000 / SDL_GetPerformanceFrequency());
+}
+
+//
+// R_ResetViewScale
+// Render the 3D view at the full resolution of the view window again.
+//
+void R_ResetViewScale(void)
+{
+    viewscaletime = 0;
+    viewscaleframes = 0;
+
+    if (viewscale != 100)
+    {
+        viewscale = 100;
+        R_SetViewSize(r_screensize);
+    }
+}
+
+//
+// R_UpdateViewScale
+// Called after each frame is rendered. Every VIEWSCALEFRAMES frames, the average
+//  time taken is compared against r_dynamicresolution_budget, and the resolution
+//  of the 3D view is lowered if it is over budget. It is only raised again if the
+//  time taken at the higher resolution (assumed to be proportional to the number
+//  of pixels) is expected to be comfortably under budget, so that it doesn't keep
+//  switching back and forth.
+//
+static void R_UpdateViewScale(uint64_t frametime)
+{
+    uint64_t    budget;
+    uint64_t    average;
+    int         scale = viewscale;
+
+    if (!r_dynamicresolution)
+        return;
+
+    viewscaletime += frametime;
+
+    if (++viewscaleframes < VIEWSCALEFRAMES)
+        return;
+
+    budget = (uint64_t)(BETWEENF(r_dynamicresolution_budget_min, r_dynamicresolution_budget,
+        r_dynamicresolution_budget_max) * 1000.0f);
+    average = viewscaletime / viewscaleframes;
+    viewscaletime = 0;
+    viewscaleframes = 0;
+
+    if (average > budget)
+        scale = MAX(VIEWSCALEMIN, viewscale - VIEWSCALESTEP);
+    else if (viewscale < 100)
+    {
+        const int   higher = MIN(100, viewscale + VIEWSCALESTEP);
+
+        if (average * higher * higher < budget * viewscale * viewscale * 9 / 10)
+            scale = higher;
+    }
+
+    if (scale != viewscale)
+    {
+        viewscalechange_t   *change = &viewscalechanges[numviewscalechanges++ % MAXVIEWSCALECHANGES];
+
+        change->gametic = gametic;
+        change->from = viewscale;
+        change->to = scale;
+        change->frametime = average;
+
+        viewscale = scale;
+        R_SetViewSize(r_screensize);
+    }
 }
 
 //
@@ -659,11 +929,66 @@ subsector_t *R_PointInSubsector(fixed_t x, fixed_t y)
     nodenum = numnodes - 1;
 
     while (!(nodenum & NF_SUBSECTOR))
-        nodenum = nodes[nodenum].children[R_PointOnSide(x, y, nodes + nodenum)];
+        nodenum = packednodes[nodenum].children[R_PointOnSide(x, y, packednodes + nodenum)];
 
     return &subsectors[nodenum & ~NF_SUBSECTOR];
 }
 
+// [AM] Interpolate the passed sector, if prudent.
+static void R_MaybeInterpolateSector(sector_t *sector)
+{
+    if (vid_capfps != TICRATE
+        // Only if we moved the sector last tic.
+        && sector->oldgametic == gametic - 1)
+    {
+        // Interpolate between current and last floor/ceiling position.
+        if (sector->floorheight != sector->oldfloorheight)
+            sector->interpfloorheight = sector->oldfloorheight
+                + FixedMul(sector->floorheight - sector->oldfloorheight, fractionaltic);
+        else
+            sector->interpfloorheight = sector->floorheight;
+        if (sector->ceilingheight != sector->oldceilingheight)
+            sector->interpceilingheight = sector->oldceilingheight
+                + FixedMul(sector->ceilingheight - sector->oldceilingheight, fractionaltic);
+        else
+            sector->interpceilingheight = sector->ceilingheight;
+    }
+    else
+    {
+        sector->interpfloorheight = sector->floorheight;
+        sector->interpceilingheight = sector->ceilingheight;
+    }
+}
+
+// Interpolate the sectors and mobjs that moved during the last tic once at the
+// start of each frame, so that all rendering threads see the same positions.
+// Everything else was left at its final position by P_Ticker().
+static void R_InterpolateMovers(void)
+{
+    int i;
+
+    for (i = 0; i < nummovingsectors; i++)
+        R_MaybeInterpolateSector(movingsectors[i]);
+
+    for (i = 0; i < nummovingmobjs; i++)
+    {
+        mobj_t  *mo = movingmobjs[i];
+
+        if (interpolatesprites)
+        {
+            mo->interpx = mo->oldx + FixedMul(mo->x - mo->oldx, fractionaltic);
+            mo->interpy = mo->oldy + FixedMul(mo->y - mo->oldy, fractionaltic);
+            mo->interpz = mo->oldz + FixedMul(mo->z - mo->oldz, fractionaltic);
+        }
+        else
+        {
+            mo->interpx = mo->x;
+            mo->interpy = mo->y;
+            mo->interpz = mo->z;
+        }
+    }
+}
+
 //
 // R_SetupFrame
 //
@@ -677,9 +1002,11 @@ void R_SetupFrame(player_t *player)
 
     // [AM] Interpolate the player camera if the feature is enabled.
 
-    // Figure out how far into the current tic we're in as a fixed_t
-    if (vid_capfps != TICRATE)
-        fractionaltic = I_GetTimeMS() * TICRATE % 1000 * FRACUNIT / 1000;
+    // Figure out how far into the current tic we're in as a fixed_t, after any tics
+    //  due this frame have been run. Frames rendered by R_BenchmarkColumnMajor() keep
+    //  the fraction of the last frame, so everything is interpolated to the same place.
+    if (vid_capfps != TICRATE && !benchmarking)
+        fractionaltic = (fixed_t)(I_GetTimeUS() * TICRATE % 1000000 * FRACUNIT / 1000000);
 
     if (vid_capfps != TICRATE
         // Don't interpolate on the first tic of a level, otherwise
@@ -705,7 +1032,7 @@ void R_SetupFrame(player_t *player)
         viewangle = mo->angle;
     }
 
-    if (explosiontics && !consoleactive && !menuactive && !paused)
+    if (explosiontics && !consoleactive && !menuactive && !paused && !benchmarking)
     {
         viewx += M_RandomInt(-2, 2) * FRACUNIT;
         viewy += M_RandomInt(-2, 2) * FRACUNIT;
@@ -735,11 +1062,12 @@ void R_SetupFrame(player_t *player)
 
     drawbloodsplats = (r_blood != r_blood_none && r_bloodsplats_max && !vanilla);
 
+    pausesprites = (menuactive || paused || consoleactive);
+    interpolatesprites = (vid_capfps != TICRATE && !pausesprites);
+
     if (player->fixedcolormap)
     {
-        // killough 3/20/98: localize scalelightfixed (readability/optimization)
-        static lighttable_t     *scalelightfixed[MAXLIGHTSCALE];
-        int                     i;
+        int     i;
 
         // killough 3/20/98: use fullcolormap
         fixedcolormap = fullcolormap + player->fixedcolormap * 256 * sizeof(lighttable_t);
@@ -752,43 +1080,116 @@ void R_SetupFrame(player_t *player)
     else
         fixedcolormap = 0;
 
+    R_InterpolateMovers();
+
     validcount++;
 }
 
 //
-// R_RenderPlayerView
+// R_RenderViewStrip
+// Render one vertical strip of the 3D view. Each thread walks the entire
+//  BSP tree, but only draws the columns inside its own strip.
 //
-void R_RenderPlayerView(player_t *player)
+static void R_RenderViewStrip(int strip)
 {
-    R_SetupFrame(player);
+    const uint64_t  starttime = R_GetTimeUS();
+
+    stripx1 = viewwidth * strip / numrenderthreads;
+    stripx2 = viewwidth * (strip + 1) / numrenderthreads - 1;
+
+    if (fixedcolormap)
+        walllights = scalelightfixed;
 
-    // Clear buffers.
     R_ClearClipSegs();
     R_ClearDrawSegs();
     R_ClearPlanes();
     R_ClearSprites();
+    R_StartDrawCommands();
 
-    NetUpdate();
+    R_RenderBSPNode(numnodes - 1);
+    R_UpdateVertexCacheStats();
+    R_DrawPlanes();
+    R_DrawMasked();
+
+    renderstats.drawcommands[strip] += R_FinishDrawCommands();
+    renderstats.striptime[strip] += R_GetTimeUS() - starttime;
+}
+
+//
+// R_RenderPlayerView
+//
+void R_RenderPlayerView(player_t *player)
+{
+    uint64_t    starttime;
+    uint64_t    frametime;
+
+    // frames rendered by R_BenchmarkColumnMajor() leave the texture cache and the fuzz
+    //  effect alone
+    if (!benchmarking)
+    {
+        R_TrimTextureCache();
+        R_PrebuildTextureComposites();
+    }
+
+    R_SetupFrame(player);
+
+    if (!benchmarking)
+        fuzzframe++;
+
+    R_ClearPlaneStats();
+    R_UpdatePVS();
+    R_UpdateDistortedFlats();
 
     if (automapactive)
     {
+        stripx1 = 0;
+        stripx2 = viewwidth - 1;
+
+        R_ClearClipSegs();
+        R_ClearDrawSegs();
+        R_ClearPlanes();
+        R_ClearSprites();
+
+        NetUpdate();
+
         R_RenderBSPNode(numnodes - 1);
 
         NetUpdate();
 
         if (r_playersprites)
             R_DrawPlayerSprites();
+
+        return;
     }
+
+    R_StartColumnMajorView();
+
+    if ((player->cheats & CF_NOCLIP) || freeze)
+        R_FillView(0);
+    else if (r_homindicator)
+        R_FillView((gametic % 20) < 9 && !consoleactive && !menuactive && !paused ? 176 : 0);
+
+    starttime = R_GetTimeUS();
+
+    if (numrenderthreads > 1 && !r_parallelplanes && !r_parallelsprites)
+        R_RunRenderJob(R_RenderViewStrip);
     else
     {
-        if ((player->cheats & CF_NOCLIP) || freeze)
-            V_FillRect(0, viewwindowx, viewwindowy, viewwidth, viewheight, 0);
-        else if (r_homindicator)
-            V_FillRect(0, viewwindowx, viewwindowy, viewwidth, viewheight,
-                ((gametic % 20) < 9 && !consoleactive && !menuactive && !paused ? 176 : 0));
+        stripx1 = 0;
+        stripx2 = viewwidth - 1;
+
+        // Clear buffers.
+        R_ClearClipSegs();
+        R_ClearDrawSegs();
+        R_ClearPlanes();
+        R_ClearSprites();
+        R_StartDrawCommands();
+
+        NetUpdate();
 
         // Make displayed player invisible locally
         R_RenderBSPNode(numnodes - 1);  // head node is the last node output
+        R_UpdateVertexCacheStats();
 
         NetUpdate();
 
@@ -798,6 +1199,178 @@ void R_RenderPlayerView(player_t *player)
 
         R_DrawMasked();
 
-        NetUpdate();
+        renderstats.drawcommands[0] += R_FinishDrawCommands();
+        renderstats.striptime[0] += R_GetTimeUS() - starttime;
     }
+
+    R_FinishColumnMajorView();
+
+    NetUpdate();
+
+    // draw the psprites on top of everything
+    if (r_playersprites && !inhelpscreens)
+        R_DrawPlayerSprites();
+
+    R_UpscaleView();
+
+    frametime = R_GetTimeUS() - starttime;
+    renderstats.frametime += frametime;
+    renderstats.frames++;
+
+    // frames rendered by R_BenchmarkColumnMajor() don't change the resolution of the view
+    if (!benchmarking)
+        R_UpdateViewScale(frametime);
+}
+
+//
+// R_BenchmarkColumnMajor
+// Render the current view the given number of times into both a row-major and a
+//  column-major framebuffer, and return the average time each frame took (in
+//  microseconds).
+//
+void R_BenchmarkColumnMajor(int frames, uint64_t *rowmajortime, uint64_t *columnmajortime)
+{
+    const dboolean          columnmajor = r_columnmajor;
+
+    // the frames rendered here are left out of the stats shown by renderstats
+    const renderstats_t     oldrenderstats = renderstats;
+    const visplanestats_t   oldvisplanestats = visplanestats;
+    int                     i;
+
+    benchmarking = true;
+
+    for (i = 0; i < 2; i++)
+    {
+        uint64_t    starttime;
+        int         j;
+
+        r_columnmajor = !!i;
+
+        // render one frame first so that the caches are warm
+        R_RenderPlayerView(&players[0]);
+        starttime = R_GetTimeUS();
+
+        for (j = 0; j < frames; j++)
+            R_RenderPlayerView(&players[0]);
+
+        *(i ? columnmajortime : rowmajortime) = (R_GetTimeUS() - starttime) / frames;
+    }
+
+    r_columnmajor = columnmajor;
+    benchmarking = false;
+
+    renderstats = oldrenderstats;
+    visplanestats = oldvisplanestats;
+}
+
+//
+// R_BenchmarkNodes
+// Look up the subsector of the given number of random points in the current map,
+//  and walk the whole BSP tree front to back from the view point the same number
+//  of times, using both nodes[] and packednodes[], and return the average time
+//  (in nanoseconds) each lookup and walk took together.
+//
+static int R_NodeSubsector(fixed_t x, fixed_t y)
+{
+    int nodenum = numnodes - 1;
+
+    while (!(nodenum & NF_SUBSECTOR))
+    {
+        const node_t    *node = nodes + nodenum;
+
+        nodenum = node->children[(int64_t)(y - node->y) * node->dx + (int64_t)(node->x - x) * node->dy >= 0];
+    }
+
+    return nodenum;
+}
+
+static int R_PackedNodeSubsector(fixed_t x, fixed_t y)
+{
+    int nodenum = numnodes - 1;
+
+    while (!(nodenum & NF_SUBSECTOR))
+        nodenum = packednodes[nodenum].children[R_PointOnSide(x, y, packednodes + nodenum)];
+
+    return nodenum;
+}
+
+static unsigned int R_WalkNodes(int bspnum, unsigned int checksum)
+{
+    while (!(bspnum & NF_SUBSECTOR))
+    {
+        const node_t    *node = nodes + bspnum;
+        const int       side = ((int64_t)(viewy - node->y) * node->dx + (int64_t)(node->x - viewx) * node->dy >= 0);
+
+        checksum = R_WalkNodes(node->children[side], checksum);
+        bspnum = node->children[side ^ 1];
+    }
+
+    return (checksum * 31 + (bspnum & ~NF_SUBSECTOR));
+}
+
+static unsigned int R_WalkPackedNodes(int bspnum, unsigned int checksum)
+{
+    while (!(bspnum & NF_SUBSECTOR))
+    {
+        const packednode_t  *node = packednodes + bspnum;
+        const int           side = R_PointOnSide(viewx, viewy, node);
+
+        if (!(node->children[side ^ 1] & NF_SUBSECTOR))
+            PREFETCH(packednodes + node->children[side ^ 1]);
+
+        checksum = R_WalkPackedNodes(node->children[side], checksum);
+        bspnum = node->children[side ^ 1];
+    }
+
+    return (checksum * 31 + (bspnum & ~NF_SUBSECTOR));
+}
+
+void R_BenchmarkNodes(int lookups, uint64_t *nodetime, uint64_t *packednodetime)
+{
+    const node_t    *root;
+    int             left, right, bottom, top;
+    fixed_t         *points;
+    int             results[2] = { 0, 0 };
+    unsigned int    checksums[2] = { 0, 0 };
+    int             i;
+
+    *nodetime = 0;
+    *packednodetime = 0;
+
+    if (!numnodes)
+        return;
+
+    root = nodes + numnodes - 1;
+    left = MIN(root->bbox[0][BOXLEFT], root->bbox[1][BOXLEFT]) >> FRACBITS;
+    right = MAX(root->bbox[0][BOXRIGHT], root->bbox[1][BOXRIGHT]) >> FRACBITS;
+    bottom = MIN(root->bbox[0][BOXBOTTOM], root->bbox[1][BOXBOTTOM]) >> FRACBITS;
+    top = MAX(root->bbox[0][BOXTOP], root->bbox[1][BOXTOP]) >> FRACBITS;
+
+    points = malloc(lookups * 2 * sizeof(*points));
+
+    for (i = 0; i < lookups * 2; i += 2)
+    {
+        points[i] = M_RandomInt(left, right) << FRACBITS;
+        points[i + 1] = M_RandomInt(bottom, top) << FRACBITS;
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        uint64_t    starttime = R_GetTimeUS();
+        int         j;
+
+        for (j = 0; j < lookups * 2; j += 2)
+            results[i] += (i ? R_PackedNodeSubsector(points[j], points[j + 1]) :
+                R_NodeSubsector(points[j], points[j + 1]));
+
+        for (j = 0; j < lookups; j++)
+            checksums[i] += (i ? R_WalkPackedNodes(numnodes - 1, 0) : R_WalkNodes(numnodes - 1, 0));
+
+        *(i ? packednodetime : nodetime) = (R_GetTimeUS() - starttime) * 1000 / lookups;
+    }
+
+    free(points);
+
+    if (results[0] != results[1] || checksums[0] != checksums[1])
+        C_Warning("The packed BSP nodes don't match the nodes in this map.");
 }
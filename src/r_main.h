@@ -101,11 +101,66 @@ extern lighttable_t     *fixedcolormap;
 //      range of [0.0, 1.0). Used for interpolation.
 extern fixed_t          fractionaltic;
 
+//
+// Multithreaded rendering.
+// The 3D view may be split into vertical strips, each rendered by its own thread.
+//
+#define MAXRENDERTHREADS        16
+
+// The first and last column of the strip drawn by the current thread.
+extern THREADLOCAL int  stripx1;
+extern THREADLOCAL int  stripx2;
+
+extern int              numrenderthreads;
+
+// Render statistics shown by the renderstats CCMD, accumulated since the last call to
+//  R_ResetRenderStats. Times are in microseconds.
+typedef struct
+{
+    int         frames;
+    uint64_t    frametime;                          // total time to render those frames
+    uint64_t    striptime[MAXRENDERTHREADS];        // each strip, or the whole 3D view
+    uint64_t    drawcommands[MAXRENDERTHREADS];     // draw commands buffered by each strip
+    uint64_t    planetime[MAXRENDERTHREADS];        // each thread drawing visplanes in parallel
+    uint64_t    maskedtime[MAXRENDERTHREADS];       // each thread drawing its tile of sprites
+    uint64_t    vertexcachehits;
+    uint64_t    vertexcachemisses;
+    uint64_t    spritesclipped;                     // sprites and blood splats clipped
+    uint64_t    drawsegsexamined;                   // drawsegs examined for them
+    uint64_t    drawsegsscanned;                    // drawsegs there were in total
+} renderstats_t;
+
+extern renderstats_t    renderstats;
+
+//
+// Dynamic resolution.
+// The 3D view may be rendered at a lower resolution and then scaled up to fill the view
+//  window, to keep the time it takes to render within r_dynamicresolution_budget.
+//
+#define VIEWSCALEMIN            50
+#define VIEWSCALESTEP           10
+#define VIEWSCALEFRAMES         16
+#define MAXVIEWSCALECHANGES     8
+
+typedef struct
+{
+    int                 gametic;
+    int                 from;
+    int                 to;
+    uint64_t            frametime;
+} viewscalechange_t;
+
+// The resolution of the 3D view, as a percentage of the size of the view window.
+extern int              viewscale;
+
+extern viewscalechange_t    viewscalechanges[MAXVIEWSCALECHANGES];
+extern int              numviewscalechanges;
+
 //
 // Function pointers to switch refresh/drawing functions.
 // Used to select shadow mode etc.
 //
-void (*colfunc)(void);
+extern THREADLOCAL void (*colfunc)(void);
 void (*wallcolfunc)(void);
 void (*fbwallcolfunc)(void);
 void (*transcolfunc)(void);
@@ -136,7 +191,7 @@ void (*supershotguncolfunc)(void);
 
 //
 // Utility functions.
-int R_PointOnSide(fixed_t x, fixed_t y, const node_t *node);
+int R_PointOnSide(fixed_t x, fixed_t y, const packednode_t *node);
 
 int R_PointOnSegSide(fixed_t x, fixed_t y, seg_t *line);
 
@@ -163,4 +218,14 @@ void R_Init(void);
 void R_SetViewSize(int blocks);
 void R_InitColumnFunctions(void);
 
+void R_InitRenderThreads(void);
+void R_LockRenderCache(void);
+void R_UnlockRenderCache(void);
+void R_ResetRenderStats(void);
+void R_RunRenderJob(void (*job)(int strip));
+uint64_t R_GetTimeUS(void);
+void R_ResetViewScale(void);
+void R_BenchmarkColumnMajor(int frames, uint64_t *rowmajortime, uint64_t *columnmajortime);
+void R_BenchmarkNodes(int lookups, uint64_t *nodetime, uint64_t *packednodetime);
+
 #endif
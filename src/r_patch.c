@@ -68,7 +68,9 @@
 
 #include "i_swap.h"
 #include "i_system.h"
+#include "m_config.h"
 #include "r_main.h"
+#include "r_draw.h"
 #include "w_wad.h"
 #include "z_zone.h"
 
@@ -91,6 +93,36 @@ static short            SKY1;
 extern int              numtextures;
 extern texture_t        **textures;
 
+//
+// Composite texture cache
+// Composite textures are kept in a list from most to least recently used, and the
+//  least recently used are freed once they take up more than r_texturecache
+//  megabytes. A texture is in the list if its size is non-zero.
+//
+typedef struct
+{
+    int                 prev;
+    int                 next;
+    int                 size;
+} compositelru_t;
+
+static compositelru_t   *compositelru;
+static int              mostrecentcomposite = -1;
+static int              leastrecentcomposite = -1;
+
+int                     r_texturecache = r_texturecache_default;
+dboolean                r_texturecache_prebuild = r_texturecache_prebuild_default;
+
+texturecachestats_t     texturecachestats;
+
+// The textures used by the current map, built ahead of time by
+//  R_PrebuildTextureComposites() when r_texturecache_prebuild is on.
+#define PREBUILDTIME    1000
+
+static int              *mapcomposites;
+static int              nummapcomposites;
+static int              nextmapcomposite;
+
 void R_InitPatches(void)
 {
     if (!patches)
@@ -99,6 +131,9 @@ void R_InitPatches(void)
     if (!texture_composites)
         texture_composites = calloc(numtextures, sizeof(rpatch_t));
 
+    if (!compositelru)
+        compositelru = calloc(numtextures, sizeof(compositelru_t));
+
     BIGDOOR7 = R_CheckTextureNumForName("BIGDOOR7");
     FIREBLU1 = R_CheckTextureNumForName("FIREBLU1");
     SKY1 = R_CheckTextureNumForName("SKY1");
@@ -141,7 +176,7 @@ static void removePostFromColumn(rcolumn_t *column, int post)
     column->numPosts--;
 }
 
-static void createTextureCompositePatch(int id)
+static int createTextureCompositePatch(int id)
 {
     rpatch_t            *composite_patch = &texture_composites[id];
     texture_t           *texture = textures[id];
@@ -386,6 +421,100 @@ static void createTextureCompositePatch(int id)
     }
 
     free(countsInColumn);
+
+    return dataSize;
+}
+
+static void R_UnlinkTextureComposite(int id)
+{
+    compositelru_t  *lru = &compositelru[id];
+
+    if (lru->prev != -1)
+        compositelru[lru->prev].next = lru->next;
+    else
+        mostrecentcomposite = lru->next;
+
+    if (lru->next != -1)
+        compositelru[lru->next].prev = lru->prev;
+    else
+        leastrecentcomposite = lru->prev;
+
+    texturecachestats.size -= lru->size;
+    texturecachestats.textures--;
+    lru->size = 0;
+}
+
+static void R_LinkTextureComposite(int id, int size, dboolean mostrecent)
+{
+    compositelru_t  *lru = &compositelru[id];
+
+    if (mostrecent)
+    {
+        lru->prev = -1;
+        lru->next = mostrecentcomposite;
+
+        if (mostrecentcomposite != -1)
+            compositelru[mostrecentcomposite].prev = id;
+        else
+            leastrecentcomposite = id;
+
+        mostrecentcomposite = id;
+    }
+    else
+    {
+        lru->prev = leastrecentcomposite;
+        lru->next = -1;
+
+        if (leastrecentcomposite != -1)
+            compositelru[leastrecentcomposite].next = id;
+        else
+            mostrecentcomposite = id;
+
+        leastrecentcomposite = id;
+    }
+
+    texturecachestats.size += size;
+    texturecachestats.textures++;
+    lru->size = size;
+}
+
+//
+// R_TrimTextureCache
+// Free the least recently used composite textures that aren't locked
+//  until they no longer take up more than r_texturecache megabytes.
+//  This is only done on the main thread between frames, as columns of a
+//  composite may still be waiting in a draw command buffer after it has been
+//  unlocked. The cache can grow past r_texturecache during a frame.
+//
+void R_TrimTextureCache(void)
+{
+    const int64_t   maxsize = (int64_t)r_texturecache * 1024 * 1024;
+    int             id;
+
+    R_LockRenderCache();
+
+    id = leastrecentcomposite;
+
+    while (id != -1 && texturecachestats.size > maxsize)
+    {
+        const int   prev = compositelru[id].prev;
+
+        if (!texture_composites[id].locks)
+        {
+            // the zone may have already freed it if it ran out of memory
+            if (texture_composites[id].data)
+            {
+                Z_Free(texture_composites[id].data);
+                texturecachestats.evictions++;
+            }
+
+            R_UnlinkTextureComposite(id);
+        }
+
+        id = prev;
+    }
+
+    R_UnlockRenderCache();
 }
 
 rpatch_t *R_CacheTextureCompositePatchNum(int id)
@@ -393,21 +522,132 @@ rpatch_t *R_CacheTextureCompositePatchNum(int id)
     if (!texture_composites)
         I_Error("R_CacheTextureCompositePatchNum: Composite patches not initialized");
 
-    if (!texture_composites[id].data)
-        createTextureCompositePatch(id);
+    // [BH] composites may be requested by several rendering threads at once
+    R_LockRenderCache();
+
+    if (texture_composites[id].data)
+    {
+        texturecachestats.hits++;
+
+        if (id != mostrecentcomposite)
+        {
+            const int   size = compositelru[id].size;
+
+            R_UnlinkTextureComposite(id);
+            R_LinkTextureComposite(id, size, true);
+        }
+    }
+    else
+    {
+        texturecachestats.misses++;
+
+        if (compositelru[id].size)
+            R_UnlinkTextureComposite(id);
+
+        R_LinkTextureComposite(id, createTextureCompositePatch(id), true);
+    }
 
     // cph - if wasn't locked but now is, tell z_zone to hold it
     if (!texture_composites[id].locks)
         Z_ChangeTag(texture_composites[id].data, PU_STATIC);
     texture_composites[id].locks++;
 
+    R_UnlockRenderCache();
+
     return &texture_composites[id];
 }
 
 void R_UnlockTextureCompositePatchNum(int id)
 {
+    // [BH] columns of the composite may still be waiting in the draw command buffer, so
+    //  keep it locked until they have been drawn
+    if (drawcommands)
+    {
+        R_AddUnlockCommand(id);
+        return;
+    }
+
+    R_LockRenderCache();
+
     if (!--texture_composites[id].locks)
         Z_ChangeTag(texture_composites[id].data, PU_CACHE);
+
+    R_UnlockRenderCache();
+}
+
+//
+// R_UnlockTextureComposites
+// Called by R_FlushDrawCommands() once the columns of these composites have been drawn.
+//
+void R_UnlockTextureComposites(const int *ids, int count)
+{
+    int i;
+
+    R_LockRenderCache();
+
+    for (i = 0; i < count; i++)
+        if (!--texture_composites[ids[i]].locks)
+            Z_ChangeTag(texture_composites[ids[i]].data, PU_CACHE);
+
+    R_UnlockRenderCache();
+}
+
+//
+// R_SetMapTextureComposites
+// Called by R_PrecacheLevel() with the textures used by the current map.
+//
+void R_SetMapTextureComposites(byte *hitlist)
+{
+    int i;
+
+    if (!mapcomposites)
+        mapcomposites = malloc(numtextures * sizeof(*mapcomposites));
+
+    nummapcomposites = 0;
+    nextmapcomposite = 0;
+
+    for (i = 0; i < numtextures; i++)
+        if (hitlist[i])
+            mapcomposites[nummapcomposites++] = i;
+}
+
+//
+// R_PrebuildTextureComposites
+// Called once a frame to build the textures used by the current map that haven't
+//  been built yet, or have since been freed, for up to PREBUILDTIME microseconds.
+//  This is done on the main thread, between frames, as neither the zone nor the WAD
+//  cache can be used by more than one thread. Textures are only built while there
+//  is room for them in the cache, so they don't cause others to be freed, and are
+//  added as the least recently used.
+//
+void R_PrebuildTextureComposites(void)
+{
+    const int64_t   maxsize = (int64_t)r_texturecache * 1024 * 1024 * 7 / 8;
+    uint64_t        starttime;
+    int             i;
+
+    if (!r_texturecache_prebuild || !nummapcomposites)
+        return;
+
+    starttime = R_GetTimeUS();
+
+    for (i = 0; i < nummapcomposites && texturecachestats.size < maxsize
+        && R_GetTimeUS() - starttime < PREBUILDTIME; i++)
+    {
+        const int   id = mapcomposites[nextmapcomposite];
+
+        nextmapcomposite = (nextmapcomposite + 1) % nummapcomposites;
+
+        if (!texture_composites[id].data)
+        {
+            if (compositelru[id].size)
+                R_UnlinkTextureComposite(id);
+
+            R_LinkTextureComposite(id, createTextureCompositePatch(id), false);
+            Z_ChangeTag(texture_composites[id].data, PU_CACHE);
+            texturecachestats.prebuilt++;
+        }
+    }
 }
 
 rcolumn_t *R_GetPatchColumnWrapped(rpatch_t *patch, int columnIndex)
@@ -70,8 +70,26 @@ typedef struct
     unsigned int        locks;
 } rpatch_t;
 
+typedef struct
+{
+    int64_t             size;           // bytes used by the cached composite textures
+    int                 textures;
+    uint64_t            hits;
+    uint64_t            misses;
+    uint64_t            evictions;
+    uint64_t            prebuilt;
+} texturecachestats_t;
+
+extern int                  r_texturecache;
+extern dboolean             r_texturecache_prebuild;
+extern texturecachestats_t  texturecachestats;
+
 rpatch_t *R_CacheTextureCompositePatchNum(int id);
 void R_UnlockTextureCompositePatchNum(int id);
+void R_UnlockTextureComposites(const int *ids, int count);
+void R_TrimTextureCache(void);
+void R_SetMapTextureComposites(byte *hitlist);
+void R_PrebuildTextureComposites(void);
 
 rcolumn_t *R_GetPatchColumnWrapped(rpatch_t *patch, int columnIndex);
 rcolumn_t *R_GetPatchColumnClamped(rpatch_t *patch, int columnIndex);
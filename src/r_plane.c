@@ -43,51 +43,89 @@
 #include "w_wad.h"
 #include "z_zone.h"
 
-#define MAXVISPLANES    128                             // must be a power of 2
+#define MINVISPLANEBUCKETS  128                         // must be a power of 2
+#define MAXVISPLANEBUCKETS  16384
+#define VISPLANEBLOCKSIZE   64
 
-static visplane_t       *visplanes[MAXVISPLANES];       // killough
-static visplane_t       *freetail;                      // killough
-static visplane_t       **freehead = &freetail;         // killough
-visplane_t              *floorplane;
-visplane_t              *ceilingplane;
+// Visplanes are allocated VISPLANEBLOCKSIZE at a time, with the top and bottom arrays
+//  of all of them following the block. The blocks are kept from one frame to the next.
+typedef struct visplaneblock_s
+{
+    visplane_t                  visplanes[VISPLANEBLOCKSIZE];
+    struct visplaneblock_s      *next;
+} visplaneblock_t;
+
+// Each rendering thread builds its own set of visplanes for its strip of the screen.
+static THREADLOCAL visplane_t   **visplanes;                    // killough
+static THREADLOCAL int          numvisplanebuckets;
+static THREADLOCAL int          numvisplanes;
+static THREADLOCAL visplaneblock_t  *visplaneblocks;
+static THREADLOCAL visplaneblock_t  *currentvisplaneblock;
+static THREADLOCAL int          numblockvisplanes;
+static THREADLOCAL int          visplanewidth;
+static THREADLOCAL int          longestvisplanechain;
+static THREADLOCAL int          numvisplanesplits;
+THREADLOCAL visplane_t          *floorplane;
+THREADLOCAL visplane_t          *ceilingplane;
+
+visplanestats_t                 visplanestats;
 
 // killough -- hash function for visplanes
 // Empirically verified to be fairly uniform:
 #define visplane_hash(picnum, lightlevel, height) \
     (((unsigned int)(picnum) * 3 + (unsigned int)(lightlevel) + \
-    (unsigned int)(height) * 7) & (MAXVISPLANES - 1))
+    (unsigned int)(height) * 7) & (numvisplanebuckets - 1))
 
-size_t                 maxopenings;
-int                    *openings;                       // dropoff overflow
-int                    *lastopening;                    // dropoff overflow
+THREADLOCAL size_t              maxopenings;
+THREADLOCAL int                 *openings;              // dropoff overflow
+THREADLOCAL int                 *lastopening;           // dropoff overflow
 
 // Clip values are the solid pixel bounding the range.
 //  floorclip starts out SCREENHEIGHT
 //  ceilingclip starts out -1
-int                     floorclip[SCREENWIDTH];         // dropoff overflow
-int                     ceilingclip[SCREENWIDTH];       // dropoff overflow
+THREADLOCAL int                 floorclip[MAXSCREENWIDTH];     // dropoff overflow
+THREADLOCAL int                 ceilingclip[MAXSCREENWIDTH];   // dropoff overflow
 
 // spanstart holds the start of a plane span
 // initialized to 0 at start
-static int              spanstart[SCREENHEIGHT];
+static THREADLOCAL int          spanstart[MAXSCREENHEIGHT];
 
 // texture mapping
-static lighttable_t     **planezlight;
-static fixed_t          planeheight;
+static THREADLOCAL lighttable_t **planezlight;
+static THREADLOCAL fixed_t      planeheight;
+
+static THREADLOCAL fixed_t      xoffs, yoffs;           // killough 2/28/98: flat offsets
+
+fixed_t                         yslope[MAXSCREENHEIGHT];
+fixed_t                         distscale[MAXSCREENWIDTH];
 
-static fixed_t          xoffs, yoffs;                   // killough 2/28/98: flat offsets
+static THREADLOCAL fixed_t      cachedheight[MAXSCREENHEIGHT];
+static THREADLOCAL fixed_t      cacheddistance[MAXSCREENHEIGHT];
+static THREADLOCAL fixed_t      cachedxstep[MAXSCREENHEIGHT];
+static THREADLOCAL fixed_t      cachedystep[MAXSCREENHEIGHT];
 
-fixed_t                 yslope[SCREENHEIGHT];
-fixed_t                 distscale[SCREENWIDTH];
+// the rows of the visplane being drawn by the current thread
+static THREADLOCAL int          planetop;
+static THREADLOCAL int          planebottom;
 
-fixed_t                 cachedheight[SCREENHEIGHT];
-fixed_t                 cacheddistance[SCREENHEIGHT];
-fixed_t                 cachedxstep[SCREENHEIGHT];
-fixed_t                 cachedystep[SCREENHEIGHT];
+// visplanes to be drawn in parallel by R_DrawPlanesJob()
+typedef struct
+{
+    visplane_t                  *pl;
+    int                         top;
+    int                         bottom;
+    int                         thread;                 // -1 if split into row bands
+} drawplane_t;
+
+static drawplane_t              *drawplanes;
+static int                      numdrawplanes;
+static int                      maxdrawplanes;
 
 int                     skycolor;
 
 dboolean                r_liquid_swirl = r_liquid_swirl_default;
+dboolean                r_parallelplanes = r_parallelplanes_default;
+dboolean                r_planestats = r_planestats_default;
 int                     r_skycolor = r_skycolor_default;
 
 //
@@ -105,7 +143,7 @@ static void R_MapPlane(int y, int x1, int x2)
     fixed_t     distance;
     int         dx, dy;
 
-    if (!(dy = ABS(centery - y)))
+    if (!(dy = ABS(centery - y)) || y < planetop || y > planebottom)
         return;
 
     if (planeheight != cachedheight[y])
@@ -133,7 +171,7 @@ static void R_MapPlane(int y, int x1, int x2)
     ds_x1 = x1;
     ds_x2 = x2;
 
-    spanfunc();
+    R_SpanCommand(spanfunc);
 }
 
 //
@@ -144,6 +182,45 @@ void R_ClearPlanes(void)
 {
     int i;
 
+    // the blocks of visplanes are only big enough for the SCREENWIDTH they were allocated for
+    if (visplanewidth != SCREENWIDTH)
+    {
+        while (visplaneblocks)
+        {
+            visplaneblock_t *next = visplaneblocks->next;
+
+            free(visplaneblocks);
+            visplaneblocks = next;
+        }
+
+        visplanewidth = SCREENWIDTH;
+    }
+
+    if (!visplanes)
+    {
+        numvisplanebuckets = MINVISPLANEBUCKETS;
+        visplanes = calloc(numvisplanebuckets, sizeof(*visplanes));
+    }
+    else if (numvisplanebuckets > MINVISPLANEBUCKETS && numvisplanes < numvisplanebuckets / 8)
+    {
+        // shrink the hash again once far fewer visplanes are being found than it was
+        //  grown for, so it isn't cleared in full every frame after one busy scene
+        do
+            numvisplanebuckets /= 2;
+        while (numvisplanebuckets > MINVISPLANEBUCKETS && numvisplanes < numvisplanebuckets / 8);
+
+        free(visplanes);
+        visplanes = calloc(numvisplanebuckets, sizeof(*visplanes));
+    }
+    else
+        memset(visplanes, 0, numvisplanebuckets * sizeof(*visplanes));
+
+    currentvisplaneblock = NULL;
+    numblockvisplanes = 0;
+    numvisplanes = 0;
+    longestvisplanechain = 0;
+    numvisplanesplits = 0;
+
     // opening/clipping determination
     for (i = 0; i < viewwidth; i++)
     {
@@ -154,22 +231,115 @@ void R_ClearPlanes(void)
     // texture calculation
     memset(cachedheight, 0, sizeof(cachedheight));
 
-    for (i = 0; i < MAXVISPLANES; i++)  // new code -- killough
-        for (*freehead = visplanes[i], visplanes[i] = NULL; *freehead;)
-            freehead = &(*freehead)->next;
-
     lastopening = openings;
 }
 
+//
+// R_FreePlanes
+// Called by each rendering thread before it exits, to free its own buffers.
+//
+void R_FreePlanes(void)
+{
+    while (visplaneblocks)
+    {
+        visplaneblock_t *next = visplaneblocks->next;
+
+        free(visplaneblocks);
+        visplaneblocks = next;
+    }
+
+    currentvisplaneblock = NULL;
+    visplanewidth = 0;
+
+    free(visplanes);
+    visplanes = NULL;
+    numvisplanebuckets = 0;
+
+    free(openings);
+    openings = lastopening = NULL;
+    maxopenings = 0;
+}
+
+//
+// R_GrowVisplaneHash
+// Double the number of hash chains, so they stay short however many visplanes there are.
+//
+static void R_GrowVisplaneHash(void)
+{
+    visplane_t  **oldvisplanes = visplanes;
+    const int   oldnumvisplanebuckets = numvisplanebuckets;
+    int         i;
+
+    numvisplanebuckets *= 2;
+    visplanes = calloc(numvisplanebuckets, sizeof(*visplanes));
+
+    for (i = 0; i < oldnumvisplanebuckets; i++)
+    {
+        visplane_t  *pl = oldvisplanes[i];
+
+        while (pl)
+        {
+            visplane_t      *next = pl->next;
+            unsigned int    hash = visplane_hash(pl->picnum, pl->lightlevel, pl->height);
+
+            pl->next = visplanes[hash];
+            visplanes[hash] = pl;
+            pl = next;
+        }
+    }
+
+    free(oldvisplanes);
+}
+
+//
+// R_NewVisplaneBlock
+//
+static visplaneblock_t *R_NewVisplaneBlock(void)
+{
+    const int       stride = SCREENWIDTH * 2 + 4;
+    visplaneblock_t *block = malloc(sizeof(*block) + VISPLANEBLOCKSIZE * stride * sizeof(unsigned short));
+    unsigned short  *columns = (unsigned short *)(block + 1);
+    int             i;
+
+    for (i = 0; i < VISPLANEBLOCKSIZE; i++, columns += stride)
+    {
+        block->visplanes[i].top = columns + 1;
+        block->visplanes[i].bottom = columns + SCREENWIDTH + 3;
+    }
+
+    block->next = NULL;
+    return block;
+}
+
 // New function, by Lee Killough
-static visplane_t *new_visplane(unsigned hash)
+static visplane_t *new_visplane(int picnum, int lightlevel, fixed_t height)
 {
-    visplane_t  *check = freetail;
+    visplane_t      *check;
+    unsigned int    hash;
+
+    if (!currentvisplaneblock || numblockvisplanes == VISPLANEBLOCKSIZE)
+    {
+        visplaneblock_t *next = (currentvisplaneblock ? currentvisplaneblock->next : visplaneblocks);
+
+        if (!next)
+        {
+            next = R_NewVisplaneBlock();
+
+            if (currentvisplaneblock)
+                currentvisplaneblock->next = next;
+            else
+                visplaneblocks = next;
+        }
+
+        currentvisplaneblock = next;
+        numblockvisplanes = 0;
+    }
+
+    if (++numvisplanes > numvisplanebuckets * 2 && numvisplanebuckets < MAXVISPLANEBUCKETS)
+        R_GrowVisplaneHash();
 
-    if (!check)
-        check = calloc(1, sizeof(*check));
-    else if (!(freetail = freetail->next))
-        freehead = &freetail;
+    check = &currentvisplaneblock->visplanes[numblockvisplanes++];
+    hash = visplane_hash(picnum, lightlevel, height);
     check->next = visplanes[hash];
     visplanes[hash] = check;
     return check;
@@ -182,6 +352,7 @@ visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel, fixed_t xoff
 {
     visplane_t          *check;
     unsigned int        hash;                                   // killough
+    int                 chain = 0;
 
     if (picnum == skyflatnum || (picnum & PL_SKYFLAT))          // killough 10/98
     {
@@ -193,11 +364,20 @@ visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel, fixed_t xoff
     hash = visplane_hash(picnum, lightlevel, height);
 
     for (check = visplanes[hash]; check; check = check->next)   // killough
+    {
+        chain++;
+
         if (height == check->height && picnum == check->picnum && lightlevel == check->lightlevel
             && xoffs == check->xoffs && yoffs == check->yoffs)
-            return check;
+            break;
+    }
 
-    check = new_visplane(hash);                                 // killough
+    longestvisplanechain = MAX(longestvisplanechain, chain);
+
+    if (check)
+        return check;
+
+    check = new_visplane(picnum, lightlevel, height);           // killough
 
     check->height = height;
     check->picnum = picnum;
@@ -207,7 +387,7 @@ visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel, fixed_t xoff
     check->xoffs = xoffs;                                      // killough 2/28/98: Save offsets
     check->yoffs = yoffs;
 
-    memset(check->top, USHRT_MAX, sizeof(check->top));
+    memset(check->top, USHRT_MAX, SCREENWIDTH * sizeof(*check->top));
 
     return check;
 }
@@ -256,8 +436,9 @@ visplane_t *R_CheckPlane(visplane_t *pl, int start, int stop)
     }
     else
     {
-        unsigned int    hash = visplane_hash(pl->picnum, pl->lightlevel, pl->height);
-        visplane_t      *new_pl = new_visplane(hash);
+        visplane_t      *new_pl = new_visplane(pl->picnum, pl->lightlevel, pl->height);
+
+        numvisplanesplits++;
 
         new_pl->height = pl->height;
         new_pl->picnum = pl->picnum;
@@ -268,7 +449,7 @@ visplane_t *R_CheckPlane(visplane_t *pl, int start, int stop)
         pl = new_pl;
         pl->minx = start;
         pl->maxx = stop;
-        memset(pl->top, USHRT_MAX, sizeof(pl->top));
+        memset(pl->top, USHRT_MAX, SCREENWIDTH * sizeof(*pl->top));
     }
 
     return pl;
@@ -311,181 +492,406 @@ static void R_MakeSpans(visplane_t *pl)
 // 1 cycle per 32 units (2 in 64)
 #define SWIRLFACTOR2    (8192 / 32)
 
-static byte     *normalflat;
-static byte     distortedflat[4096];
+// Distorted copies of every liquid flat that has been drawn since the offsets
+//  were last changed, shared by all rendering threads.
+static byte     **distortedflats;
+static int      *distortedflatgenerations;
+static int      swirlgeneration;
+static int      swirltic = -1;
+static int      swirloffset[4096];
+
+//
+// R_UpdateDistortedFlats
+//
+// Called once per frame, before any rendering threads are started. Builds the
+// table of offsets used to distort every liquid flat whenever a new tic has
+// started, which invalidates the distorted flats built during the last one.
+// The two sine waves along each axis only depend on one of x or y, so they are
+// looked up once per row and column rather than once per texel.
+//
+void R_UpdateDistortedFlats(void)
+{
+    int leveltic = gametic;
+    int xwave1[64], xwave2[64];
+    int ywave1[64], ywave2[64];
+    int x, y;
+
+    if (!distortedflats)
+    {
+        distortedflats = calloc(numflats, sizeof(*distortedflats));
+        distortedflatgenerations = calloc(numflats, sizeof(*distortedflatgenerations));
+    }
+
+    // built this tic?
+    if (leveltic == swirltic || freeze || (consoleactive && swirltic != -1) || menuactive
+        || paused)
+        return;
+
+    leveltic *= SPEED;
+
+    for (x = 0; x < 64; x++)
+    {
+        xwave1[x] = ((finesine[(x * SWIRLFACTOR2 + leveltic * 4 + 300) & 8191] * AMP2) >> FRACBITS);
+        xwave2[x] = ((finesine[(x * SWIRLFACTOR + leveltic * 3 + 700) & 8191] * AMP) >> FRACBITS);
+    }
+
+    for (y = 0; y < 64; y++)
+    {
+        ywave1[y] = ((finesine[(y * SWIRLFACTOR + leveltic * 5 + 900) & 8191] * AMP) >> FRACBITS);
+        ywave2[y] = ((finesine[(y * SWIRLFACTOR2 + leveltic * 4 + 1200) & 8191] * AMP2) >> FRACBITS);
+    }
+
+    for (y = 0; y < 64; y++)
+    {
+        int         *offset = &swirloffset[y << 6];
+        const int   x1 = 128 + ywave1[y];
+        const int   y1 = y + 128 + ywave2[y];
+
+        for (x = 0; x < 64; x++)
+            offset[x] = (((y1 + xwave2[x]) & 63) << 6) + ((x + x1 + xwave1[x]) & 63);
+    }
+
+    swirltic = gametic;
+    swirlgeneration++;
+}
 
 //
 // R_DistortedFlat
 //
 // Generates a distorted flat from a normal one using a two-dimensional
-// sine wave pattern.
+// sine wave pattern. Each flat is only distorted the first time it is
+// drawn after R_UpdateDistortedFlats() has changed the offsets.
 //
 static byte *R_DistortedFlat(int flatnum)
 {
-    static int  lastflat = -1;
-    static int  swirltic = -1;
-    static int  offset[4096];
-    int         i;
-    int         leveltic = gametic;
+    byte    *distortedflat;
 
-    // Already swirled this one?
-    if (leveltic == swirltic && lastflat == flatnum)
-        return distortedflat;
+    R_LockRenderCache();
 
-    lastflat = flatnum;
+    if (!(distortedflat = distortedflats[flatnum]))
+    {
+        distortedflat = distortedflats[flatnum] = malloc(4096);
+        distortedflatgenerations[flatnum] = swirlgeneration - 1;
+    }
 
-    // built this tic?
-    if (leveltic != swirltic && !freeze && (!consoleactive || swirltic == -1) && !menuactive
-        && !paused)
+    if (distortedflatgenerations[flatnum] != swirlgeneration)
     {
-        int     x, y;
+        const byte  *normalflat = W_CacheLumpNum(firstflat + flatnum, PU_LEVEL);
+        int         i;
 
-        leveltic *= SPEED;
-        for (x = 0; x < 64; x++)
-            for (y = 0; y < 64; y++)
-            {
-                int     x1, y1;
-                int     sinvalue, sinvalue2;
+        for (i = 0; i < 4096; i++)
+            distortedflat[i] = normalflat[swirloffset[i]];
+
+        distortedflatgenerations[flatnum] = swirlgeneration;
+    }
 
-                sinvalue = (y * SWIRLFACTOR + leveltic * 5 + 900) & 8191;
-                sinvalue2 = (x * SWIRLFACTOR2 + leveltic * 4 + 300) & 8191;
-                x1 = x + 128 + ((finesine[sinvalue] * AMP) >> FRACBITS)
-                    + ((finesine[sinvalue2] * AMP2) >> FRACBITS);
+    R_UnlockRenderCache();
+
+    return distortedflat;
+}
 
-                sinvalue = (x * SWIRLFACTOR + leveltic * 3 + 700) & 8191;
-                sinvalue2 = (y * SWIRLFACTOR2 + leveltic * 4 + 1200) & 8191;
-                y1 = y + 128 + ((finesine[sinvalue] * AMP) >> FRACBITS)
-                    + ((finesine[sinvalue2] * AMP2) >> FRACBITS);
+//
+// R_DrawPlane
+// Draw the rows of a visplane from planetop to planebottom.
+//
+static void R_DrawPlane(visplane_t *pl)
+{
+    int picnum = pl->picnum;
 
-                offset[(y << 6) + x] = ((y1 & 63) << 6) + (x1 & 63);
+    // sky flat
+    if (picnum == skyflatnum || (picnum & PL_SKYFLAT))
+    {
+        int         x;
+        int         texture;
+        int         offset;
+        angle_t     flip;
+        rpatch_t    *tex_patch;
+
+        // killough 10/98: allow skies to come from sidedefs.
+        // Allows scrolling and/or animated skies, as well as
+        // arbitrary multiple skies per level without having
+        // to use info lumps.
+        angle_t     an = viewangle;
+
+        if (picnum & PL_SKYFLAT)
+        {
+            // Sky Linedef
+            const line_t    *l = &lines[picnum & ~PL_SKYFLAT];
+
+            // Sky transferred from first sidedef
+            const side_t    *s = *l->sidenum + sides;
+
+            // Texture comes from upper texture of reference sidedef
+            texture = texturetranslation[s->toptexture];
+
+            // Horizontal offset is turned into an angle offset,
+            // to allow sky rotation as well as careful positioning.
+            // However, the offset is scaled very small, so that it
+            // allows a long-period of sky rotation.
+            an += s->textureoffset;
+
+            // Vertical offset allows careful sky positioning.
+            dc_texturemid = s->rowoffset - 28 * FRACUNIT;
+
+            // We sometimes flip the picture horizontally.
+            //
+            // DOOM always flipped the picture, so we make it optional,
+            // to make it easier to use the new feature, while to still
+            // allow old sky textures to be used.
+            flip = (l->special == TransferSkyTextureToTaggedSectors_Flipped ?
+                0u : ~0u);
+        }
+        else        // Normal DOOM sky, only one allowed per level
+        {
+            dc_texturemid = skytexturemid;  // Default y-offset
+            texture = skytexture;           // Default texture
+            flip = 0;                       // DOOM flips it
+        }
+
+        dc_colormap = (fixedcolormap ? fixedcolormap : fullcolormap);
+
+        dc_texheight = textureheight[texture] >> FRACBITS;
+        dc_iscale = pspriteiscale;
+
+        tex_patch = R_CacheTextureCompositePatchNum(texture);
+
+        offset = skycolumnoffset >> FRACBITS;
+
+        for (x = pl->minx; x <= pl->maxx; x++)
+        {
+            dc_yl = MAX(pl->top[x], planetop);
+            dc_yh = MIN(pl->bottom[x], planebottom);
+
+            if (dc_yl <= dc_yh)
+            {
+                dc_x = x;
+                dc_source = R_GetTextureColumn(tex_patch,
+                    (((an + xtoviewangle[x]) ^ flip) >> ANGLETOSKYSHIFT) + offset);
+                R_ColumnCommand(skycolfunc);
             }
+        }
 
-        swirltic = gametic;
+        R_UnlockTextureCompositePatchNum(texture);
+    }
+    else
+    {
+        // regular flat
+        dboolean        swirling = (isliquid[picnum] && r_liquid_swirl && !freeze);
+        int             lumpnum = firstflat + flattranslation[picnum];
+
+        if (swirling)
+            ds_source = R_DistortedFlat(picnum);
+        else
+        {
+            R_LockRenderCache();
+            ds_source = W_CacheLumpNum(lumpnum, PU_STATIC);
+            R_UnlockRenderCache();
+        }
+
+        xoffs = pl->xoffs;  // killough 2/28/98: Add offsets
+        yoffs = pl->yoffs;
+        planeheight = ABS(pl->height - viewz);
+
+        planezlight = zlight[BETWEEN(0, (pl->lightlevel >> LIGHTSEGSHIFT)
+            + extralight * LIGHTBRIGHT, LIGHTLEVELS - 1)];
+
+        R_MakeSpans(pl);
+
+        if (!swirling)
+        {
+            // the spans may still be waiting in the draw command buffer, so keep the
+            //  flat until they have been drawn
+            if (drawcommands)
+                R_AddReleaseCommand(lumpnum);
+            else
+            {
+                R_LockRenderCache();
+                W_ReleaseLumpNum(lumpnum);
+                R_UnlockRenderCache();
+            }
+        }
     }
+}
 
-    normalflat = W_CacheLumpNum(firstflat + flatnum, PU_LEVEL);
+//
+// R_DrawPlanesJob
+// Draw the visplanes given to this thread by R_DrawPlanes(), and this thread's
+//  band of rows of each visplane that was too large to give to just one thread.
+//
+static void R_DrawPlanesJob(int strip)
+{
+    const uint64_t  starttime = R_GetTimeUS();
+    const int       bandtop = viewheight * strip / numrenderthreads;
+    const int       bandbottom = viewheight * (strip + 1) / numrenderthreads - 1;
+    int             i;
 
-    for (i = 0; i < 4096; i++)
-        distortedflat[i] = normalflat[offset[i]];
+    // the span cache of a worker thread is otherwise only cleared by R_ClearPlanes()
+    memset(cachedheight, 0, sizeof(cachedheight));
 
-    return distortedflat;
+    for (i = 0; i < numdrawplanes; i++)
+    {
+        const drawplane_t   *drawplane = &drawplanes[i];
+
+        if (drawplane->thread == strip)
+        {
+            planetop = drawplane->top;
+            planebottom = drawplane->bottom;
+        }
+        else if (drawplane->thread == -1 && drawplane->top <= bandbottom
+            && drawplane->bottom >= bandtop)
+        {
+            planetop = MAX(drawplane->top, bandtop);
+            planebottom = MIN(drawplane->bottom, bandbottom);
+        }
+        else
+            continue;
+
+        R_DrawPlane(drawplane->pl);
+    }
+
+    renderstats.planetime[strip] += R_GetTimeUS() - starttime;
 }
 
 //
-// R_DrawPlanes
-// At the end of each frame.
+// R_DrawPlanesInParallel
+// Share the visplanes between the rendering threads, giving each small visplane
+//  to whichever thread has the fewest pixels to draw so far, and splitting large
+//  visplanes into a band of rows for every thread. Visplanes never overlap, so
+//  the threads don't need to be synchronized.
 //
-void R_DrawPlanes(void)
+static void R_DrawPlanesInParallel(void)
 {
-    int i;
+    const int   maxarea = viewwidth * viewheight / (numrenderthreads * 4);
+    int         load[MAXRENDERTHREADS] = { 0 };
+    int         i;
 
-    for (i = 0; i < MAXVISPLANES; i++)
+    numdrawplanes = 0;
+
+    for (i = 0; i < numvisplanebuckets; i++)
     {
-        visplane_t      *pl;
+        visplane_t  *pl;
 
         for (pl = visplanes[i]; pl; pl = pl->next)
-            if (pl->minx <= pl->maxx)
-            {
-                int     picnum = pl->picnum;
-
-                // sky flat
-                if (picnum == skyflatnum || (picnum & PL_SKYFLAT))
+        {
+            drawplane_t *drawplane;
+            int         top = viewheight;
+            int         bottom = -1;
+            int         area;
+            int         x;
+
+            if (pl->minx > pl->maxx)
+                continue;
+
+            for (x = pl->minx; x <= pl->maxx; x++)
+                if (pl->top[x] <= pl->bottom[x])
                 {
-                    int         x;
-                    int         texture;
-                    int         offset;
-                    angle_t     flip;
-                    rpatch_t    *tex_patch;
-
-                    // killough 10/98: allow skies to come from sidedefs.
-                    // Allows scrolling and/or animated skies, as well as
-                    // arbitrary multiple skies per level without having
-                    // to use info lumps.
-                    angle_t     an = viewangle;
-
-                    if (picnum & PL_SKYFLAT)
-                    {
-                        // Sky Linedef
-                        const line_t    *l = &lines[picnum & ~PL_SKYFLAT];
-
-                        // Sky transferred from first sidedef
-                        const side_t    *s = *l->sidenum + sides;
-
-                        // Texture comes from upper texture of reference sidedef
-                        texture = texturetranslation[s->toptexture];
-
-                        // Horizontal offset is turned into an angle offset,
-                        // to allow sky rotation as well as careful positioning.
-                        // However, the offset is scaled very small, so that it
-                        // allows a long-period of sky rotation.
-                        an += s->textureoffset;
-
-                        // Vertical offset allows careful sky positioning.
-                        dc_texturemid = s->rowoffset - 28 * FRACUNIT;
-
-                        // We sometimes flip the picture horizontally.
-                        //
-                        // DOOM always flipped the picture, so we make it optional,
-                        // to make it easier to use the new feature, while to still
-                        // allow old sky textures to be used.
-                        flip = (l->special == TransferSkyTextureToTaggedSectors_Flipped ?
-                            0u : ~0u);
-                    }
-                    else        // Normal DOOM sky, only one allowed per level
-                    {
-                        dc_texturemid = skytexturemid;  // Default y-offset
-                        texture = skytexture;           // Default texture
-                        flip = 0;                       // DOOM flips it
-                    }
-
-                    dc_colormap = (fixedcolormap ? fixedcolormap : fullcolormap);
-
-                    dc_texheight = textureheight[texture] >> FRACBITS;
-                    dc_iscale = pspriteiscale;
-
-                    tex_patch = R_CacheTextureCompositePatchNum(texture);
-
-                    offset = skycolumnoffset >> FRACBITS;
-
-                    for (x = pl->minx; x <= pl->maxx; x++)
-                    {
-                        dc_yl = pl->top[x];
-                        dc_yh = pl->bottom[x];
-
-                        if (dc_yl <= dc_yh)
-                        {
-                            dc_x = x;
-                            dc_source = R_GetTextureColumn(tex_patch,
-                                (((an + xtoviewangle[x]) ^ flip) >> ANGLETOSKYSHIFT) + offset);
-                            skycolfunc();
-                        }
-                    }
-
-                    R_UnlockTextureCompositePatchNum(texture);
+                    top = MIN(top, pl->top[x]);
+                    bottom = MAX(bottom, pl->bottom[x]);
                 }
-                else
-                {
-                    // regular flat
-                    dboolean        swirling = (isliquid[picnum] && r_liquid_swirl && !freeze);
-                    int             lumpnum = firstflat + flattranslation[picnum];
 
-                    ds_source = (swirling ? R_DistortedFlat(picnum) :
-                        W_CacheLumpNum(lumpnum, PU_STATIC));
+            if (top > bottom)
+                continue;
+
+            if (numdrawplanes == maxdrawplanes)
+            {
+                maxdrawplanes = (maxdrawplanes ? maxdrawplanes * 2 : 128);
+                drawplanes = realloc(drawplanes, maxdrawplanes * sizeof(*drawplanes));
+            }
+
+            pl->top[pl->minx - 1] = pl->top[pl->maxx + 1] = USHRT_MAX;
 
-                    xoffs = pl->xoffs;  // killough 2/28/98: Add offsets
-                    yoffs = pl->yoffs;
-                    planeheight = ABS(pl->height - viewz);
+            drawplane = &drawplanes[numdrawplanes++];
+            drawplane->pl = pl;
+            drawplane->top = top;
+            drawplane->bottom = bottom;
 
-                    planezlight = zlight[BETWEEN(0, (pl->lightlevel >> LIGHTSEGSHIFT)
-                        + extralight * LIGHTBRIGHT, LIGHTLEVELS - 1)];
+            if ((area = (pl->maxx - pl->minx + 1) * (bottom - top + 1)) > maxarea)
+                drawplane->thread = -1;
+            else
+            {
+                int j;
 
-                    pl->top[pl->minx - 1] = pl->top[pl->maxx + 1] = USHRT_MAX;
+                drawplane->thread = 0;
 
-                    R_MakeSpans(pl);
+                for (j = 1; j < numrenderthreads; j++)
+                    if (load[j] < load[drawplane->thread])
+                        drawplane->thread = j;
 
-                    if (!swirling)
-                        W_ReleaseLumpNum(lumpnum);
-                }
+                load[drawplane->thread] += area;
+            }
+        }
+    }
+
+    R_RunRenderJob(R_DrawPlanesJob);
+}
+
+//
+// R_ClearPlaneStats
+// Called at the start of each frame, before any thread has found its visplanes.
+//
+void R_ClearPlaneStats(void)
+{
+    visplanestats.visplanes = 0;
+    visplanestats.buckets = 0;
+    visplanestats.longestchain = 0;
+    visplanestats.splits = 0;
+}
+
+//
+// R_ResetPlaneStats
+// Called by P_SetupLevel() so the peak number of visplanes is for the current map.
+//
+void R_ResetPlaneStats(void)
+{
+    visplanestats.peakvisplanes = 0;
+}
+
+//
+// R_UpdatePlaneStats
+// Add the visplanes found by this thread to visplanestats.
+//
+static void R_UpdatePlaneStats(void)
+{
+    R_LockRenderCache();
+
+    visplanestats.visplanes += numvisplanes;
+    visplanestats.peakvisplanes = MAX(visplanestats.peakvisplanes, visplanestats.visplanes);
+    visplanestats.buckets = MAX(visplanestats.buckets, numvisplanebuckets);
+    visplanestats.longestchain = MAX(visplanestats.longestchain, longestvisplanechain);
+    visplanestats.splits += numvisplanesplits;
+
+    R_UnlockRenderCache();
+}
+
+//
+// R_DrawPlanes
+// At the end of each frame.
+//
+void R_DrawPlanes(void)
+{
+    int i;
+
+    R_UpdatePlaneStats();
+
+    // share the visplanes out between the rendering threads, balancing them by pixels
+    if (numrenderthreads > 1 && r_parallelplanes)
+    {
+        R_DrawPlanesInParallel();
+        return;
+    }
+
+    planetop = 0;
+    planebottom = viewheight - 1;
+
+    for (i = 0; i < numvisplanebuckets; i++)
+    {
+        visplane_t  *pl;
+
+        for (pl = visplanes[i]; pl; pl = pl->next)
+            if (pl->minx <= pl->maxx)
+            {
+                pl->top[pl->minx - 1] = pl->top[pl->maxx + 1] = USHRT_MAX;
+                R_DrawPlane(pl);
             }
     }
 }
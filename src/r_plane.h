@@ -43,21 +43,38 @@
 #define PL_SKYFLAT      0x80000000
 
 // Visplane related.
-extern  int     *lastopening;
+extern THREADLOCAL int      *lastopening;
 
-extern int      floorclip[];
-extern int      ceilingclip[];
+extern THREADLOCAL int      floorclip[];
+extern THREADLOCAL int      ceilingclip[];
 
-extern fixed_t  yslope[];
-extern fixed_t  distscale[];
+extern fixed_t              yslope[];
+extern fixed_t              distscale[];
 
-extern dboolean markceiling;
+extern THREADLOCAL dboolean markceiling;
 
 extern dboolean r_brightmaps;
+extern dboolean r_parallelplanes;
+extern dboolean r_planestats;
+
+typedef struct
+{
+    int         visplanes;      // visplanes found in the last frame, by all threads
+    int         peakvisplanes;  // most visplanes found in one frame
+    int         buckets;        // size of the visplane hash table
+    int         longestchain;   // longest hash chain searched by R_FindPlane in the last frame
+    int         splits;         // visplanes split by R_CheckPlane in the last frame
+} visplanestats_t;
+
+extern visplanestats_t  visplanestats;
 
 void R_ClearPlanes(void);
+void R_FreePlanes(void);
+void R_ClearPlaneStats(void);
+void R_ResetPlaneStats(void);
 
 void R_DrawPlanes(void);
+void R_UpdateDistortedFlats(void);
 
 visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel, fixed_t xoffs, fixed_t yoffs);
 
@@ -42,68 +42,70 @@
 
 // killough 1/6/98: replaced globals with statics where appropriate
 
-static dboolean segtextured;            // True if any of the segs textures might be visible.
+static THREADLOCAL dboolean segtextured;    // True if any of the segs textures might be visible.
 
-static dboolean markfloor;              // False if the back side is the same plane.
-dboolean        markceiling;
+static THREADLOCAL dboolean markfloor;      // False if the back side is the same plane.
+THREADLOCAL dboolean        markceiling;
 
-static dboolean maskedtexture;
-static int      toptexture;
-static int      midtexture;
-static int      bottomtexture;
+static THREADLOCAL dboolean maskedtexture;
+static THREADLOCAL int      toptexture;
+static THREADLOCAL int      midtexture;
+static THREADLOCAL int      bottomtexture;
 
-static fixed_t  toptexheight;
-static fixed_t  midtexheight;
-static fixed_t  bottomtexheight;
+static THREADLOCAL fixed_t  toptexheight;
+static THREADLOCAL fixed_t  midtexheight;
+static THREADLOCAL fixed_t  bottomtexheight;
 
-static byte     *toptexfullbright;
-static byte     *midtexfullbright;
-static byte     *bottomtexfullbright;
+static THREADLOCAL byte     *toptexfullbright;
+static THREADLOCAL byte     *midtexfullbright;
+static THREADLOCAL byte     *bottomtexfullbright;
 
-angle_t         rw_normalangle;
-fixed_t         rw_distance;
+static THREADLOCAL rpatch_t *toptexpatch;
+static THREADLOCAL rpatch_t *midtexpatch;
+static THREADLOCAL rpatch_t *bottomtexpatch;
+
+THREADLOCAL angle_t         rw_normalangle;
+THREADLOCAL fixed_t         rw_distance;
 
 //
 // regular wall
 //
-static int      rw_x;
-static int      rw_stopx;
-static angle_t  rw_centerangle;
-static fixed_t  rw_offset;
-static fixed_t  rw_scale;
-static fixed_t  rw_scalestep;
-static fixed_t  rw_midtexturemid;
-static fixed_t  rw_toptexturemid;
-static fixed_t  rw_bottomtexturemid;
+static THREADLOCAL int      rw_x;
+static THREADLOCAL int      rw_stopx;
+static THREADLOCAL angle_t  rw_centerangle;
+static THREADLOCAL fixed_t  rw_offset;
+static THREADLOCAL fixed_t  rw_scale;
+static THREADLOCAL fixed_t  rw_scalestep;
+static THREADLOCAL fixed_t  rw_midtexturemid;
+static THREADLOCAL fixed_t  rw_toptexturemid;
+static THREADLOCAL fixed_t  rw_bottomtexturemid;
 
-static int      worldtop;
-static int      worldbottom;
-static int      worldhigh;
-static int      worldlow;
+static THREADLOCAL int      worldtop;
+static THREADLOCAL int      worldbottom;
+static THREADLOCAL int      worldhigh;
+static THREADLOCAL int      worldlow;
 
-static int64_t  pixhigh;
-static int64_t  pixlow;
-static fixed_t  pixhighstep;
-static fixed_t  pixlowstep;
+static THREADLOCAL int64_t  pixhigh;
+static THREADLOCAL int64_t  pixlow;
+static THREADLOCAL fixed_t  pixhighstep;
+static THREADLOCAL fixed_t  pixlowstep;
 
-static int64_t  topfrac;
-static fixed_t  topstep;
+static THREADLOCAL int64_t  topfrac;
+static THREADLOCAL fixed_t  topstep;
 
-static int64_t  bottomfrac;
-static fixed_t  bottomstep;
+static THREADLOCAL int64_t  bottomfrac;
+static THREADLOCAL fixed_t  bottomstep;
 
-lighttable_t    **walllights;
+THREADLOCAL lighttable_t    **walllights;
 
-static int      *maskedtexturecol;      // dropoff overflow
+static THREADLOCAL int      *maskedtexturecol;      // dropoff overflow
 
 dboolean        r_brightmaps = r_brightmaps_default;
 dboolean        r_liquid_current = r_liquid_current_default;
 
 extern fixed_t  animatedliquiddiff;
-extern fixed_t  animatedliquidxoffs;
-extern fixed_t  animatedliquidyoffs;
 
-extern dboolean doorclosed;
+extern THREADLOCAL dboolean doorclosed;
 extern dboolean r_dither;
 extern dboolean r_liquid_bob;
 extern dboolean r_textures;
@@ -148,10 +150,10 @@ extern dboolean r_translucency;
 //   increasing the precision of various renderer variables, and,
 //   possibly, creating a noticeable performance penalty.
 //
-static int      max_rwscale = 64 * FRACUNIT;
-static int      heightbits = 12;
-static int      heightunit = (1 << 12);
-static int      invhgtbits = 4;
+static THREADLOCAL int  max_rwscale = 64 * FRACUNIT;
+static THREADLOCAL int  heightbits = 12;
+static THREADLOCAL int  heightunit = (1 << 12);
+static THREADLOCAL int  invhgtbits = 4;
 
 typedef struct
 {
@@ -168,36 +170,29 @@ static const scale_values_t scale_values[9] =
 
 void R_FixWiggle(sector_t *sector)
 {
-    static int  lastheight;
+    static THREADLOCAL int  lastheight;
 
     // disallow negative heights, force cache initialization
-    int         height = MAX(1, (sector->interpceilingheight
-                    - sector->interpfloorheight) >> FRACBITS);
+    int                     height = MAX(1, (sector->interpceilingheight
+                                - sector->interpfloorheight) >> FRACBITS);
 
     // early out?
     if (height != lastheight)
     {
         const scale_values_t    *svp;
+        int                     scaleindex = 0;
 
         lastheight = height;
 
-        // initialize, or handle moving sector
-        if (height != sector->cachedheight)
-        {
-            int scaleindex = 0;
-
-            sector->cachedheight = height;
-            height >>= 7;
+        // calculate adjustment
+        // (not cached in the sector, since it may be reached by several rendering threads at once)
+        height >>= 7;
 
-            // calculate adjustment
-            while ((height >>= 1))
-                scaleindex++;
-
-            sector->scaleindex = scaleindex;
-        }
+        while ((height >>= 1))
+            scaleindex++;
 
         // fine-tune renderer for this wall
-        svp = &scale_values[sector->scaleindex];
+        svp = &scale_values[scaleindex];
         max_rwscale = svp->clamp;
         heightbits = svp->heightbits;
         heightunit = 1 << heightbits;
@@ -228,7 +223,7 @@ static void R_BlastMaskedSegColumn(const rcolumn_t *column)
                 + FixedMul((dc_yl - centery) << FRACBITS, dc_iscale);
 
             dc_source = column->pixels + topdelta;
-            colfunc();
+            R_ColumnCommand(colfunc);
         }
     }
 }
@@ -414,18 +409,15 @@ void R_RenderSegLoop(void)
                 dc_yh = yh;
 
                 dc_texturemid = rw_midtexturemid;
-                dc_source = R_GetTextureColumn(R_CacheTextureCompositePatchNum(midtexture),
-                    texturecolumn);
+                dc_source = R_GetTextureColumn(midtexpatch, texturecolumn);
                 dc_texheight = midtexheight;
 
                 // [BH] apply brightmap
                 dc_colormask = midtexfullbright;
                 if (dc_colormask && usebrightmaps && !nobrightmap[midtexture])
-                    fbwallcolfunc();
+                    R_ColumnCommand(fbwallcolfunc);
                 else
-                    wallcolfunc();
-
-                R_UnlockTextureCompositePatchNum(midtexture);
+                    R_ColumnCommand(wallcolfunc);
             }
 
             ceilingclip[rw_x] = viewheight;
@@ -452,18 +444,15 @@ void R_RenderSegLoop(void)
                         dc_yh = mid;
 
                         dc_texturemid = rw_toptexturemid;
-                        dc_source = R_GetTextureColumn(R_CacheTextureCompositePatchNum(toptexture),
-                            texturecolumn);
+                        dc_source = R_GetTextureColumn(toptexpatch, texturecolumn);
                         dc_texheight = toptexheight;
 
                         // [BH] apply brightmap
                         dc_colormask = toptexfullbright;
                         if (dc_colormask && usebrightmaps && !nobrightmap[toptexture])
-                            fbwallcolfunc();
+                            R_ColumnCommand(fbwallcolfunc);
                         else
-                            wallcolfunc();
-
-                        R_UnlockTextureCompositePatchNum(toptexture);
+                            R_ColumnCommand(wallcolfunc);
                     }
 
                     ceilingclip[rw_x] = mid;
@@ -495,18 +484,15 @@ void R_RenderSegLoop(void)
                         dc_yh = yh;
 
                         dc_texturemid = rw_bottomtexturemid;
-                        dc_source = R_GetTextureColumn(R_CacheTextureCompositePatchNum(bottomtexture),
-                            texturecolumn);
+                        dc_source = R_GetTextureColumn(bottomtexpatch, texturecolumn);
                         dc_texheight = bottomtexheight;
 
                         // [BH] apply brightmap
                         dc_colormask = bottomtexfullbright;
                         if (dc_colormask && usebrightmaps && !nobrightmap[bottomtexture])
-                            fbwallcolfunc();
+                            R_ColumnCommand(fbwallcolfunc);
                         else
-                            wallcolfunc();
-
-                        R_UnlockTextureCompositePatchNum(bottomtexture);
+                            R_ColumnCommand(wallcolfunc);
                     }
 
                     floorclip[rw_x] = mid;
@@ -528,6 +514,10 @@ void R_RenderSegLoop(void)
         topfrac += topstep;
         bottomfrac += bottomstep;
     }
+
+    // draw whatever is left in the quad-column buffer
+    if (wallcolfunc == R_DrawQuadWallColumn)
+        R_ColumnCommand(R_FlushQuadColumns);
 }
 
 //
@@ -556,16 +546,23 @@ void R_StoreWallRange(int start, int stop)
     int64_t     dx, dy;
     int64_t     dx1, dy1;
     int64_t     len;
+    int         x1, x2;
 
     linedef = curline->linedef;
 
     // mark the segment as visible for automap
-    linedef->flags |= ML_MAPPED;
+    // (only done by the thread whose strip it starts in, since all of them walk the same segs)
+    if (start >= stripx1 && start <= stripx2)
+        linedef->flags |= ML_MAPPED;
 
     // [BH] if in automap, we're done now that line is mapped
     if (automapactive)
         return;
 
+    // nothing more to do if the segment is entirely outside of this thread's strip
+    if (start > stripx2 || stop < stripx1)
+        return;
+
     sidedef = curline->sidedef;
 
     // killough 1/98 -- fix 2s line HOM
@@ -598,8 +595,8 @@ void R_StoreWallRange(int start, int stop)
 
     // killough 1/6/98, 2/1/98: remove limit on openings
     {
-        extern int      *openings;              // dropoff overflow
-        extern size_t   maxopenings;
+        extern THREADLOCAL int      *openings;  // dropoff overflow
+        extern THREADLOCAL size_t   maxopenings;
         size_t          pos = lastopening - openings;
         size_t          need = (rw_stopx - start) * sizeof(*lastopening) + pos;
 
@@ -637,18 +634,9 @@ void R_StoreWallRange(int start, int stop)
     worldbottom = frontsector->interpfloorheight - viewz;
 
     // [BH] animate liquid sectors
-    if (frontsector->isliquid && !freeze)
-    {
-        if (r_liquid_bob && (frontsector->heightsec == -1
-            || viewz > sectors[frontsector->heightsec].interpfloorheight))
-            worldbottom += animatedliquiddiff;
-
-        if (r_liquid_current && frontsector->heightsec == -1)
-        {
-            frontsector->floor_xoffs = animatedliquidxoffs;
-            frontsector->floor_yoffs = animatedliquidyoffs;
-        }
-    }
+    if (frontsector->isliquid && !freeze && r_liquid_bob && (frontsector->heightsec == -1
+        || viewz > sectors[frontsector->heightsec].interpfloorheight))
+        worldbottom += animatedliquiddiff;
 
     R_FixWiggle(frontsector);
 
@@ -727,7 +715,7 @@ void R_StoreWallRange(int start, int stop)
         //
         // killough 4/7/98: make doorclosed external variable
         {
-            extern dboolean     doorclosed;
+            extern THREADLOCAL dboolean doorclosed;
 
             if (doorclosed || backsector->interpceilingheight <= frontsector->interpfloorheight)
             {
@@ -930,6 +918,28 @@ void R_StoreWallRange(int start, int stop)
         }
     }
 
+    // Only render the columns that are inside this thread's strip. Everything
+    // above was calculated for the whole segment, and the steppers are then
+    // advanced to the first column, so the result is identical to rendering
+    // the whole segment.
+    if (start < stripx1)
+    {
+        int     skip = stripx1 - start;
+
+        rw_x = stripx1;
+        rw_scale += (fixed_t)((int64_t)rw_scalestep * skip);
+        topfrac += (int64_t)topstep * skip;
+        bottomfrac += (int64_t)bottomstep * skip;
+        pixhigh += (int64_t)pixhighstep * skip;
+        pixlow += (int64_t)pixlowstep * skip;
+    }
+
+    if (stop > stripx2)
+        rw_stopx = stripx2 + 1;
+
+    x1 = rw_x;
+    x2 = rw_stopx;
+
     // render it
     if (markceiling)
     {
@@ -947,21 +957,41 @@ void R_StoreWallRange(int start, int stop)
             markfloor = false;
     }
 
+    // cache the composite textures once for the whole segment rather than for each column
+    if (midtexture)
+        midtexpatch = R_CacheTextureCompositePatchNum(midtexture);
+
+    if (toptexture)
+        toptexpatch = R_CacheTextureCompositePatchNum(toptexture);
+
+    if (bottomtexture)
+        bottomtexpatch = R_CacheTextureCompositePatchNum(bottomtexture);
+
     R_RenderSegLoop();
 
+    if (midtexture)
+        R_UnlockTextureCompositePatchNum(midtexture);
+
+    if (toptexture)
+        R_UnlockTextureCompositePatchNum(toptexture);
+
+    if (bottomtexture)
+        R_UnlockTextureCompositePatchNum(bottomtexture);
+
     // save sprite clipping info
+    // (space is allocated for the whole segment, but only the columns in this strip are used)
     if (((ds_p->silhouette & SIL_TOP) || maskedtexture) && !ds_p->sprtopclip)
     {
-        memcpy(lastopening, ceilingclip + start, sizeof(*lastopening) * (rw_stopx - start));
+        memcpy(lastopening + x1 - start, ceilingclip + x1, sizeof(*lastopening) * (x2 - x1));
         ds_p->sprtopclip = lastopening - start;
-        lastopening += rw_stopx - start;
+        lastopening += stop + 1 - start;
     }
 
     if (((ds_p->silhouette & SIL_BOTTOM) || maskedtexture) && !ds_p->sprbottomclip)
     {
-        memcpy(lastopening, floorclip + start, sizeof(*lastopening) * (rw_stopx - start));
+        memcpy(lastopening + x1 - start, floorclip + x1, sizeof(*lastopening) * (x2 - x1));
         ds_p->sprbottomclip = lastopening - start;
-        lastopening += rw_stopx - start;
+        lastopening += stop + 1 - start;
     }
 
     if (maskedtexture && !(ds_p->silhouette & SIL_TOP))
@@ -68,8 +68,10 @@ extern lighttable_t     *fullcolormap;  // killough 3/20/98
 extern int              viewwidth;
 extern int              scaledviewwidth;
 extern int              viewheight;
+extern int              scaledviewheight;
 
 extern int              firstflat;
+extern int              numflats;
 
 // for global animation
 extern int              *flattranslation;
@@ -104,6 +106,8 @@ extern subsector_t      *subsectors;
 
 extern int              numnodes;
 extern node_t           *nodes;
+extern packednode_t     *packednodes;
+extern nodebbox_t       *packednodebboxes;
 
 extern int              numlines;
 extern line_t           *lines;
@@ -142,11 +146,11 @@ extern player_t         *viewplayer;
 extern angle_t          clipangle;
 
 extern int              viewangletox[FINEANGLES / 2];
-extern angle_t          xtoviewangle[SCREENWIDTH + 1];
+extern angle_t          xtoviewangle[MAXSCREENWIDTH + 1];
 
-extern angle_t          rw_normalangle;
+extern THREADLOCAL angle_t      rw_normalangle;
 
-extern visplane_t       *floorplane;
-extern visplane_t       *ceilingplane;
+extern THREADLOCAL visplane_t   *floorplane;
+extern THREADLOCAL visplane_t   *ceilingplane;
 
 #endif
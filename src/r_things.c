@@ -36,6 +36,10 @@
 ========================================================================
 */
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #include "c_console.h"
 #include "doomstat.h"
 #include "i_colors.h"
@@ -61,12 +65,12 @@ fixed_t                 pspritexscale;
 fixed_t                 pspriteyscale;
 fixed_t                 pspriteiscale;
 
-static lighttable_t     **spritelights;         // killough 1/25/98 made static
+static THREADLOCAL lighttable_t **spritelights;    // killough 1/25/98 made static
 
 // constant arrays
 //  used for psprite clipping and initializing clipping
-int                     negonearray[SCREENWIDTH];
-int                     screenheightarray[SCREENWIDTH];
+int                     negonearray[MAXSCREENWIDTH];
+int                     screenheightarray[MAXSCREENWIDTH];
 
 //
 // INITIALIZATION FUNCTIONS
@@ -80,9 +84,9 @@ short                   firstbloodsplatlump;
 static spriteframe_t    sprtemp[MAX_SPRITE_FRAMES];
 static int              maxframe;
 
-static dboolean         interpolatesprites;
-static dboolean         pausesprites;
-static dboolean         drawshadows;
+dboolean                interpolatesprites;
+dboolean                pausesprites;
+static THREADLOCAL dboolean drawshadows;
 
 dboolean                r_liquid_clipsprites = r_liquid_clipsprites_default;
 
@@ -305,13 +309,50 @@ static void R_InitSpriteDefs(void)
 // GAME FUNCTIONS
 //
 
-static vissprite_t              *vissprites;
-static vissprite_t              **vissprite_ptrs;
-static unsigned int             num_vissprite;
-static unsigned int             num_bloodsplatvissprite;
-static unsigned int             num_vissprite_alloc;
+// Each rendering thread projects and sorts its own vissprites.
+static THREADLOCAL vissprite_t              *vissprites;
+static THREADLOCAL vissprite_t              **vissprite_ptrs;
+static THREADLOCAL unsigned int             num_vissprite;
+static THREADLOCAL unsigned int             num_bloodsplatvissprite;
+static THREADLOCAL unsigned int             num_vissprite_alloc;
+
+static THREADLOCAL bloodsplatvissprite_t    *bloodsplatvissprites;
+
+dboolean                r_parallelsprites = r_parallelsprites_default;
 
-static bloodsplatvissprite_t    bloodsplatvissprites[NUMVISSPRITES];
+// The vissprites, blood splats and drawsegs that overlap each tile of the 3D view,
+//  as binned by R_DrawMaskedInParallel().
+typedef struct
+{
+    vissprite_t                 **vissprites;
+    unsigned int                numvissprites;
+    bloodsplatvissprite_t       **bloodsplats;
+    unsigned int                numbloodsplats;
+    drawseg_t                   *drawsegs;
+    unsigned int                numdrawsegs;
+    unsigned int                maxsprites;
+    unsigned int                maxdrawsegs;
+} maskedtile_t;
+
+static maskedtile_t     maskedtiles[MAXRENDERTHREADS];
+static dboolean         maskeddrawshadows;
+
+// The drawsegs that might clip a sprite, as indexed by R_IndexDrawSegs() into buckets
+//  of 1 << DRAWSEGBUCKETSHIFT columns each. drawsegbits[] has a bit for each drawseg,
+//  and is left clear between calls to R_FindDrawSegs().
+#define DRAWSEGBUCKETSHIFT      5
+#define NUMDRAWSEGBUCKETS       ((MAXSCREENWIDTH >> DRAWSEGBUCKETSHIFT) + 1)
+
+static THREADLOCAL int          drawsegbucketstart[NUMDRAWSEGBUCKETS + 1];
+static THREADLOCAL int          *drawsegbuckets;
+static THREADLOCAL int          maxdrawsegbuckets;
+static THREADLOCAL uint32_t     *drawsegbits;
+static THREADLOCAL int          *drawsegcandidates;
+static THREADLOCAL int          maxdrawsegcandidates;
+
+static THREADLOCAL uint64_t     spritesclipped;
+static THREADLOCAL uint64_t     drawsegsexamined;
+static THREADLOCAL uint64_t     drawsegsscanned;
 
 //
 // R_InitSprites
@@ -321,24 +362,28 @@ void R_InitSprites(void)
 {
     int i;
 
-    for (i = 0; i < SCREENWIDTH; i++)
+    for (i = 0; i < MAXSCREENWIDTH; i++)
         negonearray[i] = -1;
 
     R_InitSpriteDefs();
-
-    num_vissprite = 0;
-    num_vissprite_alloc = 256;
-    vissprites = malloc(num_vissprite_alloc * sizeof(vissprite_t));
-    vissprite_ptrs = malloc(num_vissprite_alloc * sizeof(vissprite_t *));
 }
 
 //
 // R_ClearSprites
 // Called at frame start.
+// The vissprites are allocated here, rather than in R_InitSprites, so
+// that each rendering thread gets its own.
 //
 void R_ClearSprites(void)
 {
-    if (num_vissprite >= num_vissprite_alloc)
+    if (!vissprites)
+    {
+        num_vissprite_alloc = 256;
+        vissprites = malloc(num_vissprite_alloc * sizeof(vissprite_t));
+        vissprite_ptrs = malloc(num_vissprite_alloc * sizeof(vissprite_t *));
+        bloodsplatvissprites = malloc(NUMVISSPRITES * sizeof(bloodsplatvissprite_t));
+    }
+    else if (num_vissprite >= num_vissprite_alloc)
     {
         num_vissprite_alloc += 256;
         vissprites = realloc(vissprites, num_vissprite_alloc * sizeof(vissprite_t));
@@ -349,6 +394,31 @@ void R_ClearSprites(void)
     num_bloodsplatvissprite = 0;
 }
 
+//
+// R_FreeSprites
+// Called by each rendering thread before it exits, to free its own buffers.
+//
+void R_FreeSprites(void)
+{
+    free(vissprites);
+    free(vissprite_ptrs);
+    free(bloodsplatvissprites);
+    vissprites = NULL;
+    vissprite_ptrs = NULL;
+    bloodsplatvissprites = NULL;
+    num_vissprite_alloc = 0;
+
+    free(drawsegbuckets);
+    drawsegbuckets = NULL;
+    maxdrawsegbuckets = 0;
+
+    free(drawsegcandidates);
+    free(drawsegbits);
+    drawsegcandidates = NULL;
+    drawsegbits = NULL;
+    maxdrawsegcandidates = 0;
+}
+
 //
 // R_NewVisSprite
 //
@@ -442,14 +512,13 @@ static vissprite_t *R_NewVisSprite(fixed_t scale)
 //
 // R_BlastSpriteColumn
 //
-int             *mfloorclip;
-int             *mceilingclip;
+THREADLOCAL int         *mfloorclip;
+THREADLOCAL int         *mceilingclip;
 
-fixed_t         spryscale;
-int             sprtopscreen;
-int             fuzzpos;
+THREADLOCAL fixed_t     spryscale;
+THREADLOCAL int         sprtopscreen;
 
-static int      shift;
+static THREADLOCAL int  shift;
 
 static void R_BlastSpriteColumn(column_t *column)
 {
@@ -476,7 +545,7 @@ static void R_BlastSpriteColumn(column_t *column)
                 + FixedMul((dc_yl - centery) << FRACBITS, dc_iscale);
 
             dc_source = (byte *)column + 3;
-            colfunc();
+            R_ColumnCommand(colfunc);
         }
 
         column = (column_t *)((byte *)column + length + 4);
@@ -500,7 +569,7 @@ static void R_BlastBloodSplatColumn(column_t *column)
         dc_yh = MIN((topscreen + spryscale * length) >> FRACBITS, floorclip);
 
         if (dc_yl <= dc_yh)
-            colfunc();
+            R_ColumnCommand(colfunc);
 
         column = (column_t *)((byte *)column + length + 4);
     }
@@ -523,7 +592,7 @@ static void R_BlastShadowColumn(column_t *column)
         dc_yh = MIN(((topscreen + spryscale * length) >> FRACBITS) / 10 + shift, floorclip);
 
         if (dc_yl <= dc_yh)
-            colfunc();
+            R_ColumnCommand(colfunc);
 
         column = (column_t *)((byte *)column + length + 4);
     }
@@ -539,10 +608,15 @@ void R_DrawVisSprite(vissprite_t *vis)
     const fixed_t       startfrac = vis->startfrac;
     const fixed_t       xiscale = vis->xiscale;
     const fixed_t       x2 = vis->x2;
-    const byte          *patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
-    const int           *columnofs = ((patch_t *)patch)->columnofs;
+    const byte          *patch;
+    const int           *columnofs;
     const mobj_t        *mobj = vis->mobj;
 
+    R_LockRenderCache();
+    patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    R_UnlockRenderCache();
+    columnofs = ((patch_t *)patch)->columnofs;
+
     spryscale = vis->scale;
 
     if ((mobj->flags2 & MF2_CASTSHADOW) && drawshadows)
@@ -596,8 +670,6 @@ void R_DrawVisSprite(vissprite_t *vis)
     else
         dc_baseclip = -1;
 
-    fuzzpos = 0;
-
     for (dc_x = vis->x1, frac = startfrac; dc_x <= x2; dc_x++, frac += xiscale)
         R_BlastSpriteColumn((column_t *)(patch + LONG(columnofs[frac >> FRACBITS])));
 }
@@ -610,8 +682,13 @@ void R_DrawPVisSprite(vissprite_t *vis)
     fixed_t             frac = vis->startfrac;
     const fixed_t       xiscale = vis->xiscale;
     const fixed_t       x2 = vis->x2;
-    const byte          *patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
-    const int           *columnofs = ((patch_t *)patch)->columnofs;
+    const byte          *patch;
+    const int           *columnofs;
+
+    R_LockRenderCache();
+    patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    R_UnlockRenderCache();
+    columnofs = ((patch_t *)patch)->columnofs;
 
     dc_colormap = vis->colormap;
     colfunc = vis->colfunc;
@@ -623,7 +700,6 @@ void R_DrawPVisSprite(vissprite_t *vis)
     sprtopscreen = centeryfrac - FixedMul(dc_texturemid, spryscale);
 
     dc_baseclip = -1;
-    fuzzpos = 0;
 
     for (dc_x = vis->x1; dc_x <= x2; dc_x++, frac += xiscale)
         R_BlastSpriteColumn((column_t *)(patch + LONG(columnofs[frac >> FRACBITS])));
@@ -634,8 +710,13 @@ void R_DrawBloodSplatVisSprite(bloodsplatvissprite_t *vis)
     fixed_t             frac = vis->startfrac;
     const fixed_t       xiscale = vis->xiscale;
     const fixed_t       x2 = vis->x2;
-    const byte          *patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
-    const int           *columnofs = ((patch_t *)patch)->columnofs;
+    const byte          *patch;
+    const int           *columnofs;
+
+    R_LockRenderCache();
+    patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    R_UnlockRenderCache();
+    columnofs = ((patch_t *)patch)->columnofs;
 
     colfunc = vis->colfunc;
 
@@ -645,8 +726,6 @@ void R_DrawBloodSplatVisSprite(bloodsplatvissprite_t *vis)
     spryscale = vis->scale;
     sprtopscreen = centeryfrac - FixedMul(vis->texturemid, spryscale);
 
-    fuzzpos = 0;
-
     for (dc_x = vis->x1; dc_x <= x2; dc_x++, frac += xiscale)
         R_BlastBloodSplatColumn((column_t *)(patch + LONG(columnofs[frac >> FRACBITS])));
 }
@@ -702,12 +781,12 @@ void R_ProjectSprite(mobj_t *thing)
     if (flags2 & MF2_DONTDRAW)
         return;
 
-    // [AM] Interpolate between current and last position, if prudent.
+    // [AM] Use the position interpolated by R_InterpolateMovers(), if prudent.
     if (thing->interp && interpolatesprites)
     {
-        fx = thing->oldx + FixedMul(thing->x - thing->oldx, fractionaltic);
-        fy = thing->oldy + FixedMul(thing->y - thing->oldy, fractionaltic);
-        fz = thing->oldz + FixedMul(thing->z - thing->oldz, fractionaltic);
+        fx = thing->interpx;
+        fy = thing->interpy;
+        fz = thing->interpz;
     }
     else
     {
@@ -934,6 +1013,9 @@ static void R_ProjectBloodSplat(bloodsplat_t *splat)
         return;
 
     // store information in a vissprite
+    if (num_bloodsplatvissprite == NUMVISSPRITES)
+        return;
+
     vis = &bloodsplatvissprites[num_bloodsplatvissprite++];
 
     vis->scale = xscale;
@@ -979,12 +1061,14 @@ void R_AddSprites(sector_t *sec, int lightlevel)
     spritelights = scalelight[BETWEEN(0, (lightlevel >> LIGHTSEGSHIFT) + extralight * LIGHTBRIGHT,
         LIGHTLEVELS - 1)];
 
-    if (drawbloodsplats && sec->interpfloorheight <= viewz)
+    // only project the blood splats in the sector if some part of them can be seen
+    if (drawbloodsplats && sec->splatfirst != -1 && sec->interpfloorheight <= viewz
+        && R_CheckBBox(sec->splatbbox))
     {
-        bloodsplat_t    *splat;
+        int i;
 
-        for (splat = sec->splatlist; splat; splat = splat->snext)
-            R_ProjectBloodSplat(splat);
+        for (i = sec->splatfirst; i != -1; i = bloodsplatpool[i].snext)
+            R_ProjectBloodSplat(bloodsplatpool + i);
     }
 
     drawshadows = (r_shadows && !fixedcolormap && sec->floorpic != skyflatnum);
@@ -1184,22 +1268,184 @@ void R_DrawPlayerSprites(void)
     }
 }
 
+//
+// R_IndexDrawSegs
+// Sort the drawsegs in this thread's strip that might clip a sprite into buckets of
+//  columns, once the BSP tree has been walked, so that each sprite only has to look
+//  at the drawsegs that overlap it.
+//
+static void R_IndexDrawSegs(void)
+{
+    const int   numdrawsegs = (int)(ds_p - drawsegs);
+    int         next[NUMDRAWSEGBUCKETS];
+    int         i;
+
+    memset(drawsegbucketstart, 0, sizeof(drawsegbucketstart));
+
+    for (i = 0; i < numdrawsegs; i++)
+    {
+        const drawseg_t *ds = drawsegs + i;
+        const int       x1 = MAX(ds->x1, stripx1);
+        const int       x2 = MIN(ds->x2, stripx2);
+        int             b;
+
+        if (x1 <= x2 && ((ds->silhouette & SIL_BOTH) || ds->maskedtexturecol))
+            for (b = x1 >> DRAWSEGBUCKETSHIFT; b <= x2 >> DRAWSEGBUCKETSHIFT; b++)
+                drawsegbucketstart[b + 1]++;
+    }
+
+    for (i = 0; i < NUMDRAWSEGBUCKETS; i++)
+    {
+        drawsegbucketstart[i + 1] += drawsegbucketstart[i];
+        next[i] = drawsegbucketstart[i];
+    }
+
+    if (maxdrawsegbuckets < drawsegbucketstart[NUMDRAWSEGBUCKETS])
+    {
+        maxdrawsegbuckets = drawsegbucketstart[NUMDRAWSEGBUCKETS] + 1024;
+        drawsegbuckets = realloc(drawsegbuckets, maxdrawsegbuckets * sizeof(*drawsegbuckets));
+    }
+
+    if (maxdrawsegcandidates < numdrawsegs)
+    {
+        const int   words = (maxdrawsegcandidates + 31) / 32;
+
+        maxdrawsegcandidates = numdrawsegs + 128;
+        drawsegcandidates = realloc(drawsegcandidates, maxdrawsegcandidates * sizeof(*drawsegcandidates));
+        drawsegbits = realloc(drawsegbits, (maxdrawsegcandidates + 31) / 32 * sizeof(*drawsegbits));
+        memset(drawsegbits + words, 0, ((maxdrawsegcandidates + 31) / 32 - words) * sizeof(*drawsegbits));
+    }
+
+    for (i = 0; i < numdrawsegs; i++)
+    {
+        const drawseg_t *ds = drawsegs + i;
+        const int       x1 = MAX(ds->x1, stripx1);
+        const int       x2 = MIN(ds->x2, stripx2);
+        int             b;
+
+        if (x1 <= x2 && ((ds->silhouette & SIL_BOTH) || ds->maskedtexturecol))
+            for (b = x1 >> DRAWSEGBUCKETSHIFT; b <= x2 >> DRAWSEGBUCKETSHIFT; b++)
+                drawsegbuckets[next[b]++] = i;
+    }
+}
+
+static __inline int R_HighestBit(uint32_t bits)
+{
+#if defined(_MSC_VER)
+    unsigned long   index;
+
+    _BitScanReverse(&index, bits);
+    return (int)index;
+#else
+    return (31 - __builtin_clz(bits));
+#endif
+}
+
+//
+// R_FindDrawSegs
+// Fill drawsegcandidates[] with the drawsegs indexed by R_IndexDrawSegs() that overlap
+//  columns x1 to x2, from the last drawseg to the first, and return how many there are.
+//
+static int R_FindDrawSegs(int x1, int x2)
+{
+    const int   b1 = x1 >> DRAWSEGBUCKETSHIFT;
+    const int   b2 = x2 >> DRAWSEGBUCKETSHIFT;
+    int         lo = INT_MAX;
+    int         hi = -1;
+    int         count = 0;
+    int         b, i;
+
+    spritesclipped++;
+    drawsegsscanned += ds_p - drawsegs;
+
+    // the drawsegs in each bucket are already in order
+    if (b1 == b2)
+    {
+        for (i = drawsegbucketstart[b1 + 1]; i-- > drawsegbucketstart[b1];)
+            drawsegcandidates[count++] = drawsegbuckets[i];
+
+        drawsegsexamined += count;
+        return count;
+    }
+
+    // otherwise merge the buckets, leaving out the drawsegs that are in more than one
+    for (b = b1; b <= b2; b++)
+        for (i = drawsegbucketstart[b]; i < drawsegbucketstart[b + 1]; i++)
+        {
+            const int   j = drawsegbuckets[i];
+
+            drawsegbits[j >> 5] |= 1u << (j & 31);
+            lo = MIN(lo, j >> 5);
+            hi = MAX(hi, j >> 5);
+        }
+
+    for (i = hi; i >= lo; i--)
+    {
+        uint32_t    bits = drawsegbits[i];
+
+        drawsegbits[i] = 0;
+
+        while (bits)
+        {
+            const int   bit = R_HighestBit(bits);
+
+            drawsegcandidates[count++] = (i << 5) + bit;
+            bits ^= 1u << bit;
+        }
+    }
+
+    drawsegsexamined += count;
+    return count;
+}
+
+//
+// R_UpdateDrawSegStats
+// Add this thread's drawseg counts to the totals shown by renderstats.
+//
+static void R_UpdateDrawSegStats(void)
+{
+    R_LockRenderCache();
+    renderstats.spritesclipped += spritesclipped;
+    renderstats.drawsegsexamined += drawsegsexamined;
+    renderstats.drawsegsscanned += drawsegsscanned;
+    R_UnlockRenderCache();
+
+    spritesclipped = 0;
+    drawsegsexamined = 0;
+    drawsegsscanned = 0;
+}
+
 //
 // R_DrawBloodSplatSprite
 //
 static void R_DrawBloodSplatSprite(bloodsplatvissprite_t *spr)
 {
-    drawseg_t   *ds;
-    int         clipbot[SCREENWIDTH];
-    int         cliptop[SCREENWIDTH];
+    int         clipbot[MAXSCREENWIDTH];
+    int         cliptop[MAXSCREENWIDTH];
     int         x1 = spr->x1;
     int         x2 = spr->x2;
-    int         i;
+    int         count;
+    int         i, j;
 
     // [RH] Quickly reject sprites with bad x ranges.
     if (x1 >= x2)
         return;
 
+    // only draw the part of the sprite inside this thread's strip
+    x1 = MAX(x1, stripx1);
+    x2 = MIN(x2, stripx2);
+
+    if (x1 > x2)
+        return;
+
+    if (x1 > spr->x1)
+    {
+        spr->startfrac += spr->xiscale * (x1 - spr->x1);
+        spr->x1 = x1;
+    }
+
+    spr->x2 = x2;
+
     // initialize the clipping arrays
     for (i = x1; i <= x2; i++)
     {
@@ -1210,8 +1456,11 @@ static void R_DrawBloodSplatSprite(bloodsplatvissprite_t *spr)
     // Scan drawsegs from end to start for obscuring segs.
     // The first drawseg that has a greater scale
     //  is the clip seg.
-    for (ds = ds_p; ds-- > drawsegs;)
+    count = R_FindDrawSegs(x1, x2);
+
+    for (j = 0; j < count; j++)
     {
+        drawseg_t       *ds = drawsegs + drawsegcandidates[j];
         int             r1;
         int             r2;
         int             silhouette = ds->silhouette;
@@ -1219,7 +1468,7 @@ static void R_DrawBloodSplatSprite(bloodsplatvissprite_t *spr)
         dboolean        top;
 
         // determine if the drawseg obscures the sprite
-        if (ds->x1 > x2 || ds->x2 < x1 || (!(silhouette & SIL_BOTH) && !ds->maskedtexturecol))
+        if (ds->x1 > x2 || ds->x2 < x1)
             continue;       // does not cover sprite
 
         if (MAX(ds->scale1, ds->scale2) < spr->scale
@@ -1251,17 +1500,32 @@ static void R_DrawBloodSplatSprite(bloodsplatvissprite_t *spr)
 
 static void R_DrawSprite(vissprite_t *spr)
 {
-    drawseg_t   *ds;
-    int         clipbot[SCREENWIDTH];
-    int         cliptop[SCREENWIDTH];
+    int         clipbot[MAXSCREENWIDTH];
+    int         cliptop[MAXSCREENWIDTH];
     int         x1 = spr->x1;
     int         x2 = spr->x2;
-    int         i;
+    int         count;
+    int         i, j;
 
     // [RH] Quickly reject sprites with bad x ranges.
     if (x1 >= x2)
         return;
 
+    // only draw the part of the sprite inside this thread's strip
+    x1 = MAX(x1, stripx1);
+    x2 = MIN(x2, stripx2);
+
+    if (x1 > x2)
+        return;
+
+    if (x1 > spr->x1)
+    {
+        spr->startfrac += spr->xiscale * (x1 - spr->x1);
+        spr->x1 = x1;
+    }
+
+    spr->x2 = x2;
+
     // initialize the clipping arrays
     for (i = x1; i <= x2; i++)
     {
@@ -1271,8 +1535,11 @@ static void R_DrawSprite(vissprite_t *spr)
 
     // Scan drawsegs from end to start for obscuring segs.
     // The first drawseg that has a greater scale is the clip seg.
-    for (ds = ds_p; ds-- > drawsegs;)
+    count = R_FindDrawSegs(x1, x2);
+
+    for (j = 0; j < count; j++)
     {
+        drawseg_t       *ds = drawsegs + drawsegcandidates[j];
         int             r1;
         int             r2;
         int             silhouette = ds->silhouette;
@@ -1280,7 +1547,7 @@ static void R_DrawSprite(vissprite_t *spr)
         dboolean        top;
 
         // determine if the drawseg obscures the sprite
-        if (ds->x1 > x2 || ds->x2 < x1 || (!(silhouette & SIL_BOTH) && !ds->maskedtexturecol))
+        if (ds->x1 > x2 || ds->x2 < x1)
             continue;       // does not cover sprite
 
         if (MAX(ds->scale1, ds->scale2) < spr->scale
@@ -1361,6 +1628,140 @@ static void R_DrawSprite(vissprite_t *spr)
     R_DrawVisSprite(spr);
 }
 
+//
+// R_DrawMaskedTile
+// Draw the vissprites, blood splats and masked mid textures binned into a tile by
+//  R_DrawMaskedInParallel(), in the same order as R_DrawMasked(). The vissprites
+//  are shared by all threads, so each is clipped to the tile in a copy.
+//
+static void R_DrawMaskedTile(int tile)
+{
+    const uint64_t  starttime = R_GetTimeUS();
+    maskedtile_t    *maskedtile = &maskedtiles[tile];
+    drawseg_t       *olddrawsegs = drawsegs;
+    drawseg_t       *oldds_p = ds_p;
+    drawseg_t       *ds;
+    int             i;
+
+    stripx1 = viewwidth * tile / numrenderthreads;
+    stripx2 = viewwidth * (tile + 1) / numrenderthreads - 1;
+
+    // drawshadows is left as it was after the main thread's last call to R_AddSprites()
+    drawshadows = maskeddrawshadows;
+
+    drawsegs = maskedtile->drawsegs;
+    ds_p = drawsegs + maskedtile->numdrawsegs;
+    R_IndexDrawSegs();
+
+    i = maskedtile->numbloodsplats;
+    while (i > 0)
+    {
+        bloodsplatvissprite_t   spr = *maskedtile->bloodsplats[--i];
+
+        R_DrawBloodSplatSprite(&spr);
+    }
+
+    i = maskedtile->numvissprites;
+    while (i > 0)
+    {
+        vissprite_t spr = *maskedtile->vissprites[--i];
+
+        R_DrawSprite(&spr);
+    }
+
+    for (ds = ds_p; ds-- > drawsegs;)
+        if (ds->maskedtexturecol)
+        {
+            const int   x1 = MAX(ds->x1, stripx1);
+            const int   x2 = MIN(ds->x2, stripx2);
+
+            if (x1 <= x2)
+                R_RenderMaskedSegRange(ds, x1, x2);
+        }
+
+    R_UpdateDrawSegStats();
+
+    drawsegs = olddrawsegs;
+    ds_p = oldds_p;
+
+    renderstats.maskedtime[tile] += R_GetTimeUS() - starttime;
+}
+
+//
+// R_DrawMaskedInParallel
+// Bin the vissprites, blood splats and drawsegs into a vertical tile of the 3D view
+//  for each rendering thread, keeping them in order, and draw the tiles in parallel.
+//  Drawsegs that can neither clip a sprite nor have a masked mid texture are left out.
+//  Every column is drawn by one thread in the same order as by R_DrawMasked(), so the
+//  result is the same.
+//
+static void R_DrawMaskedInParallel(void)
+{
+    const unsigned int  numdrawsegs = (unsigned int)(ds_p - drawsegs);
+    int                 tile;
+
+    for (tile = 0; tile < numrenderthreads; tile++)
+    {
+        maskedtile_t    *maskedtile = &maskedtiles[tile];
+        const int       x1 = viewwidth * tile / numrenderthreads;
+        const int       x2 = viewwidth * (tile + 1) / numrenderthreads - 1;
+        unsigned int    i;
+
+        if (maskedtile->maxsprites < num_vissprite + num_bloodsplatvissprite)
+        {
+            maskedtile->maxsprites = num_vissprite + num_bloodsplatvissprite + 128;
+            maskedtile->vissprites = realloc(maskedtile->vissprites,
+                maskedtile->maxsprites * sizeof(*maskedtile->vissprites));
+            maskedtile->bloodsplats = realloc(maskedtile->bloodsplats,
+                maskedtile->maxsprites * sizeof(*maskedtile->bloodsplats));
+        }
+
+        if (maskedtile->maxdrawsegs < numdrawsegs)
+        {
+            maskedtile->maxdrawsegs = numdrawsegs + 128;
+            maskedtile->drawsegs = realloc(maskedtile->drawsegs,
+                maskedtile->maxdrawsegs * sizeof(*maskedtile->drawsegs));
+        }
+
+        maskedtile->numbloodsplats = 0;
+
+        for (i = 0; i < num_bloodsplatvissprite; i++)
+        {
+            bloodsplatvissprite_t   *spr = &bloodsplatvissprites[i];
+
+            if (spr->x1 < spr->x2 && spr->x1 <= x2 && spr->x2 >= x1)
+                maskedtile->bloodsplats[maskedtile->numbloodsplats++] = spr;
+        }
+
+        maskedtile->numvissprites = 0;
+
+        for (i = 0; i < num_vissprite; i++)
+        {
+            vissprite_t *spr = vissprite_ptrs[i];
+
+            if (spr->x1 < spr->x2 && spr->x1 <= x2 && spr->x2 >= x1)
+                maskedtile->vissprites[maskedtile->numvissprites++] = spr;
+        }
+
+        maskedtile->numdrawsegs = 0;
+
+        for (i = 0; i < numdrawsegs; i++)
+        {
+            drawseg_t   *ds = &drawsegs[i];
+
+            if (ds->x1 <= x2 && ds->x2 >= x1 && ((ds->silhouette & SIL_BOTH) || ds->maskedtexturecol))
+                maskedtile->drawsegs[maskedtile->numdrawsegs++] = *ds;
+        }
+    }
+
+    maskeddrawshadows = drawshadows;
+
+    R_RunRenderJob(R_DrawMaskedTile);
+
+    stripx1 = 0;
+    stripx2 = viewwidth - 1;
+}
+
 //
 // R_DrawMasked
 //
@@ -1369,8 +1770,14 @@ void R_DrawMasked(void)
     drawseg_t   *ds;
     int         i;
 
-    pausesprites = (menuactive || paused || consoleactive);
-    interpolatesprites = (vid_capfps != TICRATE && !pausesprites);
+    // draw a vertical tile of the 3D view on each rendering thread, in the same order
+    if (numrenderthreads > 1 && r_parallelsprites)
+    {
+        R_DrawMaskedInParallel();
+        return;
+    }
+
+    R_IndexDrawSegs();
 
     // draw all blood splats
     i = num_bloodsplatvissprite;
@@ -1385,9 +1792,13 @@ void R_DrawMasked(void)
     // render any remaining masked mid textures
     for (ds = ds_p; ds-- > drawsegs;)
         if (ds->maskedtexturecol)
-            R_RenderMaskedSegRange(ds, ds->x1, ds->x2);
+        {
+            const int   x1 = MAX(ds->x1, stripx1);
+            const int   x2 = MIN(ds->x2, stripx2);
+
+            if (x1 <= x2)
+                R_RenderMaskedSegRange(ds, x1, x2);
+        }
 
-    // draw the psprites on top of everything
-    if (r_playersprites && !inhelpscreens)
-        R_DrawPlayerSprites();
+    R_UpdateDrawSegStats();
 }
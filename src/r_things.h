@@ -43,24 +43,29 @@
 
 // Constant arrays used for psprite clipping
 //  and initializing clipping.
-extern int      negonearray[SCREENWIDTH];
-extern int      screenheightarray[SCREENWIDTH];
+extern int      negonearray[MAXSCREENWIDTH];
+extern int      screenheightarray[MAXSCREENWIDTH];
 
 // vars for R_DrawMaskedColumn
-extern int      *mfloorclip;
-extern int      *mceilingclip;
-extern fixed_t  spryscale;
-extern int      sprtopscreen;
+extern THREADLOCAL int      *mfloorclip;
+extern THREADLOCAL int      *mceilingclip;
+extern THREADLOCAL fixed_t  spryscale;
+extern THREADLOCAL int      sprtopscreen;
 
 extern fixed_t  pspritexscale;
 extern fixed_t  pspriteyscale;
 extern fixed_t  pspriteiscale;
 
+extern dboolean r_parallelsprites;
 extern dboolean r_playersprites;
 
+extern dboolean interpolatesprites;
+extern dboolean pausesprites;
+
 void R_AddSprites(sector_t *sec, int lightlevel);
 void R_InitSprites(void);
 void R_ClearSprites(void);
+void R_FreeSprites(void);
 void R_DrawPlayerSprites(void);
 void R_DrawMasked(void);
 
@@ -1694,7 +1694,7 @@ void ST_Init(void)
     int i;
 
     ST_loadData();
-    screens[4] = Z_Malloc(ST_WIDTH * SBARHEIGHT, PU_STATIC, NULL);
+    screens[4] = Z_Malloc(MAXSCREENWIDTH * ORIGINALSBARHEIGHT * MAXSCREENSCALE, PU_STATIC, NULL);
 
     // [BH] fix evil grin being displayed when picking up first item after
     // loading save game or entering IDFA/IDKFA cheat
@@ -59,9 +59,12 @@
 
 #define WHITE   4
 
-// Each screen is [SCREENWIDTH * SCREENHEIGHT];
+// Each screen is [MAXSCREENWIDTH * MAXSCREENHEIGHT], of which only the first
+//  SCREENWIDTH * SCREENHEIGHT bytes are used.
 byte            *screens[5];
 
+int             screenscale = vid_renderscale_default;
+
 fixed_t         DX, DY, DXI, DYI;
 
 int             pixelwidth;
@@ -70,7 +73,43 @@ char            *r_lowpixelsize = r_lowpixelsize_default;
 
 char            screenshotfolder[MAX_PATH] = "";
 
+// The rows of screens[0] from dirtytop to dirtybottom - 1 have been drawn to since
+//  they were last blitted. Start with all of them.
+int             dirtytop = 0;
+int             dirtybottom = MAXSCREENHEIGHT;
+
 extern dboolean r_translucency;
+extern int      vid_renderscale;
+
+//
+// V_MarkDirtyRows
+// Mark rows top to bottom - 1 of screens[0] as drawn to. Anything that draws to
+//  screens[0] without going through the V_* functions needs to call this itself.
+//
+void V_MarkDirtyRows(int top, int bottom)
+{
+    dirtytop = MIN(dirtytop, top);
+    dirtybottom = MAX(dirtybottom, bottom);
+}
+
+void V_MarkScreenDirty(void)
+{
+    dirtytop = 0;
+    dirtybottom = MAXSCREENHEIGHT;
+}
+
+void V_ClearDirtyRows(void)
+{
+    dirtytop = MAXSCREENHEIGHT;
+    dirtybottom = 0;
+}
+
+// Mark the rows of a patch of height at y, in the coordinates scaled by DY. Two
+//  rows are added to allow for the shadows some patches are drawn with.
+static __inline void V_MarkPatchRows(int y, int height)
+{
+    V_MarkDirtyRows((y * DY) >> FRACBITS, ((y + height + 2) * DY) >> FRACBITS);
+}
 
 //
 // V_CopyRect
@@ -81,6 +120,9 @@ void V_CopyRect(int srcx, int srcy, int srcscrn, int width, int height, int dest
     byte        *src = screens[srcscrn] + srcy * SCREENWIDTH + srcx;
     byte        *dest = screens[destscrn] + desty * SCREENWIDTH + destx;
 
+    if (!destscrn)
+        V_MarkDirtyRows(desty, desty + height);
+
     while (height--)
     {
         memcpy(dest, src, width);
@@ -96,6 +138,9 @@ void V_FillRect(int scrn, int x, int y, int width, int height, int color)
 {
     byte        *dest = screens[scrn] + y * SCREENWIDTH + x;
 
+    if (!scrn)
+        V_MarkDirtyRows(y, y + height);
+
     while (height--)
     {
         memset(dest, color, width);
@@ -109,6 +154,9 @@ void V_FillTransRect(int scrn, int x, int y, int width, int height, int color)
     byte        *dot;
     int         xx, yy;
 
+    if (!scrn)
+        V_MarkDirtyRows(y - 2, y + height + 2);
+
     color <<= 8;
 
     dot = dest - 1 - SCREENWIDTH * 2;
@@ -161,6 +209,9 @@ void V_DrawPatch(int x, int y, int scrn, patch_t *patch)
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
+    if (!scrn)
+        V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[scrn] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -214,6 +265,9 @@ void V_DrawTranslucentPatch(int x, int y, int scrn, patch_t *patch)
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
+    if (!scrn)
+        V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[scrn] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -249,6 +303,8 @@ void V_DrawShadowPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset) / 10;
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[0] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -287,6 +343,8 @@ void V_DrawSolidShadowPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset) / 10;
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[0] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -325,6 +383,8 @@ void V_DrawSpectreShadowPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset) / 10;
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[0] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -362,6 +422,19 @@ void V_DrawBigPatch(int x, int y, int scrn, patch_t *patch)
     byte        *desttop = screens[scrn] + y * SCREENWIDTH + x;
     int         w = SHORT(patch->width);
 
+    // [BH] these patches are drawn at their native size, so clip them to the screen
+    //  when it is smaller than they are
+    if (x < 0)
+    {
+        col = -x;
+        desttop += col;
+    }
+
+    w = MIN(w, SCREENWIDTH - x);
+
+    if (!scrn)
+        V_MarkDirtyRows(MAX(0, y), MIN(SCREENHEIGHT, y + SHORT(patch->height)));
+
     for (; col < w; col++, desttop++)
     {
         column_t        *column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
@@ -375,12 +448,23 @@ void V_DrawBigPatch(int x, int y, int scrn, patch_t *patch)
             byte        *source = (byte *)column + 3;
             byte        *dest;
             int         count;
+            int         top;
 
             topdelta = (td < topdelta + lastlength - 1 ? topdelta + td : td);
             dest = desttop + topdelta * SCREENWIDTH;
             count = lastlength = column->length;
 
-            while (count--)
+            if ((top = y + topdelta) < 0)
+            {
+                source -= top;
+                dest -= top * SCREENWIDTH;
+                count += top;
+                top = 0;
+            }
+
+            count = MIN(count, SCREENHEIGHT - top);
+
+            while (count-- > 0)
             {
                 *dest = *source++;
                 dest += SCREENWIDTH;
@@ -399,6 +483,8 @@ void V_DrawConsoleTextPatch(int x, int y, patch_t *patch, int color, int backgro
     byte        *desttop = screens[0] + y * SCREENWIDTH + x;
     int         w = SHORT(patch->width);
 
+    V_MarkDirtyRows(y, y + SHORT(patch->height));
+
     for (; col < w; col++, desttop++)
     {
         column_t        *column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
@@ -416,7 +502,7 @@ void V_DrawConsoleTextPatch(int x, int y, patch_t *patch, int color, int backgro
             {
                 int     height = topdelta + length - count;
 
-                if (y + height > CONSOLETOP)
+                if (y + height > CONSOLETOP && y + height <= SCREENHEIGHT)
                 {
                     if (backgroundcolor == NOBACKGROUNDCOLOR)
                     {
@@ -448,6 +534,8 @@ void V_DrawConsolePatch(int x, int y, patch_t *patch)
     byte        *desttop = screens[0] + y * SCREENWIDTH + x;
     int         w = SHORT(patch->width);
 
+    V_MarkDirtyRows(y, y + SHORT(patch->height));
+
     for (; col < w; col++, desttop++)
     {
         column_t        *column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
@@ -465,7 +553,7 @@ void V_DrawConsolePatch(int x, int y, patch_t *patch)
             {
                 int     height = topdelta + length - count;
 
-                if (y + height > CONSOLETOP && *source)
+                if (y + height > CONSOLETOP && y + height <= SCREENHEIGHT && *source)
                     *dest = tinttab50[(nearestcolors[*source] << 8) + *dest];
                 source++;
                 dest += SCREENWIDTH;
@@ -544,6 +632,8 @@ void V_DrawPatchWithShadow(int x, int y, patch_t *patch, dboolean flag)
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[0] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -589,6 +679,8 @@ void V_DrawHUDPatch(int x, int y, patch_t *patch, byte *tinttab)
     if (!tinttab)
         return;
 
+    V_MarkDirtyRows(y, y + SHORT(patch->height));
+
     desttop = screens[0] + y * SCREENWIDTH + x;
     w = SHORT(patch->width);
 
@@ -622,6 +714,8 @@ void V_DrawHighlightedHUDNumberPatch(int x, int y, patch_t *patch, byte *tinttab
     if (!tinttab)
         return;
 
+    V_MarkDirtyRows(y, y + SHORT(patch->height));
+
     desttop = screens[0] + y * SCREENWIDTH + x;
     w = SHORT(patch->width);
 
@@ -657,6 +751,8 @@ void V_DrawYellowHUDPatch(int x, int y, patch_t *patch, byte *tinttab)
     if (!tinttab)
         return;
 
+    V_MarkDirtyRows(y, y + SHORT(patch->height));
+
     desttop = screens[0] + y * SCREENWIDTH + x;
     w = SHORT(patch->width);
 
@@ -687,6 +783,8 @@ void V_DrawTranslucentHUDPatch(int x, int y, patch_t *patch, byte *tinttab)
     byte        *desttop = screens[0] + y * SCREENWIDTH + x;
     int         w = SHORT(patch->width);
 
+    V_MarkDirtyRows(y, y + SHORT(patch->height));
+
     for (; col < w; col++, desttop++)
     {
         column_t        *column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
@@ -714,6 +812,8 @@ void V_DrawTranslucentHUDNumberPatch(int x, int y, patch_t *patch, byte *tinttab
     byte        *desttop = screens[0] + y * SCREENWIDTH + x;
     int         w = SHORT(patch->width);
 
+    V_MarkDirtyRows(y, y + SHORT(patch->height));
+
     for (; col < w; col++, desttop++)
     {
         column_t        *column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
@@ -743,6 +843,8 @@ void V_DrawTranslucentYellowHUDPatch(int x, int y, patch_t *patch, byte *tinttab
     byte        *desttop = screens[0] + y * SCREENWIDTH + x;
     int         w = SHORT(patch->width);
 
+    V_MarkDirtyRows(y, y + SHORT(patch->height));
+
     for (; col < w; col++, desttop++)
     {
         column_t        *column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
@@ -770,6 +872,8 @@ void V_DrawAltHUDPatch(int x, int y, patch_t *patch, int from, int to)
     byte        *desttop = screens[0] + y * SCREENWIDTH + x;
     int         w = SHORT(patch->width);
 
+    V_MarkDirtyRows(y, y + SHORT(patch->height));
+
     for (; col < w; col++, desttop++)
     {
         column_t        *column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
@@ -801,6 +905,8 @@ void V_DrawTranslucentAltHUDPatch(int x, int y, patch_t *patch, int from, int to
     byte        *desttop = screens[0] + y * SCREENWIDTH + x;
     int         w = SHORT(patch->width);
 
+    V_MarkDirtyRows(y, y + SHORT(patch->height));
+
     to <<= 8;
 
     for (; col < w; col++, desttop++)
@@ -837,6 +943,8 @@ void V_DrawTranslucentRedPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[0] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -884,6 +992,8 @@ void V_DrawFlippedPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[0] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -920,6 +1030,8 @@ void V_DrawFlippedShadowPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset) / 10;
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y + 3, SHORT(patch->height));
+
     desttop = screens[0] + (((y + 3) * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -959,6 +1071,8 @@ void V_DrawFlippedSolidShadowPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset) / 10;
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y + 3, SHORT(patch->height));
+
     desttop = screens[0] + (((y + 3) * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -998,6 +1112,8 @@ void V_DrawFlippedSpectreShadowPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset) / 10;
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y + 3, SHORT(patch->height));
+
     desttop = screens[0] + (((y + 3) * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -1039,6 +1155,8 @@ void V_DrawFlippedTranslucentRedPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[0] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -1068,9 +1186,9 @@ void V_DrawFlippedTranslucentRedPatch(int x, int y, patch_t *patch)
 
 #define _FUZZ(a, b)     _fuzzrange[M_RandomInt(a + 1, b + 1)]
 
-const int       _fuzzrange[3] = { -SCREENWIDTH, 0, SCREENWIDTH };
+const int       _fuzzrange[3] = { -1, 0, 1 };
 
-extern int      fuzztable[SCREENWIDTH * SCREENHEIGHT];
+extern int      fuzztable[MAXSCREENWIDTH * MAXSCREENHEIGHT];
 
 void V_DrawFuzzPatch(int x, int y, patch_t *patch)
 {
@@ -1082,6 +1200,8 @@ void V_DrawFuzzPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[0] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -1097,7 +1217,7 @@ void V_DrawFuzzPatch(int x, int y, patch_t *patch)
             {
                 if (!menuactive && !paused && !consoleactive)
                     fuzztable[_fuzzpos] = _FUZZ(-1, 1);
-                *dest = fullcolormap[6 * 256 + dest[fuzztable[_fuzzpos++]]];
+                *dest = fullcolormap[6 * 256 + dest[fuzztable[_fuzzpos++] * SCREENWIDTH]];
                 dest += SCREENWIDTH;
             }
 
@@ -1116,6 +1236,8 @@ void V_DrawFlippedFuzzPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[0] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -1132,7 +1254,7 @@ void V_DrawFlippedFuzzPatch(int x, int y, patch_t *patch)
             {
                 if (!menuactive && !paused && !consoleactive)
                     fuzztable[_fuzzpos] = _FUZZ(-1, 1);
-                *dest = fullcolormap[6 * 256 + dest[fuzztable[_fuzzpos++]]];
+                *dest = fullcolormap[6 * 256 + dest[fuzztable[_fuzzpos++] * SCREENWIDTH]];
                 dest += SCREENWIDTH;
             }
 
@@ -1162,6 +1284,8 @@ void V_DrawNoGreenPatchWithShadow(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[0] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -1213,6 +1337,8 @@ void V_DrawTranslucentNoGreenPatch(int x, int y, patch_t *patch)
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
+    V_MarkPatchRows(y, SHORT(patch->height));
+
     desttop = screens[0] + ((y * DY) >> FRACBITS) * SCREENWIDTH + ((x * DX) >> FRACBITS);
 
     for (; col < w; col += DXI, desttop++)
@@ -1250,6 +1376,8 @@ void V_DrawBlock(int x, int y, int width, int height, byte *src)
 {
     byte        *dest;
 
+    V_MarkDirtyRows(y, y + height);
+
     dest = screens[0] + y * SCREENWIDTH + x;
 
     while (height--)
@@ -1264,6 +1392,8 @@ void V_DrawPixel(int x, int y, byte color, dboolean shadow)
 {
     byte        *dest = &screens[0][y * SCREENSCALE * SCREENWIDTH + x * SCREENSCALE];
 
+    V_MarkDirtyRows(y * SCREENSCALE, (y + 1) * SCREENSCALE);
+
     if (color == 251)
     {
         if (shadow)
@@ -1327,10 +1457,12 @@ void GetPixelSize(dboolean reset)
 void V_LowGraphicDetail(void)
 {
     int x, y;
-    int w = viewwindowx + viewwidth;
-    int h = (viewwindowy + viewheight) * SCREENWIDTH;
+    int w = viewwindowx + scaledviewwidth;
+    int h = (viewwindowy + scaledviewheight) * SCREENWIDTH;
     int hh = pixelheight * SCREENWIDTH;
 
+    V_MarkDirtyRows(viewwindowy, viewwindowy + scaledviewheight);
+
     for (y = viewwindowy * SCREENWIDTH; y < h; y += hh)
         for (x = viewwindowx; x < w; x += pixelwidth)
         {
@@ -1346,10 +1478,26 @@ void V_LowGraphicDetail(void)
 //
 // V_Init
 //
+//
+// V_SetScreenScale
+// Change the size of the screen to scale times ORIGINALWIDTH by ORIGINALHEIGHT.
+//
+void V_SetScreenScale(int scale)
+{
+    screenscale = scale;
+
+    DX = (SCREENWIDTH << FRACBITS) / ORIGINALWIDTH;
+    DXI = (ORIGINALWIDTH << FRACBITS) / SCREENWIDTH;
+    DY = (SCREENHEIGHT << FRACBITS) / ORIGINALHEIGHT;
+    DYI = (ORIGINALHEIGHT << FRACBITS) / SCREENHEIGHT;
+
+    GetPixelSize(true);
+}
+
 void V_Init(void)
 {
     int                 i;
-    byte                *base = Z_Malloc(SCREENWIDTH * SCREENHEIGHT * 4, PU_STATIC, NULL);
+    byte                *base = Z_Malloc(MAXSCREENWIDTH * MAXSCREENHEIGHT * 4, PU_STATIC, NULL);
     const SDL_version   *linked = IMG_Linked_Version();
 #if defined(_WIN32) && !defined(PORTABILITY)
     char                buffer[MAX_PATH];
@@ -1366,14 +1514,9 @@ void V_Init(void)
             SDL_IMAGE_MAJOR_VERSION, SDL_IMAGE_MINOR_VERSION, SDL_IMAGE_PATCHLEVEL);
 
     for (i = 0; i < 4; i++)
-        screens[i] = base + i * SCREENWIDTH * SCREENHEIGHT;
+        screens[i] = base + i * MAXSCREENWIDTH * MAXSCREENHEIGHT;
 
-    DX = (SCREENWIDTH << FRACBITS) / ORIGINALWIDTH;
-    DXI = (ORIGINALWIDTH << FRACBITS) / SCREENWIDTH;
-    DY = (SCREENHEIGHT << FRACBITS) / ORIGINALHEIGHT;
-    DYI = (ORIGINALHEIGHT << FRACBITS) / SCREENHEIGHT;
-
-    GetPixelSize(true);
+    V_SetScreenScale(vid_renderscale);
 
 #if defined(_WIN32) && !defined(PORTABILITY)
     if (SUCCEEDED(SHGetFolderPath(NULL, CSIDL_MYPICTURES, NULL, SHGFP_TYPE_CURRENT, buffer)))
@@ -1403,6 +1546,8 @@ dboolean V_SavePNG(SDL_Window *window, char *path)
 {
     dboolean    result = false;
 
+    I_WaitForPresentThread();
+
     if (renderer)
     {
         int     rendererwidth;
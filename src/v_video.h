@@ -49,6 +49,9 @@
 // Screen 1 is an extra buffer.
 extern byte     *screens[5];
 
+extern int      dirtytop;
+extern int      dirtybottom;
+
 extern byte     redtoyellow[];
 
 extern byte     *tinttab20;
@@ -63,6 +66,11 @@ extern byte     *tinttabred;
 
 // Allocates buffer screens, call before R_Init.
 void V_Init(void);
+void V_SetScreenScale(int scale);
+
+void V_MarkDirtyRows(int top, int bottom);
+void V_MarkScreenDirty(void);
+void V_ClearDirtyRows(void);
 
 void V_CopyRect(int srcx, int srcy, int srcscrn, int width, int height, int destx, int desty,
     int destscrn);
@@ -327,6 +327,7 @@ static patch_t          **lnames;
 static void WI_slamBackground(void)
 {
     memcpy(screens[0], screens[1], SCREENWIDTH * SCREENHEIGHT);
+    V_MarkScreenDirty();
 }
 
 // [BH] Draws character of "<Levelname>"